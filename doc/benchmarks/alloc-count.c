@@ -0,0 +1,121 @@
+/* alloc-count.c
+ *
+ * Counts the calls of malloc, calloc and realloc of a program and the bytes requested, and prints
+ * the numbers to stderr when the program exits. Loaded with LD_PRELOAD, e.g. to get the allocations
+ * per frame of tshark:
+ *
+ * Build: cc -O2 -shared -fPIC -o alloc-count.so alloc-count.c -ldl
+ * Run:   LD_PRELOAD=./alloc-count.so tshark -r <trace> -q
+ *
+ * glib uses the system malloc (g_malloc), so the wmem allocators with a NULL scope are counted, too.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void *(*real_malloc)(size_t);
+static void *(*real_calloc)(size_t, size_t);
+static void *(*real_realloc)(void *, size_t);
+
+static unsigned long long count_calls;
+static unsigned long long count_bytes;
+
+/* dlsym itself may call calloc, served from here until the real one is known */
+static char bootstrap_buf[4096];
+static size_t bootstrap_used;
+
+static void *
+bootstrap_alloc(size_t size)
+{
+    void *p;
+
+    size = (size + 15) & ~(size_t)15;
+    if (bootstrap_used + size > sizeof(bootstrap_buf)) {
+        return NULL;
+    }
+    p = bootstrap_buf + bootstrap_used;
+    bootstrap_used += size;
+    return p;
+}
+
+static void
+init(void)
+{
+    static int initializing;
+
+    if (initializing) {
+        return;
+    }
+    initializing = 1;
+    real_malloc = (void *(*)(size_t))dlsym(RTLD_NEXT, "malloc");
+    real_calloc = (void *(*)(size_t, size_t))dlsym(RTLD_NEXT, "calloc");
+    real_realloc = (void *(*)(void *, size_t))dlsym(RTLD_NEXT, "realloc");
+}
+
+void *
+malloc(size_t size)
+{
+    if (real_malloc == NULL) {
+        init();
+        if (real_malloc == NULL) {
+            return bootstrap_alloc(size);
+        }
+    }
+    count_calls++;
+    count_bytes += size;
+    return real_malloc(size);
+}
+
+void *
+calloc(size_t n, size_t size)
+{
+    void *p;
+
+    if (real_calloc == NULL) {
+        init();
+        if (real_calloc == NULL) {
+            p = bootstrap_alloc(n * size);
+            if (p != NULL) {
+                memset(p, 0, n * size);
+            }
+            return p;
+        }
+    }
+    count_calls++;
+    count_bytes += n * size;
+    return real_calloc(n, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    if (real_realloc == NULL) {
+        init();
+    }
+    count_calls++;
+    count_bytes += size;
+    return real_realloc(ptr, size);
+}
+
+void
+free(void *ptr)
+{
+    static void (*real_free)(void *);
+
+    if ((char *)ptr >= bootstrap_buf && (char *)ptr < bootstrap_buf + sizeof(bootstrap_buf)) {
+        return;
+    }
+    if (real_free == NULL) {
+        real_free = (void (*)(void *))dlsym(RTLD_NEXT, "free");
+    }
+    real_free(ptr);
+}
+
+static void __attribute__((destructor))
+report(void)
+{
+    fprintf(stderr, "alloc-count: %llu allocations, %llu bytes\n", count_calls, count_bytes);
+}
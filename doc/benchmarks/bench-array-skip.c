@@ -0,0 +1,143 @@
+/* bench-array-skip.c
+ *
+ * Decoding of a Real array value of S7COMM-plus, as written by a data logger:
+ * - decode all: every element is read and added to the tree, as s7commp_decode_value did before
+ *   the elements after the display budget were skipped;
+ * - no tree: the first S7COMMP_ITEMVAL_ARR_MAX_DISPLAY elements are read for the summary, the
+ *   others are skipped with one bounds check, as s7commp_skip_array_values does;
+ * - tree, budget: the first elements up to the preference array_max_elements (default 100) are
+ *   read and added to the tree, the others are skipped.
+ *
+ * The accessors of libwireshark are calls into a shared library, so the mocks below are not inlined.
+ * Adding a tree item is mocked by formatting its label, which is the larger part of the work of
+ * proto_tree_add_float() when the tree is visible.
+ *
+ * Build: cc -O2 -o bench-array-skip bench-array-skip.c
+ * Run:   ./bench-array-skip [elements] [rounds]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define S7COMMP_ITEMVAL_ARR_MAX_DISPLAY     10
+#define ARRAY_MAX_ELEMENTS                  100
+#define ITEM_LABEL_LENGTH                   240
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t length;
+} tvb_t;
+
+static char labels[ARRAY_MAX_ELEMENTS][ITEM_LABEL_LENGTH];
+static uint32_t label_count;
+
+static __attribute__((noinline)) float
+tvb_get_ntohieee_float(const tvb_t *tvb, uint32_t offset)
+{
+    uint32_t v;
+    float f;
+
+    if (offset + 4 > tvb->length) {
+        abort();
+    }
+    v = ((uint32_t)tvb->data[offset] << 24) | ((uint32_t)tvb->data[offset + 1] << 16) |
+        ((uint32_t)tvb->data[offset + 2] << 8) | tvb->data[offset + 3];
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+static __attribute__((noinline)) void
+tvb_ensure_bytes_exist(const tvb_t *tvb, uint32_t offset, uint32_t length)
+{
+    if (offset + length > tvb->length) {
+        abort();
+    }
+}
+
+static __attribute__((noinline)) void
+proto_tree_add_float(uint32_t index, float value)
+{
+    snprintf(labels[label_count++ % ARRAY_MAX_ELEMENTS], ITEM_LABEL_LENGTH, "Value[%u]: %f", index, value);
+}
+
+static uint32_t
+decode_array(const tvb_t *tvb, uint32_t offset, uint32_t count, uint32_t skip_index, int tree, char *summary)
+{
+    char *p = summary;
+    uint32_t i;
+    float value;
+
+    for (i = 1; i <= count; i++) {
+        if (skip_index > 0 && i >= skip_index) {
+            tvb_ensure_bytes_exist(tvb, offset, (count - i + 1) * 4);
+            return offset + (count - i + 1) * 4;
+        }
+        value = tvb_get_ntohieee_float(tvb, offset);
+        offset += 4;
+        if (tree) {
+            proto_tree_add_float(i, value);
+        }
+        if (i <= S7COMMP_ITEMVAL_ARR_MAX_DISPLAY) {
+            p += sprintf(p, "%s%f", (i > 1) ? ", " : "", value);
+        }
+    }
+    return offset;
+}
+
+static double
+now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t elements = (argc > 1) ? (uint32_t)atoi(argv[1]) : 10000;
+    long rounds = (argc > 2) ? atol(argv[2]) : 200;
+    uint8_t *buf = malloc(elements * 4);
+    char summary[S7COMMP_ITEMVAL_ARR_MAX_DISPLAY * 32];
+    uint64_t sum[3] = { 0, 0, 0 };
+    double t[3], t0;
+    uint32_t i;
+    long r;
+
+    srand(1);
+    for (i = 0; i < elements * 4; i++) {
+        buf[i] = (i % 4 == 0) ? 0x42 : (uint8_t)rand();
+    }
+    tvb_t tvb = { buf, elements * 4 };
+
+    t0 = now_ns();
+    for (r = 0; r < rounds; r++) {
+        sum[0] += decode_array(&tvb, 0, elements, 0, 1, summary);
+    }
+    t[0] = now_ns() - t0;
+
+    t0 = now_ns();
+    for (r = 0; r < rounds; r++) {
+        sum[1] += decode_array(&tvb, 0, elements, S7COMMP_ITEMVAL_ARR_MAX_DISPLAY + 1, 0, summary);
+    }
+    t[1] = now_ns() - t0;
+
+    t0 = now_ns();
+    for (r = 0; r < rounds; r++) {
+        sum[2] += decode_array(&tvb, 0, elements, ARRAY_MAX_ELEMENTS + 1, 1, summary);
+    }
+    t[2] = now_ns() - t0;
+
+    if (sum[0] != sum[1] || sum[0] != sum[2]) {
+        printf("mismatch\n");
+        return 1;
+    }
+    printf("%u elements, %ld rounds\n", elements, rounds);
+    printf("decode all:   %10.1f us/array\n", t[0] / rounds / 1000);
+    printf("no tree:      %10.1f us/array\n", t[1] / rounds / 1000);
+    printf("tree, budget: %10.1f us/array\n", t[2] / rounds / 1000);
+    return 0;
+}
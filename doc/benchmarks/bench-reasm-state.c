@@ -0,0 +1,209 @@
+/* bench-reasm-state.c
+ *
+ * Counts the reassembly state that dissect_s7commp keeps in the file scope for a capture, before and
+ * after the frame state was kept only for fragments:
+ * - before: a frame_state_t for every S7COMM-plus PDU, and a new conv_state_t for the next PDU after
+ *   every fragmented PDU, as the state of the connection was deleted after its last fragment;
+ * - after: a frame_state_t only for the first, inner and last fragments, and one conv_state_t per
+ *   connection and direction, which is reused.
+ *
+ * The fragmentation is detected as in dissect_s7commp: a PDU without a trailer starts or continues a
+ * series, a PDU with a trailer ends it. Reads pcap and pcapng files with Ethernet, IPv4 and TCP. TPKT
+ * packets split over TCP segments are not reassembled, which is not needed for the traces in
+ * doc/test-traces.
+ *
+ * Build: cc -O2 -o bench-reasm-state bench-reasm-state.c
+ * Run:   ./bench-reasm-state <capture> [...]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_DIRECTIONS      256
+
+/* As in packet-s7comm_plus.c */
+typedef struct {
+    uint8_t first_fragment;
+    uint8_t inner_fragment;
+    uint8_t last_fragment;
+    uint32_t start_frame;
+    uint8_t start_opcode;
+    uint16_t start_function;
+    int ssl_state;
+    int ssl_reasm_state;
+    uint32_t ssl_start_frame;
+} frame_state_t;
+
+typedef struct {
+    int state;
+    uint32_t start_frame;
+    uint8_t start_opcode;
+    uint16_t start_function;
+} conv_state_t;
+
+typedef struct {
+    uint8_t key[12];            /* source and destination address and port */
+    int in_series;
+    int old_has_state;
+} direction_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t pdus;
+    uint32_t fragments;
+    uint32_t old_conv_states;
+    uint32_t new_conv_states;
+    uint32_t ndirections;
+    direction_t directions[MAX_DIRECTIONS];
+} counters_t;
+
+static direction_t *
+get_direction(counters_t *c, const uint8_t *key)
+{
+    uint32_t i;
+
+    for (i = 0; i < c->ndirections; i++) {
+        if (memcmp(c->directions[i].key, key, sizeof(c->directions[i].key)) == 0) {
+            return &c->directions[i];
+        }
+    }
+    if (c->ndirections == MAX_DIRECTIONS) {
+        fprintf(stderr, "too many connections\n");
+        exit(1);
+    }
+    memcpy(c->directions[i].key, key, sizeof(c->directions[i].key));
+    c->ndirections++;
+    c->new_conv_states++;
+    return &c->directions[i];
+}
+
+static void
+count_pdu(counters_t *c, direction_t *dir, int has_trailer)
+{
+    c->pdus++;
+    if (!dir->old_has_state) {
+        dir->old_has_state = 1;
+        c->old_conv_states++;
+    }
+    if (has_trailer) {
+        if (dir->in_series) {
+            c->fragments++;
+            dir->in_series = 0;
+            dir->old_has_state = 0;
+        }
+    } else {
+        c->fragments++;
+        dir->in_series = 1;
+    }
+}
+
+static void
+count_frame(counters_t *c, const uint8_t *f, uint32_t len)
+{
+    uint32_t ip, tcp, data, tpkt_len, li, payload_len;
+    uint8_t key[12];
+    direction_t *dir;
+    uint16_t dlength;
+
+    c->frames++;
+    if (len < 54 || f[12] != 0x08 || f[13] != 0x00 || f[23] != 6) {
+        return;
+    }
+    ip = 14;
+    tcp = ip + (f[ip] & 0x0f) * 4;
+    data = tcp + (f[tcp + 12] >> 4) * 4;
+    memcpy(key, f + ip + 12, 8);
+    memcpy(key + 8, f + tcp, 4);
+    while (data + 7 < len && f[data] == 3) {
+        tpkt_len = ((uint32_t)f[data + 2] << 8) | f[data + 3];
+        li = f[data + 4];
+        if (tpkt_len < 5 + li + 1 || data + tpkt_len > len) {
+            return;
+        }
+        /* COTP DT with S7COMM-plus, no keep alive (version 0xff) or system event (0xfe) */
+        if ((f[data + 5] & 0xf0) == 0xf0 && tpkt_len >= 5 + li + 4 && f[data + 5 + li] == 0x72 &&
+            f[data + 5 + li + 1] < 0xfe) {
+            payload_len = tpkt_len - 5 - li;
+            dlength = ((uint16_t)f[data + 5 + li + 2] << 8) | f[data + 5 + li + 3];
+            dir = get_direction(c, key);
+            count_pdu(c, dir, (int)payload_len > dlength + 4);
+        }
+        data += tpkt_len;
+    }
+}
+
+static int
+read_capture(const char *path, counters_t *c)
+{
+    FILE *fp = fopen(path, "rb");
+    uint8_t *d;
+    long size, o;
+    uint32_t magic, type, blen, clen;
+
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    d = malloc(size);
+    if (fread(d, 1, size, fp) != (size_t)size) {
+        fclose(fp);
+        free(d);
+        return -1;
+    }
+    fclose(fp);
+    memcpy(&magic, d, 4);
+    if (magic == 0x0a0d0d0a) {
+        for (o = 0; o + 12 <= size; o += blen) {
+            memcpy(&type, d + o, 4);
+            memcpy(&blen, d + o + 4, 4);
+            if (blen < 12) {
+                break;
+            }
+            if (type == 6) {
+                memcpy(&clen, d + o + 20, 4);
+                count_frame(c, d + o + 28, clen);
+            } else if (type == 3) {
+                count_frame(c, d + o + 12, blen - 16);
+            }
+        }
+    } else if (magic == 0xa1b2c3d4) {
+        for (o = 24; o + 16 <= size; o += 16 + clen) {
+            memcpy(&clen, d + o + 8, 4);
+            count_frame(c, d + o + 16, clen);
+        }
+    } else {
+        fprintf(stderr, "%s: unknown file format\n", path);
+        free(d);
+        return -1;
+    }
+    free(d);
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    counters_t *c;
+    int i;
+
+    printf("%-40s %7s %6s %9s %14s %14s %12s %12s\n", "capture", "frames", "PDUs", "fragments",
+           "frame before", "frame after", "conv before", "conv after");
+    for (i = 1; i < argc; i++) {
+        c = calloc(1, sizeof(counters_t));
+        if (read_capture(argv[i], c) == 0) {
+            printf("%-40.40s %7u %6u %9u %5u (%6zu) %5u (%6zu) %4u (%5zu) %4u (%5zu)\n",
+                   strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i], c->frames, c->pdus, c->fragments,
+                   c->pdus, c->pdus * sizeof(frame_state_t),
+                   c->fragments, c->fragments * sizeof(frame_state_t),
+                   c->old_conv_states, c->old_conv_states * sizeof(conv_state_t),
+                   c->new_conv_states, c->new_conv_states * sizeof(conv_state_t));
+        }
+        free(c);
+    }
+    return 0;
+}
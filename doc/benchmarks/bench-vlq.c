@@ -0,0 +1,194 @@
+/* bench-vlq.c
+ *
+ * Decoding of an UDInt array value of S7COMM-plus, whose elements are consecutive VLQs:
+ * - per octet: every octet is fetched with a bounds checked call, as tvb_get_varuint32 did
+ *   before the VLQs were decoded from a buffer pointer, with tvb_get_uint8();
+ * - per VLQ: one bounds checked call for the pointer to a VLQ, as tvb_get_varuint32 does now;
+ * - per array: one bounds checked call for the pointer to all elements, as tvb_get_varuint32_array
+ *   and tvb_get_varint32_array_avail do.
+ *
+ * The accessors of libwireshark are calls into a shared library, so the mocks below are not inlined.
+ * The decoder is a copy of s7commp_vlq_decode32.
+ *
+ * Build: cc -O2 -o bench-vlq bench-vlq.c
+ * Run:   ./bench-vlq [elements] [rounds]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define S7COMMP_VLQ32_MAX_LEN       5
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t length;
+} tvb_t;
+
+static __attribute__((noinline)) uint8_t
+tvb_get_uint8(const tvb_t *tvb, uint32_t offset)
+{
+    if (offset >= tvb->length) {
+        abort();
+    }
+    return tvb->data[offset];
+}
+
+static __attribute__((noinline)) const uint8_t *
+tvb_get_ptr(const tvb_t *tvb, uint32_t offset, uint32_t length)
+{
+    if (offset + length > tvb->length) {
+        abort();
+    }
+    return tvb->data + offset;
+}
+
+static inline int
+s7commp_vlq_decode32(const uint8_t *ptr, int len, bool is_signed, uint32_t *value)
+{
+    uint32_t val;
+    int i;
+
+    if (len <= 0) {
+        return 0;
+    }
+    if (is_signed && (ptr[0] & 0x40)) {
+        val = 0xffffffc0 | (ptr[0] & 0x3f);
+    } else {
+        val = ptr[0] & 0x7f;
+    }
+    for (i = 1; (ptr[i - 1] & 0x80) && i < len; i++) {
+        val = (val << 7) | (ptr[i] & 0x7f);
+    }
+    *value = val;
+    if ((ptr[i - 1] & 0x80) == 0) {
+        return i;
+    }
+    return (i == S7COMMP_VLQ32_MAX_LEN) ? S7COMMP_VLQ32_MAX_LEN + 1 : 0;
+}
+
+/* The decoding with one tvb_get_uint8() per octet, as before */
+static uint32_t
+get_varuint32_octets(const tvb_t *tvb, uint8_t *octet_count, uint32_t offset)
+{
+    uint32_t val = 0;
+    uint8_t octet;
+    uint8_t counter;
+
+    for (counter = 1; counter <= 4 + 1; counter++) {
+        octet = tvb_get_uint8(tvb, offset);
+        offset++;
+        if ((counter == (4 + 1)) || (octet & 0x80) == 0) {
+            val = (val << 7) | (octet & 0x7f);
+            break;
+        }
+        val = (val << 7) | (octet & 0x7f);
+    }
+    *octet_count = counter;
+    return val;
+}
+
+static uint32_t
+get_varuint32_ptr(const tvb_t *tvb, uint8_t *octet_count, uint32_t offset)
+{
+    uint32_t len = tvb->length - offset;
+    uint32_t val = 0;
+
+    if (len > S7COMMP_VLQ32_MAX_LEN) {
+        len = S7COMMP_VLQ32_MAX_LEN;
+    }
+    *octet_count = (uint8_t)s7commp_vlq_decode32(tvb_get_ptr(tvb, offset, len), (int)len, false, &val);
+    return val;
+}
+
+static uint32_t
+get_varuint32_array(const tvb_t *tvb, uint32_t offset, uint32_t count, uint32_t *values, uint8_t *octet_counts)
+{
+    const uint8_t *ptr;
+    int len = (int)(tvb->length - offset);
+    int pos = 0;
+    uint32_t i;
+
+    ptr = tvb_get_ptr(tvb, offset, (uint32_t)len);
+    for (i = 0; i < count && pos < len; i++) {
+        octet_counts[i] = (uint8_t)s7commp_vlq_decode32(ptr + pos, (len - pos < S7COMMP_VLQ32_MAX_LEN) ? len - pos : S7COMMP_VLQ32_MAX_LEN,
+            false, &values[i]);
+        pos += octet_counts[i];
+    }
+    return i;
+}
+
+static double
+now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t elements = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1000;
+    long rounds = (argc > 2) ? atol(argv[2]) : 20000;
+    uint8_t *buf = malloc(elements * 5);
+    uint32_t *values = malloc(elements * sizeof(uint32_t));
+    uint8_t *octet_counts = malloc(elements);
+    uint32_t len = 0;
+    uint32_t i, v, offset;
+    uint8_t oc;
+    uint64_t sum[3] = { 0, 0, 0 };
+    double t[3], t0;
+    long r;
+
+    /* Values of 1 to 5 octets, mostly small as in real traffic */
+    srand(1);
+    for (i = 0; i < elements; i++) {
+        v = (rand() % 4) ? (uint32_t)(rand() % 16384) : (uint32_t)rand();
+        if (v >= (1u << 28)) buf[len++] = 0x80 | (uint8_t)(v >> 28);
+        if (v >= (1u << 21)) buf[len++] = 0x80 | ((v >> 21) & 0x7f);
+        if (v >= (1u << 14)) buf[len++] = 0x80 | ((v >> 14) & 0x7f);
+        if (v >= (1u << 7)) buf[len++] = 0x80 | ((v >> 7) & 0x7f);
+        buf[len++] = v & 0x7f;
+    }
+    tvb_t tvb = { buf, len };
+
+    t0 = now_ns();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0, offset = 0; i < elements; i++) {
+            sum[0] += get_varuint32_octets(&tvb, &oc, offset);
+            offset += oc;
+        }
+    }
+    t[0] = now_ns() - t0;
+
+    t0 = now_ns();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0, offset = 0; i < elements; i++) {
+            sum[1] += get_varuint32_ptr(&tvb, &oc, offset);
+            offset += oc;
+        }
+    }
+    t[1] = now_ns() - t0;
+
+    t0 = now_ns();
+    for (r = 0; r < rounds; r++) {
+        get_varuint32_array(&tvb, 0, elements, values, octet_counts);
+        for (i = 0; i < elements; i++) {
+            sum[2] += values[i];
+        }
+    }
+    t[2] = now_ns() - t0;
+
+    if (sum[0] != sum[1] || sum[0] != sum[2]) {
+        printf("mismatch\n");
+        return 1;
+    }
+    printf("%u elements in %u bytes, %ld rounds\n", elements, len, rounds);
+    printf("per octet: %6.2f ns/element\n", t[0] / rounds / elements);
+    printf("per VLQ:   %6.2f ns/element\n", t[1] / rounds / elements);
+    printf("per array: %6.2f ns/element\n", t[2] / rounds / elements);
+    return 0;
+}
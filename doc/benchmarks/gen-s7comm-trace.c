@@ -0,0 +1,154 @@
+/* gen-s7comm-trace.c
+ *
+ * Writes a synthetic capture with classic S7COMM (protocol id 0x32): one client polls a PLC with
+ * Read Var requests of one DB item, each answered by an Ack_Data response. The frames are Ethernet,
+ * IPv4 and TCP with TPKT and COTP DT. The TCP checksums are not set, tshark doesn't check them by
+ * default.
+ *
+ * The PLC port is 102 by default. With another port, TCP has no dissector from the port table and
+ * tries its heuristics on every segment until the connection is bound to TPKT.
+ *
+ * Build: cc -O2 -o gen-s7comm-trace gen-s7comm-trace.c
+ * Run:   ./gen-s7comm-trace <file> [requests] [port]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t src_ip[4];
+    uint8_t dst_ip[4];
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint32_t seq;
+    uint32_t ack;
+} direction_t;
+
+static void
+put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void
+put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint16_t
+ip_checksum(const uint8_t *p, int len)
+{
+    uint32_t sum = 0;
+    int i;
+
+    for (i = 0; i < len; i += 2) {
+        sum += ((uint32_t)p[i] << 8) | p[i + 1];
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+static void
+write_frame(FILE *fp, uint32_t usec, direction_t *dir, direction_t *rev, const uint8_t *s7, int s7_len)
+{
+    uint8_t f[256];
+    uint8_t rec[16];
+    int ip = 14;
+    int tcp = ip + 20;
+    int tpkt = tcp + 20;
+    int len = tpkt + 4 + 3 + s7_len;
+
+    memset(f, 0, sizeof(f));
+    /* Ethernet */
+    memcpy(f, "\x00\x1b\x1b\x00\x00\x01\x00\x1b\x1b\x00\x00\x02", 12);
+    put16(f + 12, 0x0800);
+    /* IPv4 */
+    f[ip] = 0x45;
+    put16(f + ip + 2, (uint16_t)(len - ip));
+    f[ip + 8] = 64;
+    f[ip + 9] = 6;
+    memcpy(f + ip + 12, dir->src_ip, 4);
+    memcpy(f + ip + 16, dir->dst_ip, 4);
+    put16(f + ip + 10, ip_checksum(f + ip, 20));
+    /* TCP */
+    put16(f + tcp, dir->src_port);
+    put16(f + tcp + 2, dir->dst_port);
+    put32(f + tcp + 4, dir->seq);
+    put32(f + tcp + 8, rev->seq);
+    f[tcp + 12] = 0x50;
+    f[tcp + 13] = 0x18;         /* PSH, ACK */
+    put16(f + tcp + 14, 8192);
+    /* TPKT, COTP DT with EOT */
+    f[tpkt] = 3;
+    put16(f + tpkt + 2, (uint16_t)(4 + 3 + s7_len));
+    f[tpkt + 4] = 2;
+    f[tpkt + 5] = 0xf0;
+    f[tpkt + 6] = 0x80;
+    memcpy(f + tpkt + 7, s7, s7_len);
+    dir->seq += (uint32_t)(len - tpkt);
+
+    memcpy(rec, &(uint32_t){ 1700000000 + usec / 1000000 }, 4);
+    memcpy(rec + 4, &(uint32_t){ usec % 1000000 }, 4);
+    memcpy(rec + 8, &(uint32_t){ (uint32_t)len }, 4);
+    memcpy(rec + 12, &(uint32_t){ (uint32_t)len }, 4);
+    fwrite(rec, 1, sizeof(rec), fp);
+    fwrite(f, 1, len, fp);
+}
+
+int
+main(int argc, char **argv)
+{
+    /* Job, Read Var of DB1.DBB0 BYTE 2 */
+    uint8_t req[] = {
+        0x32, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00,
+        0x04, 0x01, 0x12, 0x0a, 0x10, 0x02, 0x00, 0x02, 0x00, 0x01, 0x84, 0x00, 0x00, 0x00
+    };
+    /* Ack_Data with the two bytes */
+    uint8_t resp[] = {
+        0x32, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x06, 0x00, 0x00,
+        0x04, 0x01, 0xff, 0x04, 0x00, 0x10, 0x12, 0x34
+    };
+    uint8_t header[24] = {
+        0xd4, 0xc3, 0xb2, 0xa1, 0x02, 0x00, 0x04, 0x00, 0, 0, 0, 0, 0, 0, 0, 0,
+        0xff, 0xff, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00
+    };
+    direction_t client = { { 192, 168, 0, 10 }, { 192, 168, 0, 1 }, 49152, 102, 1000, 0 };
+    direction_t plc = { { 192, 168, 0, 1 }, { 192, 168, 0, 10 }, 102, 49152, 5000, 0 };
+    long requests = (argc > 2) ? atol(argv[2]) : 100000;
+    FILE *fp;
+    uint32_t usec = 0;
+    long i;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <file> [requests] [port]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 3) {
+        plc.src_port = client.dst_port = (uint16_t)atoi(argv[3]);
+    }
+    fp = fopen(argv[1], "wb");
+    if (fp == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    fwrite(header, 1, sizeof(header), fp);
+    for (i = 0; i < requests; i++) {
+        put16(req + 4, (uint16_t)(i + 1));
+        put16(resp + 4, (uint16_t)(i + 1));
+        write_frame(fp, usec, &client, &plc, req, (int)sizeof(req));
+        usec += 2000;
+        write_frame(fp, usec, &plc, &client, resp, (int)sizeof(resp));
+        usec += 8000;
+    }
+    fclose(fp);
+    return 0;
+}
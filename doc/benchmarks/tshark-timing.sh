@@ -0,0 +1,39 @@
+#!/bin/sh
+#
+# Time the dissection of a trace with tshark.
+#
+# Usage: tshark-timing.sh <trace> [runs] [tshark options...]
+#
+# The trace is read <runs> times (default 5) with "tshark -r <trace> -q" and the
+# given options, the output is discarded. The fastest and the median wall time
+# of the runs are printed in milliseconds. Set TSHARK to use another binary,
+# e.g. the one of a build tree with the plugin under test.
+#
+
+TSHARK=${TSHARK:-tshark}
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <trace> [runs] [tshark options...]" >&2
+    exit 1
+fi
+trace=$1
+shift
+runs=5
+if [ $# -ge 1 ]; then
+    runs=$1
+    shift
+fi
+
+times=""
+i=0
+while [ $i -lt $runs ]; do
+    start=$(date +%s%N)
+    "$TSHARK" -r "$trace" -q "$@" > /dev/null || exit 1
+    end=$(date +%s%N)
+    times="$times $(( (end - start) / 1000000 ))"
+    i=$((i + 1))
+done
+
+echo $times | tr ' ' '\n' | sort -n | awk -v trace="$trace" '
+    { t[NR] = $1 }
+    END { printf "%s: %d runs, fastest %d ms, median %d ms\n", trace, NR, t[1], t[int((NR + 1) / 2)] }'
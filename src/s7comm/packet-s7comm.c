@@ -24,8 +24,18 @@
 
 #include "config.h"
 
+#include <stdlib.h>
+
 #include <glib.h>
 #include <epan/packet.h>
+#include <epan/conversation.h>
+#include <epan/expert.h>
+#include <epan/tap.h>
+#include <epan/stats_tree.h>
+#include <epan/srt_table.h>
+#include <epan/reassemble.h>
+#include <epan/export_object.h>
+#include <wsutil/pint.h>
 
 #include "packet-s7comm.h"
 #include "packet-s7comm_szl_ids.h"
@@ -38,9 +48,28 @@
 /* Protocol identifier */
 #define S7COMM_PROT_ID                      0x32
 
+/* Text which is only appended to tree labels is not needed when the tree is not built,
+ * or only faked for filtering and fields output (e.g. tshark -T fields).
+ * Columns and filterable fields are always computed.
+ */
+#define S7COMM_TREE_VISIBLE(tree)           ((tree) != NULL && PTREE_DATA(tree)->visible)
+
 /* Wireshark ID of the S7COMM protocol */
 static int proto_s7comm = -1;
 
+/* Tap for statistics */
+static int s7comm_tap = -1;
+/* Tap for export objects (uploaded blocks) */
+static int s7comm_eo_tap = -1;
+
+/* TPKT, the TCP connection is bound to it on the first S7COMM PDU */
+static dissector_handle_t tpkt_handle = NULL;
+
+/* Keys of the per frame data */
+/* A frame may carry several S7COMM PDUs (several TPKTs), these have different layer numbers */
+#define S7COMM_PROTO_DATA_TRANS(layer)      (0x10000000 | (layer))  /* s7comm_transaction_t of a request or response */
+#define S7COMM_PROTO_DATA_CYCLIC(layer)     (0x20000000 | (layer))  /* s7comm_cyclic_push_t of a cyclic data response or push */
+
 /* Forward declarations */
 void proto_reg_handoff_s7comm(void);
 void proto_register_s7comm (void);
@@ -206,6 +235,9 @@ static const value_string param_errcode_names[] = {
 #define S7COMM_FUNC_PLC_CONTROL             0x28
 #define S7COMM_FUNC_PLC_STOP                0x29
 
+/* Function status in the response of block functions */
+#define S7COMM_BLOCKCONTROL_STATUS_MORE     0x01        /* More data following */
+
 static const value_string param_functionnames[] = {
     { S7COMM_SERV_CPU,                      "CPU services" },
     { S7COMM_SERV_SETUPCOMM,                "Setup communication" },
@@ -594,6 +626,20 @@ static const value_string userdata_cyclic_subfunc_names[] = {
     { 0,                                    NULL }
 };
 
+/**************************************************************************
+ * Timebase of the interval of cyclic data
+ */
+#define S7COMM_CYCL_TIMEBASE_100MS          0
+#define S7COMM_CYCL_TIMEBASE_1S             1
+#define S7COMM_CYCL_TIMEBASE_10S            2
+
+static const value_string cycl_interval_timebase_names[] = {
+    { S7COMM_CYCL_TIMEBASE_100MS,           "100 milliseconds" },
+    { S7COMM_CYCL_TIMEBASE_1S,              "1 second" },
+    { S7COMM_CYCL_TIMEBASE_10S,             "10 seconds" },
+    { 0,                                    NULL }
+};
+
 /**************************************************************************
  * Names of userdata subfunctions in group 3 (Block functions)
  */
@@ -870,6 +916,10 @@ static gint hf_s7comm_header_parlg = -1;                    /* Header Bytes 6, 7
 static gint hf_s7comm_header_datlg = -1;                    /* Header Bytes 8, 9 */
 static gint hf_s7comm_header_errcls = -1;                   /* Header Byte 10, only available at type 2 or 3 */
 static gint hf_s7comm_header_errcod = -1;                   /* Header Byte 11, only available at type 2 or 3 */
+/* Request/response matching, generated fields */
+static gint hf_s7comm_response_in = -1;                     /* Frame number of the response to this request */
+static gint hf_s7comm_response_to = -1;                     /* Frame number of the request to this response */
+static gint hf_s7comm_response_time = -1;                   /* Time between request and response */
 /* Parameter Block */
 static gint hf_s7comm_param = -1;
 static gint hf_s7comm_param_errcod = -1;                    /* Parameter part: Error code */
@@ -920,6 +970,34 @@ static gint hf_s7comm_data_item = -1;
 static gint hf_s7comm_readresponse_data = -1;
 static gint hf_s7comm_data_fillbyte = -1;
 
+/* Typed values of read/write data, the type is taken from the request item */
+static gint hf_s7comm_data_value_word = -1;
+static gint hf_s7comm_data_value_int = -1;
+static gint hf_s7comm_data_value_dword = -1;
+static gint hf_s7comm_data_value_dint = -1;
+static gint hf_s7comm_data_value_real = -1;
+static gint hf_s7comm_data_value_byte = -1;
+static gint hf_s7comm_data_value_char = -1;
+static gint hf_s7comm_data_value_not_shown = -1;
+
+/* Maximum number of typed values of one item in the tree, the rest is only in the data bytes */
+#define S7COMM_DATA_VALUES_MAX_DISPLAY      100
+
+/* Packing analysis of Read Var requests, generated fields */
+static gint hf_s7comm_analysis = -1;
+static gint hf_s7comm_analysis_pdu_length = -1;
+static gint hf_s7comm_analysis_resp_size = -1;
+static gint hf_s7comm_analysis_pdu_fill = -1;
+static gint hf_s7comm_analysis_coalesced_count = -1;
+static gint hf_s7comm_analysis_coalesced = -1;
+static gint hf_s7comm_analysis_coalesced_requests = -1;
+static gint hf_s7comm_analysis_overlap_frame = -1;
+static gint ett_s7comm_analysis = -1;
+
+static expert_field ei_s7comm_analysis_item_overlap = EI_INIT;
+static expert_field ei_s7comm_analysis_item_adjacent = EI_INIT;
+static expert_field ei_s7comm_analysis_redundant_read = EI_INIT;
+
 /* timefunction: s7 timestamp */
 static gint hf_s7comm_data_ts = -1;
 static gint hf_s7comm_data_ts_reserved = -1;
@@ -1054,6 +1132,53 @@ static gint hf_s7comm_data_blockcontrol_part2_len = -1;     /* Length part 2 in
 static gint hf_s7comm_data_blockcontrol_part2_unknown = -1; /* Unknown char, ASCII */
 static gint hf_s7comm_data_blockcontrol_loadmem_len = -1;   /* Length load memory in bytes, ASCII */
 static gint hf_s7comm_data_blockcontrol_mc7code_len = -1;   /* Length of MC7 code in bytes, ASCII */
+static gint hf_s7comm_data_blockcontrol_functionstatus = -1;/* Function status in response, 1 byte, 0x01: more data following */
+static gint hf_s7comm_data_blockcontrol_uploadid = -1;      /* Upload ID, 4 bytes, from start upload response */
+static gint hf_s7comm_data_blockcontrol_blocklen = -1;      /* Length of the block in bytes, ASCII */
+static gint hf_s7comm_data_blockcontrol_upload_len = -1;    /* Length of the upload data in this PDU, 2 bytes int */
+static gint hf_s7comm_data_blockcontrol_upload_unknown = -1;/* Unknown 2 bytes before upload data */
+static gint hf_s7comm_data_blockcontrol_upload_data = -1;   /* Upload data in this PDU */
+static gint hf_s7comm_data_blockcontrol_block = -1;         /* Complete block from reassembled upload */
+
+/* These fields used when reassembling uploaded blocks */
+static gint hf_s7comm_upload_fragments = -1;
+static gint hf_s7comm_upload_fragment = -1;
+static gint hf_s7comm_upload_fragment_overlap = -1;
+static gint hf_s7comm_upload_fragment_overlap_conflict = -1;
+static gint hf_s7comm_upload_fragment_multiple_tails = -1;
+static gint hf_s7comm_upload_fragment_too_long_fragment = -1;
+static gint hf_s7comm_upload_fragment_error = -1;
+static gint hf_s7comm_upload_fragment_count = -1;
+static gint hf_s7comm_upload_reassembled_in = -1;
+static gint hf_s7comm_upload_reassembled_length = -1;
+static gint ett_s7comm_upload_fragment = -1;
+static gint ett_s7comm_upload_fragments = -1;
+
+static const fragment_items s7comm_upload_frag_items = {
+    /* Fragment subtrees */
+    &ett_s7comm_upload_fragment,
+    &ett_s7comm_upload_fragments,
+    /* Fragment fields */
+    &hf_s7comm_upload_fragments,
+    &hf_s7comm_upload_fragment,
+    &hf_s7comm_upload_fragment_overlap,
+    &hf_s7comm_upload_fragment_overlap_conflict,
+    &hf_s7comm_upload_fragment_multiple_tails,
+    &hf_s7comm_upload_fragment_too_long_fragment,
+    &hf_s7comm_upload_fragment_error,
+    &hf_s7comm_upload_fragment_count,
+    /* Reassembled in field */
+    &hf_s7comm_upload_reassembled_in,
+    /* Reassembled length field */
+    &hf_s7comm_upload_reassembled_length,
+    /* Reassembled data field */
+    NULL,
+    /* Tag */
+    "Upload fragments"
+};
+
+/* The data of an upload is identified by the upload ID, addresses and ports */
+static reassembly_table s7comm_upload_reassembly_table;
 
 /* Variable table */
 static gint hf_s7comm_vartab_data_type = -1;                /* Type of data, 1 byte, stringlist userdata_prog_vartab_type_names */
@@ -1068,6 +1193,14 @@ static gint hf_s7comm_vartab_req_startaddress = -1;         /* Startaddress, 2 b
 /* cyclic data */
 static gint hf_s7comm_cycl_interval_timebase = -1;          /* Interval timebase, 1 byte, int */
 static gint hf_s7comm_cycl_interval_time = -1;              /* Interval time, 1 byte, int */
+/* Linking of responses and pushes to the subscribing request, generated fields */
+static gint hf_s7comm_cycl_interval = -1;
+static gint hf_s7comm_cycl_request_in = -1;
+static gint hf_s7comm_cycl_push_no = -1;
+static gint hf_s7comm_cycl_delta = -1;
+static gint hf_s7comm_cycl_lateness = -1;
+
+static expert_field ei_s7comm_cycl_missed_push = EI_INIT;
 
 /* PBC, Programmable Block Functions */
 static gint hf_s7comm_pbc_unknown = -1;                     /* unknown, 1 byte */
@@ -1811,6 +1944,121 @@ static gint ett_s7comm_cpu_alarm_message_timestamp = -1;            /* Subtree f
 static gint ett_s7comm_cpu_alarm_message_associated_value = -1;     /* Subtree for an alarm message associated value */
 static gint ett_s7comm_cpu_diag_msg = -1;                           /* Subtree for a CPU diagnostic message */
 
+/**************************************************************************
+ * Request/response matching.
+ * A Job and its Ack/Ack_Data carry the same PDU reference, the same
+ * is true for a Userdata request and its response. The transactions
+ * are stored per conversation in a tree with the PDU reference as key. As the
+ * PDU reference is reused, an entry is replaced when a new Job with the
+ * same reference is seen. Each frame keeps a pointer to its transaction,
+ * so the result is stable on later passes.
+ */
+typedef struct {
+    guint32 req_frame;                  /* Frame number of the Job */
+    guint32 rep_frame;                  /* Frame number of the Ack/Ack_Data, 0 if not seen yet */
+    nstime_t req_time;                  /* Timestamp of the Job */
+    guint8 rosctr;                      /* ROSCTR of the request, Job or Userdata */
+    guint8 function;                    /* Function code of the Job, or function group of the Userdata request */
+    guint8 subfunc;                     /* Subfunction of the Userdata request */
+    guint8 item_count;                  /* Number of items of a read/write request */
+    s7comm_item_info_t *items;          /* Items of a read/write request, used to decode the response data */
+    guint32 upload_id;                  /* Upload ID of an upload/end upload request */
+    gchar *block_name;                  /* Name of the block of a start upload/upload request, e.g. "OB00001" */
+    guint16 pdu_length;                 /* Negotiated PDU length when the request was sent, 0 if unknown */
+    guint32 overlap_frame;              /* Read Var request of the same poll cycle reading an overlapping range */
+    guint32 cyclic_interval_ms;         /* Requested interval of a cyclic data request, 0 if unknown */
+} s7comm_transaction_t;
+
+/**************************************************************************
+ * Cyclic data subscription. The response to the subscribing request contains
+ * the job id in the data unit reference, which all pushes of the subscription use.
+ */
+typedef struct {
+    guint32 req_frame;                  /* Frame of the subscribing request */
+    guint8 job_id;
+    guint32 interval_ms;                /* Requested interval, 0 if unknown */
+    guint8 item_count;
+    s7comm_item_info_t *items;          /* Items of the request, used to decode the pushed data */
+    guint32 push_count;                 /* Number of pushes seen so far */
+    nstime_t last_time;                 /* Time of the response or the last push */
+} s7comm_cyclic_sub_t;
+
+typedef struct {
+    s7comm_cyclic_sub_t *sub;
+    guint32 push_no;                    /* 0 for the response, then counting the pushes */
+    nstime_t delta;                     /* Time since the response or previous push */
+    guint32 bytes;                      /* Length of the data part */
+} s7comm_cyclic_push_t;
+
+/* Number of previous Read Var requests of a connection checked for overlapping ranges */
+#define S7COMM_READ_HISTORY_SIZE            16
+
+typedef struct {
+    wmem_tree_t *transactions;          /* s7comm_transaction_t, key is the PDU reference */
+    wmem_tree_t *uploads;               /* Block name of a running upload, key is the upload ID */
+    guint16 pdu_length;                 /* PDU length of the last setup communication */
+    s7comm_transaction_t *read_history[S7COMM_READ_HISTORY_SIZE];  /* Last Read Var requests, ring buffer */
+    guint read_history_pos;             /* Next position to write in read_history */
+    wmem_tree_t *subscriptions;         /* s7comm_cyclic_sub_t, key is the job id */
+    gboolean bound;                     /* The TCP conversation is bound to TPKT */
+} s7comm_conv_info_t;
+
+/**************************************************************************
+ * Info passed to the export object tap, when a block upload is complete
+ */
+typedef struct {
+    const gchar *filename;
+    guint32 payload_len;
+    const guint8 *payload_data;
+} s7comm_eo_t;
+
+/*******************************************************************************************************
+ *
+ * Get the conversation data, create it if not available yet
+ *
+ *******************************************************************************************************/
+static s7comm_conv_info_t *
+s7comm_get_conv_info(packet_info *pinfo)
+{
+    conversation_t *conversation;
+    s7comm_conv_info_t *conv_info;
+
+    conversation = find_or_create_conversation(pinfo);
+    conv_info = (s7comm_conv_info_t *)conversation_get_proto_data(conversation, proto_s7comm);
+    if (conv_info == NULL) {
+        conv_info = wmem_new0(wmem_file_scope(), s7comm_conv_info_t);
+        conv_info->transactions = wmem_tree_new(wmem_file_scope());
+        conv_info->uploads = wmem_tree_new(wmem_file_scope());
+        conv_info->subscriptions = wmem_tree_new(wmem_file_scope());
+        conversation_add_proto_data(conversation, proto_s7comm, conv_info);
+    }
+    return conv_info;
+}
+
+/*******************************************************************************************************
+ *
+ * Bind the TCP connection to TPKT on the first S7COMM PDU
+ * COTP offers only a heuristic list for its payload and never looks up a conversation dissector,
+ * so the binding is done where it is looked up: TCP tries the conversation dissector first,
+ * and hands the following segments directly to TPKT, without the port table and the TCP heuristics.
+ * The S7COMM heuristic itself is only a few byte compares. The connection may use another port than 102.
+ *
+ *******************************************************************************************************/
+static void
+s7comm_bind_conversation(packet_info *pinfo)
+{
+    s7comm_conv_info_t *conv_info;
+
+    if (tpkt_handle == NULL || pinfo->ptype != PT_TCP) {
+        return;
+    }
+    conv_info = s7comm_get_conv_info(pinfo);
+    if (!conv_info->bound) {
+        conversation_set_dissector(find_or_create_conversation(pinfo), tpkt_handle);
+        conv_info->bound = TRUE;
+    }
+}
+
 static const char mon_names[][4] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
 
 /*******************************************************************************************************
@@ -1979,7 +2227,8 @@ static guint32
 s7comm_decode_param_item(tvbuff_t *tvb,
                           guint32 offset,
                           proto_tree *sub_tree,
-                          guint8 item_no)
+                          guint8 item_no,
+                          s7comm_item_info_t *item_info)    /* if not NULL, the address is stored there */
 {
     guint32 a_address = 0;
     guint32 bytepos = 0;
@@ -2016,6 +2265,10 @@ s7comm_decode_param_item(tvbuff_t *tvb,
     var_spec_length = tvb_get_guint8(tvb, offset + 1);
     var_spec_syntax_id = tvb_get_guint8(tvb, offset + 2);
 
+    if (item_info != NULL) {
+        memset(item_info, 0, sizeof(s7comm_item_info_t));
+    }
+
     /* Classic S7:  type = 0x12, len=10, syntax-id=0x10 for ANY-Pointer
      * TIA S7-1200: type = 0x12, len=14, syntax-id=0xb2 (symbolic addressing??)
      * Drive-ES Starter with routing: type = 0x12, len=10, syntax-id=0xa2 for ANY-Pointer
@@ -2060,49 +2313,63 @@ s7comm_decode_param_item(tvbuff_t *tvb,
         address_item_tree = proto_item_add_subtree(address_item, ett_s7comm_item_address);
         bytepos = a_address / 8;
         bitpos = a_address % 8;
-        /* build a full address to show item data directly beside the item */
-        switch (area) {
-            case (S7COMM_AREA_P):
-                proto_item_append_text(item_tree, " (P");
-                break;
-            case (S7COMM_AREA_INPUTS):
-                proto_item_append_text(item_tree, " (I");
-                break;
-            case (S7COMM_AREA_OUTPUTS):
-                proto_item_append_text(item_tree, " (Q");
-                break;
-            case (S7COMM_AREA_FLAGS):
-                proto_item_append_text(item_tree, " (M");
-                break;
-            case (S7COMM_AREA_DB):
-                proto_item_append_text(item_tree, " (DB%d.DBX", db);
-                break;
-            case (S7COMM_AREA_DI):
-                proto_item_append_text(item_tree, " (DI%d.DIX", db);
-                break;
-            case (S7COMM_AREA_LOCAL):
-                proto_item_append_text(item_tree, " (L");
-                break;
-            case (S7COMM_AREA_COUNTER):
-                proto_item_append_text(item_tree, " (C");
-                break;
-            case (S7COMM_AREA_TIMER):
-                proto_item_append_text(item_tree, " (T");
-                break;
-            default:
-                proto_item_append_text(item_tree, " (unknown area");
-                break;
+        if (item_info != NULL) {
+            item_info->syntax_id = var_spec_syntax_id;
+            item_info->t_size = t_size;
+            item_info->len = len;
+            item_info->db = db;
+            item_info->area = area;
+            item_info->bytepos = bytepos;
+            item_info->bitpos = bitpos;
         }
         if (area == S7COMM_AREA_TIMER || area == S7COMM_AREA_COUNTER) {
-            proto_item_append_text(item_tree, " %d)", a_address);
             proto_tree_add_uint(address_item_tree, hf_s7comm_item_address_nr, tvb, offset, 3, a_address);
         } else {
             proto_tree_add_uint(address_item_tree, hf_s7comm_item_address_byte, tvb, offset, 3, a_address);
             proto_tree_add_uint(address_item_tree, hf_s7comm_item_address_bit, tvb, offset, 3, a_address);
-            proto_item_append_text(item_tree, " %d.%d %s %d)",
-                bytepos, bitpos, val_to_str(t_size, item_transportsizenames, "Unknown transport size: 0x%02x"), len);
         }
         offset += 3;
+        /* build a full address to show item data directly beside the item */
+        if (S7COMM_TREE_VISIBLE(item_tree)) {
+            switch (area) {
+                case (S7COMM_AREA_P):
+                    proto_item_append_text(item_tree, " (P");
+                    break;
+                case (S7COMM_AREA_INPUTS):
+                    proto_item_append_text(item_tree, " (I");
+                    break;
+                case (S7COMM_AREA_OUTPUTS):
+                    proto_item_append_text(item_tree, " (Q");
+                    break;
+                case (S7COMM_AREA_FLAGS):
+                    proto_item_append_text(item_tree, " (M");
+                    break;
+                case (S7COMM_AREA_DB):
+                    proto_item_append_text(item_tree, " (DB%d.DBX", db);
+                    break;
+                case (S7COMM_AREA_DI):
+                    proto_item_append_text(item_tree, " (DI%d.DIX", db);
+                    break;
+                case (S7COMM_AREA_LOCAL):
+                    proto_item_append_text(item_tree, " (L");
+                    break;
+                case (S7COMM_AREA_COUNTER):
+                    proto_item_append_text(item_tree, " (C");
+                    break;
+                case (S7COMM_AREA_TIMER):
+                    proto_item_append_text(item_tree, " (T");
+                    break;
+                default:
+                    proto_item_append_text(item_tree, " (unknown area");
+                    break;
+            }
+            if (area == S7COMM_AREA_TIMER || area == S7COMM_AREA_COUNTER) {
+                proto_item_append_text(item_tree, " %d)", a_address);
+            } else {
+                proto_item_append_text(item_tree, " %d.%d %s %d)",
+                    bytepos, bitpos, val_to_str(t_size, item_transportsizenames, "Unknown transport size: 0x%02x"), len);
+            }
+        }
     /****************************************************************************/
     /******************** S7-400 special address mode (kind of cyclic read) *****/
     /* The response to this kind of request can't be decoded, because in the response
@@ -2148,7 +2415,9 @@ s7comm_decode_param_item(tvbuff_t *tvb,
         tia_var_area2 = tvb_get_ntohs(tvb, offset);
         if (tia_var_area1 == S7COMM_TIA1200_VAR_ITEM_AREA1_IQMCT) {
             proto_tree_add_uint(item_tree, hf_s7comm_tia1200_item_area2, tvb, offset, 2, tia_var_area2);
-            proto_item_append_text(item_tree, " - Accessing %s", val_to_str(tia_var_area2, tia1200_var_item_area2_names, "Unknown IQMCT Area: 0x%04x"));
+            if (S7COMM_TREE_VISIBLE(item_tree)) {
+                proto_item_append_text(item_tree, " - Accessing %s", val_to_str(tia_var_area2, tia1200_var_item_area2_names, "Unknown IQMCT Area: 0x%04x"));
+            }
             offset += 2;
         } else if (tia_var_area1 == S7COMM_TIA1200_VAR_ITEM_AREA1_DB) {
             proto_tree_add_uint(item_tree, hf_s7comm_tia1200_item_dbnumber, tvb, offset, 2, tia_var_area2);
@@ -2170,10 +2439,12 @@ s7comm_decode_param_item(tvbuff_t *tvb,
             tia_lid_flags = tvb_get_guint8(tvb, offset) >> 4;
             proto_tree_add_item(sub_item_tree, hf_s7comm_tia1200_var_lid_flags, tvb, offset, 1, ENC_BIG_ENDIAN);
             tia_value = tvb_get_ntohl(tvb, offset) & 0x0fffffff;
-            proto_item_append_text(sub_item, " [%d]: %s, Value: %u", i + 1,
-                val_to_str(tia_lid_flags, tia1200_var_lid_flag_names, "Unknown flags: 0x%02x"),
-                tia_value
-            );
+            if (S7COMM_TREE_VISIBLE(sub_item_tree)) {
+                proto_item_append_text(sub_item, " [%d]: %s, Value: %u", i + 1,
+                    val_to_str(tia_lid_flags, tia1200_var_lid_flag_names, "Unknown flags: 0x%02x"),
+                    tia_value
+                );
+            }
             proto_tree_add_item(sub_item_tree, hf_s7comm_tia1200_item_value, tvb, offset, 4, ENC_BIG_ENDIAN);
             offset += 4;
         }
@@ -2216,9 +2487,14 @@ s7comm_decode_param_item(tvbuff_t *tvb,
  *******************************************************************************************************/
 static guint32
 s7comm_decode_pdu_setup_communication(tvbuff_t *tvb,
+                                     packet_info *pinfo,
                                      proto_tree *tree,
                                      guint32 offset)
 {
+    /* The PDU length of the response overrides the proposal of the request */
+    if (!PINFO_FD_VISITED(pinfo)) {
+        s7comm_get_conv_info(pinfo)->pdu_length = tvb_get_ntohs(tvb, offset + 5);
+    }
     proto_tree_add_item(tree, hf_s7comm_param_setup_reserved1, tvb, offset, 1, ENC_BIG_ENDIAN);
     offset += 1;
     proto_tree_add_item(tree, hf_s7comm_param_maxamq_calling, tvb, offset, 2, ENC_BIG_ENDIAN);
@@ -2230,6 +2506,357 @@ s7comm_decode_pdu_setup_communication(tvbuff_t *tvb,
     return offset;
 }
 
+/*******************************************************************************************************
+ *
+ * Number of bytes of one element of a S7ANY item
+ *
+ *******************************************************************************************************/
+static guint32
+s7comm_get_transport_size_bytes(guint8 t_size)
+{
+    switch (t_size) {
+        case S7COMM_TRANSPORT_SIZE_WORD:
+        case S7COMM_TRANSPORT_SIZE_INT:
+        case S7COMM_TRANSPORT_SIZE_DATE:
+        case S7COMM_TRANSPORT_SIZE_S5TIME:
+        case S7COMM_TRANSPORT_SIZE_COUNTER:
+        case S7COMM_TRANSPORT_SIZE_TIMER:
+            return 2;
+        case S7COMM_TRANSPORT_SIZE_DWORD:
+        case S7COMM_TRANSPORT_SIZE_DINT:
+        case S7COMM_TRANSPORT_SIZE_REAL:
+        case S7COMM_TRANSPORT_SIZE_TOD:
+        case S7COMM_TRANSPORT_SIZE_TIME:
+        case S7COMM_TRANSPORT_SIZE_IEC_COUNTER:
+        case S7COMM_TRANSPORT_SIZE_IEC_TIMER:
+        case S7COMM_TRANSPORT_SIZE_HS_COUNTER:
+            return 4;
+        case S7COMM_TRANSPORT_SIZE_DT:
+            return 8;
+        default:
+            /* bit, byte and char are transferred as one byte per element */
+            return 1;
+    }
+}
+
+/**************************************************************************
+ * Byte range of a S7ANY item, used by the packing analysis
+ */
+typedef struct {
+    guint8 area;
+    guint16 db;                         /* only set for DB and DI, otherwise 0 */
+    guint32 start;                      /* first byte */
+    guint32 end;                        /* first byte after the range */
+} s7comm_item_range_t;
+
+static gboolean
+s7comm_get_item_range(const s7comm_item_info_t *item_info,
+                      s7comm_item_range_t *range)
+{
+    /* Bit access, timers and counters can't be merged with other items */
+    if (item_info->syntax_id != S7COMM_SYNTAXID_S7ANY || item_info->len == 0 ||
+        item_info->t_size == S7COMM_TRANSPORT_SIZE_BIT ||
+        item_info->area == S7COMM_AREA_TIMER || item_info->area == S7COMM_AREA_COUNTER) {
+        return FALSE;
+    }
+    range->area = item_info->area;
+    range->db = (item_info->area == S7COMM_AREA_DB || item_info->area == S7COMM_AREA_DI) ? item_info->db : 0;
+    range->start = item_info->bytepos;
+    range->end = item_info->bytepos + item_info->len * s7comm_get_transport_size_bytes(item_info->t_size);
+    return TRUE;
+}
+
+/* TRUE if both items have the same address. The structs are not compared as a whole, as the padding is undefined */
+static gboolean
+s7comm_item_info_equal(const s7comm_item_info_t *a,
+                       const s7comm_item_info_t *b)
+{
+    return a->syntax_id == b->syntax_id && a->t_size == b->t_size && a->len == b->len &&
+        a->db == b->db && a->area == b->area && a->bytepos == b->bytepos && a->bitpos == b->bitpos;
+}
+
+/* Item of the coalesced proposal, a merged range or an item which can't be merged */
+typedef struct {
+    const gchar *address;
+    guint32 bytes;                      /* Number of data bytes in the response */
+    guint request;                      /* Number of the request it is put in, from 1 */
+} s7comm_proposal_item_t;
+
+static const gchar *
+s7comm_get_area_str(guint8 area,
+                    guint16 db)
+{
+    if (area == S7COMM_AREA_DB || area == S7COMM_AREA_DI) {
+        return wmem_strdup_printf(wmem_packet_scope(), "%s%u", (area == S7COMM_AREA_DB) ? "DB" : "DI", db);
+    }
+    return val_to_str(area, item_areanames, "Unknown area: 0x%02x");
+}
+
+static int
+s7comm_item_range_compare(const void *a,
+                          const void *b)
+{
+    const s7comm_item_range_t *ra = (const s7comm_item_range_t *)a;
+    const s7comm_item_range_t *rb = (const s7comm_item_range_t *)b;
+
+    if (ra->area != rb->area) {
+        return (ra->area < rb->area) ? -1 : 1;
+    }
+    if (ra->db != rb->db) {
+        return (ra->db < rb->db) ? -1 : 1;
+    }
+    if (ra->start != rb->start) {
+        return (ra->start < rb->start) ? -1 : 1;
+    }
+    return 0;
+}
+
+/* TRUE if any item of the two requests reads an overlapping range */
+static gboolean
+s7comm_read_requests_overlap(const s7comm_transaction_t *ta,
+                             const s7comm_transaction_t *tb)
+{
+    s7comm_item_range_t ra, rb;
+    guint8 i, j;
+
+    for (i = 0; i < ta->item_count; i++) {
+        if (!s7comm_get_item_range(&ta->items[i], &ra)) {
+            continue;
+        }
+        for (j = 0; j < tb->item_count; j++) {
+            if (s7comm_get_item_range(&tb->items[j], &rb) &&
+                ra.area == rb.area && ra.db == rb.db && ra.start < rb.end && rb.start < ra.end) {
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+/*******************************************************************************************************
+ *
+ * Packing analysis of a Read Var request
+ * - Size of the expected response relative to the negotiated PDU length
+ * - Items reading the same or overlapping ranges, or adjacent ranges which could be read as one item
+ * - The smallest set of items reading the same bytes
+ * - Overlap with another Read Var request of the same poll cycle. A poll cycle of a connection
+ *   ends when a request with the same items is sent again.
+ *
+ *******************************************************************************************************/
+static void
+s7comm_analyze_read_request(tvbuff_t *tvb,
+                            packet_info *pinfo,
+                            proto_tree *tree,
+                            guint16 plength,
+                            guint8 item_count,
+                            const s7comm_item_info_t *items,
+                            s7comm_transaction_t *trans)
+{
+    proto_item *item = NULL;
+    proto_tree *analysis_tree = NULL;
+    s7comm_conv_info_t *conv_info;
+    s7comm_transaction_t *prev;
+    s7comm_item_range_t *ranges;
+    s7comm_item_range_t ri, rj;
+    s7comm_proposal_item_t *proposal;
+    wmem_strbuf_t *coalesced;
+    guint32 resp_size;
+    guint32 req_size;
+    guint32 bytes;
+    guint32 max_bytes;
+    guint32 start;
+    guint32 prop_resp_size;
+    guint32 prop_req_size;
+    guint range_count = 0;
+    guint merged_count = 0;
+    guint prop_count;
+    guint req_count;
+    guint n;
+    guint8 i, j;
+
+    if (trans == NULL || items == NULL) {
+        return;
+    }
+
+    /* Only the first pass sees the requests in capture order */
+    if (!PINFO_FD_VISITED(pinfo)) {
+        conv_info = s7comm_get_conv_info(pinfo);
+        for (n = 1; n <= S7COMM_READ_HISTORY_SIZE; n++) {
+            prev = conv_info->read_history[(conv_info->read_history_pos + S7COMM_READ_HISTORY_SIZE - n) % S7COMM_READ_HISTORY_SIZE];
+            if (prev == NULL) {
+                break;
+            }
+            /* Same request as in the previous poll cycle */
+            if (prev->item_count == trans->item_count) {
+                for (i = 0; i < trans->item_count; i++) {
+                    if (!s7comm_item_info_equal(&prev->items[i], &trans->items[i])) {
+                        break;
+                    }
+                }
+                if (i == trans->item_count) {
+                    break;
+                }
+            }
+            if (s7comm_read_requests_overlap(prev, trans)) {
+                trans->overlap_frame = prev->req_frame;
+                break;
+            }
+        }
+        conv_info->read_history[conv_info->read_history_pos] = trans;
+        conv_info->read_history_pos = (conv_info->read_history_pos + 1) % S7COMM_READ_HISTORY_SIZE;
+    }
+
+    item = proto_tree_add_item(tree, hf_s7comm_analysis, tvb, 0, 0, ENC_NA);
+    proto_item_set_generated(item);
+    analysis_tree = proto_item_add_subtree(item, ett_s7comm_analysis);
+
+    /* Response: header 12, function and item count 2, per item 4 bytes header and the data with fill byte */
+    resp_size = 14;
+    for (i = 0; i < item_count; i++) {
+        bytes = 0;
+        if (items[i].syntax_id == S7COMM_SYNTAXID_S7ANY) {
+            bytes = items[i].len * s7comm_get_transport_size_bytes(items[i].t_size);
+        }
+        resp_size += 4 + bytes;
+        if ((bytes % 2) && (i < item_count - 1)) {
+            resp_size += 1;
+        }
+    }
+    req_size = 10 + plength;
+    item = proto_tree_add_uint(analysis_tree, hf_s7comm_analysis_resp_size, tvb, 0, 0, resp_size);
+    proto_item_set_generated(item);
+    if (trans->pdu_length > 0) {
+        item = proto_tree_add_uint(analysis_tree, hf_s7comm_analysis_pdu_length, tvb, 0, 0, trans->pdu_length);
+        proto_item_set_generated(item);
+        item = proto_tree_add_uint(analysis_tree, hf_s7comm_analysis_pdu_fill, tvb, 0, 0,
+            (MAX(resp_size, req_size) * 100) / trans->pdu_length);
+        proto_item_set_generated(item);
+    }
+
+    /* Overlapping and adjacent items of this request */
+    ranges = wmem_alloc_array(wmem_packet_scope(), s7comm_item_range_t, item_count > 0 ? item_count : 1);
+    for (i = 0; i < item_count; i++) {
+        if (!s7comm_get_item_range(&items[i], &ri)) {
+            continue;
+        }
+        ranges[range_count++] = ri;
+        for (j = i + 1; j < item_count; j++) {
+            if (!s7comm_get_item_range(&items[j], &rj) || ri.area != rj.area || ri.db != rj.db) {
+                continue;
+            }
+            if (ri.start < rj.end && rj.start < ri.end) {
+                expert_add_info_format(pinfo, analysis_tree, &ei_s7comm_analysis_item_overlap,
+                    "Item [%d] and item [%d] read overlapping ranges", i + 1, j + 1);
+            } else if (ri.end == rj.start || rj.end == ri.start) {
+                expert_add_info_format(pinfo, analysis_tree, &ei_s7comm_analysis_item_adjacent,
+                    "Item [%d] and item [%d] read adjacent ranges and could be one item", i + 1, j + 1);
+            }
+        }
+    }
+
+    /* Merge overlapping and adjacent ranges to the smallest set of items */
+    if (range_count > 1) {
+        qsort(ranges, range_count, sizeof(s7comm_item_range_t), s7comm_item_range_compare);
+        merged_count = 0;
+        for (n = 1; n < range_count; n++) {
+            if (ranges[n].area == ranges[merged_count].area && ranges[n].db == ranges[merged_count].db &&
+                ranges[n].start <= ranges[merged_count].end) {
+                ranges[merged_count].end = MAX(ranges[merged_count].end, ranges[n].end);
+            } else {
+                ranges[++merged_count] = ranges[n];
+            }
+        }
+        merged_count += 1;
+        /* A merged range must fit into one response: header 14 bytes, item header 4 bytes */
+        max_bytes = (trans->pdu_length > 18) ? trans->pdu_length - 18 : 0;
+        prop_count = item_count - range_count;
+        for (n = 0; n < merged_count; n++) {
+            bytes = ranges[n].end - ranges[n].start;
+            prop_count += (max_bytes > 0) ? (bytes + max_bytes - 1) / max_bytes : 1;
+        }
+        if (prop_count < item_count) {
+            proposal = wmem_alloc_array(wmem_packet_scope(), s7comm_proposal_item_t, prop_count);
+            prop_count = 0;
+            for (n = 0; n < merged_count; n++) {
+                for (start = ranges[n].start; start < ranges[n].end; start += bytes) {
+                    bytes = ranges[n].end - start;
+                    if (max_bytes > 0 && bytes > max_bytes) {
+                        bytes = max_bytes;
+                    }
+                    proposal[prop_count].address = wmem_strdup_printf(wmem_packet_scope(), "%s BYTE %u-%u",
+                        s7comm_get_area_str(ranges[n].area, ranges[n].db), start, start + bytes - 1);
+                    proposal[prop_count].bytes = bytes;
+                    prop_count++;
+                }
+            }
+            /* Items which can't be merged are taken over unchanged */
+            for (i = 0; i < item_count; i++) {
+                if (s7comm_get_item_range(&items[i], &ri)) {
+                    continue;
+                }
+                if (items[i].syntax_id != S7COMM_SYNTAXID_S7ANY) {
+                    proposal[prop_count].address = wmem_strdup_printf(wmem_packet_scope(), "Item [%d]", i + 1);
+                    proposal[prop_count].bytes = 0;
+                } else if (items[i].area == S7COMM_AREA_TIMER || items[i].area == S7COMM_AREA_COUNTER) {
+                    proposal[prop_count].address = wmem_strdup_printf(wmem_packet_scope(), "%s %u",
+                        s7comm_get_area_str(items[i].area, items[i].db), items[i].bytepos * 8 + items[i].bitpos);
+                    proposal[prop_count].bytes = items[i].len * s7comm_get_transport_size_bytes(items[i].t_size);
+                } else {
+                    proposal[prop_count].address = wmem_strdup_printf(wmem_packet_scope(), "%s %u.%u %s %u",
+                        s7comm_get_area_str(items[i].area, items[i].db), items[i].bytepos, items[i].bitpos,
+                        val_to_str(items[i].t_size, item_transportsizenames, "Unknown transport size: 0x%02x"), items[i].len);
+                    proposal[prop_count].bytes = items[i].len * s7comm_get_transport_size_bytes(items[i].t_size);
+                }
+                prop_count++;
+            }
+            /* Split into requests, so that each request and its response fit into the PDU length.
+             * Request: header 10, function and item count 2, per item 12 bytes.
+             */
+            req_count = 1;
+            prop_req_size = 12;
+            prop_resp_size = 14;
+            for (n = 0; n < prop_count; n++) {
+                bytes = 4 + proposal[n].bytes + (proposal[n].bytes % 2);
+                if (trans->pdu_length > 0 && prop_req_size > 12 &&
+                    (prop_req_size + 12 > trans->pdu_length || prop_resp_size + bytes > trans->pdu_length)) {
+                    req_count++;
+                    prop_req_size = 12;
+                    prop_resp_size = 14;
+                }
+                prop_req_size += 12;
+                prop_resp_size += bytes;
+                proposal[n].request = req_count;
+            }
+            item = proto_tree_add_uint(analysis_tree, hf_s7comm_analysis_coalesced_count, tvb, 0, 0, prop_count);
+            proto_item_set_generated(item);
+            item = proto_tree_add_uint(analysis_tree, hf_s7comm_analysis_coalesced_requests, tvb, 0, 0, req_count);
+            proto_item_set_generated(item);
+            coalesced = wmem_strbuf_new(wmem_packet_scope(), "");
+            for (n = 0; n < prop_count; n++) {
+                if (req_count > 1 && (n == 0 || proposal[n].request != proposal[n - 1].request)) {
+                    if (n > 0) {
+                        wmem_strbuf_append(coalesced, "; ");
+                    }
+                    wmem_strbuf_append_printf(coalesced, "Request %u: ", proposal[n].request);
+                } else if (n > 0) {
+                    wmem_strbuf_append(coalesced, ", ");
+                }
+                wmem_strbuf_append(coalesced, proposal[n].address);
+            }
+            item = proto_tree_add_string(analysis_tree, hf_s7comm_analysis_coalesced, tvb, 0, 0, wmem_strbuf_get_str(coalesced));
+            proto_item_set_generated(item);
+        }
+    }
+
+    /* Overlap with another request of the same poll cycle */
+    if (trans->overlap_frame) {
+        item = proto_tree_add_uint(analysis_tree, hf_s7comm_analysis_overlap_frame, tvb, 0, 0, trans->overlap_frame);
+        proto_item_set_generated(item);
+        expert_add_info_format(pinfo, item, &ei_s7comm_analysis_redundant_read,
+            "Reads ranges already read by the request in frame %u of the same poll cycle", trans->overlap_frame);
+    }
+}
+
 /*******************************************************************************************************
  *
  * PDU Type: Response -> Function Write  -> Data part
@@ -2251,23 +2878,122 @@ s7comm_decode_response_write_data(tvbuff_t *tvb,
         /* Insert a new tree for every item */
         item = proto_tree_add_item(tree, hf_s7comm_data_item, tvb, offset, 1, ENC_NA);
         item_tree = proto_item_add_subtree(item, ett_s7comm_data_item);
-        proto_item_append_text(item, " [%d]: (%s)", i, val_to_str(ret_val, s7comm_item_return_valuenames, "Unknown code: 0x%02x"));
+        if (S7COMM_TREE_VISIBLE(item_tree)) {
+            proto_item_append_text(item, " [%d]: (%s)", i, val_to_str(ret_val, s7comm_item_return_valuenames, "Unknown code: 0x%02x"));
+        }
         proto_tree_add_uint(item_tree, hf_s7comm_data_returncode, tvb, offset, 1, ret_val);
         offset += 1;
     }
     return offset;
 }
 
+/*******************************************************************************************************
+ *
+ * Decode the data of a read/write item into typed values, using the transport size of the request item.
+ * The data is fetched once with a single bounds check and converted from the buffer.
+ * BYTE and CHAR ranges are added as one item. Of the other types only the first
+ * S7COMM_DATA_VALUES_MAX_DISPLAY values are added.
+ *
+ *******************************************************************************************************/
+static void
+s7comm_decode_read_data_values(tvbuff_t *tvb,
+                               proto_tree *tree,
+                               const s7comm_item_info_t *item_info,
+                               guint32 offset,
+                               guint16 len)
+{
+    const guint8 *p;
+    guint16 elem_size;
+    guint16 elem_count;
+    guint16 elem_shown;
+    guint16 i;
+    guint32 u32;
+    proto_item *pi;
+    union {
+        guint32 u;
+        gfloat f;
+    } real;
+
+    if (tree == NULL || item_info->syntax_id != S7COMM_SYNTAXID_S7ANY) {
+        return;
+    }
+    switch (item_info->t_size) {
+        case S7COMM_TRANSPORT_SIZE_BYTE:
+            if (len > 0) {
+                proto_tree_add_item(tree, hf_s7comm_data_value_byte, tvb, offset, len, ENC_NA);
+            }
+            return;
+        case S7COMM_TRANSPORT_SIZE_CHAR:
+            if (len > 0) {
+                proto_tree_add_item(tree, hf_s7comm_data_value_char, tvb, offset, len, ENC_ASCII|ENC_NA);
+            }
+            return;
+        case S7COMM_TRANSPORT_SIZE_WORD:
+        case S7COMM_TRANSPORT_SIZE_INT:
+            elem_size = 2;
+            break;
+        case S7COMM_TRANSPORT_SIZE_DWORD:
+        case S7COMM_TRANSPORT_SIZE_DINT:
+        case S7COMM_TRANSPORT_SIZE_REAL:
+            elem_size = 4;
+            break;
+        default:
+            return;
+    }
+    if (len == 0 || (len % elem_size)) {
+        return;
+    }
+    elem_count = len / elem_size;
+    elem_shown = MIN(elem_count, S7COMM_DATA_VALUES_MAX_DISPLAY);
+    p = tvb_get_ptr(tvb, offset, elem_shown * elem_size);
+
+    for (i = 0; i < elem_shown; i++, p += elem_size, offset += elem_size) {
+        switch (item_info->t_size) {
+            case S7COMM_TRANSPORT_SIZE_WORD:
+                proto_tree_add_uint_format(tree, hf_s7comm_data_value_word, tvb, offset, 2, pntoh16(p),
+                    "WORD[%u]: 0x%04x", i, pntoh16(p));
+                break;
+            case S7COMM_TRANSPORT_SIZE_INT:
+                proto_tree_add_int_format(tree, hf_s7comm_data_value_int, tvb, offset, 2, (gint16)pntoh16(p),
+                    "INT[%u]: %d", i, (gint16)pntoh16(p));
+                break;
+            case S7COMM_TRANSPORT_SIZE_DWORD:
+                u32 = pntoh32(p);
+                proto_tree_add_uint_format(tree, hf_s7comm_data_value_dword, tvb, offset, 4, u32,
+                    "DWORD[%u]: 0x%08x", i, u32);
+                break;
+            case S7COMM_TRANSPORT_SIZE_DINT:
+                u32 = pntoh32(p);
+                proto_tree_add_int_format(tree, hf_s7comm_data_value_dint, tvb, offset, 4, (gint32)u32,
+                    "DINT[%u]: %d", i, (gint32)u32);
+                break;
+            case S7COMM_TRANSPORT_SIZE_REAL:
+                real.u = pntoh32(p);
+                proto_tree_add_float_format(tree, hf_s7comm_data_value_real, tvb, offset, 4, real.f,
+                    "REAL[%u]: %g", i, real.f);
+                break;
+        }
+    }
+    if (elem_shown < elem_count) {
+        pi = proto_tree_add_uint(tree, hf_s7comm_data_value_not_shown, tvb, offset, len - elem_shown * elem_size, elem_count - elem_shown);
+        proto_item_set_generated(pi);
+    }
+}
+
 /*******************************************************************************************************
  *
  * PDU Type: Response -> Function Read  -> Data part
  *           Request  -> Function Write -> Data part
  *
+ * If the items of the request are known (items != NULL), the data is also shown as typed values.
+ *
  *******************************************************************************************************/
 static guint32
 s7comm_decode_response_read_data(tvbuff_t *tvb,
                                  proto_tree *tree,
                                  guint8 item_count,
+                                 const s7comm_item_info_t *items,
+                                 guint8 items_count,
                                  guint32 offset)
 {
     guint8 ret_val = 0;
@@ -2309,7 +3035,9 @@ s7comm_decode_response_read_data(tvbuff_t *tvb,
         /* Insert a new tree for every item */
         item = proto_tree_add_item(tree, hf_s7comm_data_item, tvb, offset, len + head_len, ENC_NA);
         item_tree = proto_item_add_subtree(item, ett_s7comm_data_item);
-        proto_item_append_text(item, " [%d]: (%s)", i, val_to_str(ret_val, s7comm_item_return_valuenames, "Unknown code: 0x%02x"));
+        if (S7COMM_TREE_VISIBLE(item_tree)) {
+            proto_item_append_text(item, " [%d]: (%s)", i, val_to_str(ret_val, s7comm_item_return_valuenames, "Unknown code: 0x%02x"));
+        }
 
         proto_tree_add_uint(item_tree, hf_s7comm_data_returncode, tvb, offset, 1, ret_val);
         proto_tree_add_uint(item_tree, hf_s7comm_data_transport_size, tvb, offset + 1, 1, tsize);
@@ -2318,6 +3046,9 @@ s7comm_decode_response_read_data(tvbuff_t *tvb,
 
         if (ret_val == S7COMM_ITEM_RETVAL_DATA_OK || ret_val == S7COMM_ITEM_RETVAL_RESERVED) {
             proto_tree_add_item(item_tree, hf_s7comm_readresponse_data, tvb, offset, len, ENC_NA);
+            if (items != NULL && i <= items_count) {
+                s7comm_decode_read_data_values(tvb, item_tree, &items[i - 1], offset, len);
+            }
             offset += len;
             if (len != len2) {
                 proto_tree_add_item(item_tree, hf_s7comm_data_fillbyte, tvb, offset, 1, ENC_BIG_ENDIAN);
@@ -2441,11 +3172,14 @@ s7comm_decode_plc_controls_param_hex1x(tvbuff_t *tvb,
                       packet_info *pinfo,
                       proto_tree *tree,
                       guint16 plength,
-                      guint32 offset)
+                      guint32 offset,
+                      s7comm_transaction_t *trans)
 {
     guint8 len;
     guint8 function;
     guint8 *str;
+    guint8 blocktype;
+    guint32 upload_id;
 
     function = tvb_get_guint8(tvb, offset);
     offset += 1;
@@ -2456,8 +3190,18 @@ s7comm_decode_plc_controls_param_hex1x(tvbuff_t *tvb,
     /* These 2 bytes seems to be an error code. If an upload fails, this value is also shown in Manager as errorcode. Zero on success. */
     proto_tree_add_item(tree, hf_s7comm_data_blockcontrol_errorcode, tvb, offset, 2, ENC_BIG_ENDIAN);
     offset += 2;
-    /* unknown 4 bytes */
-    proto_tree_add_item(tree, hf_s7comm_data_blockcontrol_unknown1, tvb, offset, 4, ENC_NA);
+    if (function == S7COMM_FUNCUPLOAD || function == S7COMM_FUNCENDUPLOAD) {
+        /* ID given by the PLC in the start upload response */
+        upload_id = tvb_get_ntohl(tvb, offset);
+        proto_tree_add_uint(tree, hf_s7comm_data_blockcontrol_uploadid, tvb, offset, 4, upload_id);
+        if (trans != NULL && !PINFO_FD_VISITED(pinfo)) {
+            trans->upload_id = upload_id;
+            trans->block_name = (gchar *)wmem_tree_lookup32(s7comm_get_conv_info(pinfo)->uploads, upload_id);
+        }
+    } else {
+        /* unknown 4 bytes */
+        proto_tree_add_item(tree, hf_s7comm_data_blockcontrol_unknown1, tvb, offset, 4, ENC_NA);
+    }
     offset += 4;
     if (plength <= 8) {
         /* Upload or End upload functions have no other data */
@@ -2478,14 +3222,20 @@ s7comm_decode_plc_controls_param_hex1x(tvbuff_t *tvb,
     /* First byte of block type is every time '0' */
     proto_tree_add_item(tree, hf_s7comm_data_blockcontrol_block_unknown, tvb, offset, 1, ENC_ASCII|ENC_NA);
     offset += 1;
+    blocktype = tvb_get_guint8(tvb, offset);
     proto_tree_add_item(tree, hf_s7comm_data_blockcontrol_block_type, tvb, offset, 1, ENC_BIG_ENDIAN);
-    col_append_fstr(pinfo->cinfo, COL_INFO, " Type:[%s]", val_to_str(tvb_get_guint8(tvb, offset), blocktype_names, "Unknown Block type: 0x%02x"));
+    col_append_fstr(pinfo->cinfo, COL_INFO, " Type:[%s]", val_to_str(blocktype, blocktype_names, "Unknown Block type: 0x%02x"));
     offset += 1;
 
     str = tvb_get_string_enc(wmem_packet_scope(), tvb, offset, 5, ENC_ASCII);
     proto_tree_add_item(tree, hf_s7comm_data_blockcontrol_block_num, tvb, offset, 5, ENC_ASCII|ENC_NA);
     col_append_fstr(pinfo->cinfo, COL_INFO, " No.:[%s]", str);
     offset += 5;
+    /* Remember the block name, it's used as filename of the uploaded block */
+    if (function == S7COMM_FUNCSTARTUPLOAD && trans != NULL && !PINFO_FD_VISITED(pinfo)) {
+        trans->block_name = wmem_strdup_printf(wmem_file_scope(), "%s%s",
+            val_to_str(blocktype, blocktype_names, "0x%02x"), str);
+    }
     /* 'P', 'B' or 'A' is following */
     proto_tree_add_item(tree, hf_s7comm_data_blockcontrol_dest_filesys, tvb, offset, 1, ENC_ASCII|ENC_NA);
     offset += 1;
@@ -2506,6 +3256,129 @@ s7comm_decode_plc_controls_param_hex1x(tvbuff_t *tvb,
     return offset;
 }
 
+/*******************************************************************************************************
+ *
+ * PDU Type: Response -> Function 0x1d, 0x1e (Start upload, Upload)
+ * The data of the upload responses is reassembled to the complete block,
+ * which is offered by the export object tap.
+ * The reassembly table keeps a copy of each part until the block is complete,
+ * and then combines the parts into one buffer. The tree and the export object
+ * tap reference this buffer through the reassembled tvb.
+ *
+ *******************************************************************************************************/
+static guint32
+s7comm_decode_plc_controls_upload_response(tvbuff_t *tvb,
+                      packet_info *pinfo,
+                      proto_tree *tree,
+                      proto_tree *param_tree,
+                      guint16 plength,
+                      guint16 dlength,
+                      guint32 offset,
+                      s7comm_transaction_t *trans)
+{
+    proto_item *item = NULL;
+    proto_tree *data_tree = NULL;
+    guint8 function;
+    guint8 status;
+    guint8 len;
+    guint16 upload_len;
+    guint32 upload_id;
+    guint32 param_end;
+    guint32 data_end;
+    fragment_head *fd_head;
+    tvbuff_t *new_tvb;
+    gboolean save_fragmented;
+    s7comm_eo_t *eo_info;
+
+    param_end = offset + plength;
+    data_end = param_end + dlength;
+
+    function = tvb_get_guint8(tvb, offset);
+    offset += 1;
+    status = tvb_get_guint8(tvb, offset);
+    proto_tree_add_uint(param_tree, hf_s7comm_data_blockcontrol_functionstatus, tvb, offset, 1, status);
+    offset += 1;
+
+    if (function == S7COMM_FUNCSTARTUPLOAD && plength >= 8) {
+        proto_tree_add_item(param_tree, hf_s7comm_data_blockcontrol_unknown1, tvb, offset, 2, ENC_NA);
+        offset += 2;
+        upload_id = tvb_get_ntohl(tvb, offset);
+        proto_tree_add_uint(param_tree, hf_s7comm_data_blockcontrol_uploadid, tvb, offset, 4, upload_id);
+        offset += 4;
+        /* The following upload requests only carry the ID, so remember which block it is */
+        if (trans != NULL && trans->block_name != NULL && !PINFO_FD_VISITED(pinfo)) {
+            wmem_tree_insert32(s7comm_get_conv_info(pinfo)->uploads, upload_id, trans->block_name);
+        }
+        if (offset < param_end) {
+            len = tvb_get_guint8(tvb, offset);
+            proto_tree_add_uint(param_tree, hf_s7comm_data_blockcontrol_part2_len, tvb, offset, 1, len);
+            offset += 1;
+            proto_tree_add_item(param_tree, hf_s7comm_data_blockcontrol_blocklen, tvb, offset, len, ENC_ASCII|ENC_NA);
+            offset += len;
+        }
+    }
+    if (offset < param_end) {
+        proto_tree_add_item(param_tree, hf_s7comm_param_data, tvb, offset, param_end - offset, ENC_NA);
+    }
+    offset = param_end;
+
+    if (dlength == 0) {
+        return offset;
+    }
+    item = proto_tree_add_item(tree, hf_s7comm_data, tvb, offset, dlength, ENC_NA);
+    data_tree = proto_item_add_subtree(item, ett_s7comm_data);
+    if (function != S7COMM_FUNCUPLOAD || dlength < 4) {
+        proto_tree_add_item(data_tree, hf_s7comm_readresponse_data, tvb, offset, dlength, ENC_NA);
+        return data_end;
+    }
+
+    upload_len = tvb_get_ntohs(tvb, offset);
+    proto_tree_add_uint(data_tree, hf_s7comm_data_blockcontrol_upload_len, tvb, offset, 2, upload_len);
+    offset += 2;
+    proto_tree_add_item(data_tree, hf_s7comm_data_blockcontrol_upload_unknown, tvb, offset, 2, ENC_NA);
+    offset += 2;
+    if (upload_len > dlength - 4) {
+        upload_len = dlength - 4;
+    }
+    proto_tree_add_item(data_tree, hf_s7comm_data_blockcontrol_upload_data, tvb, offset, upload_len, ENC_NA);
+
+    /* Without the request the upload ID is unknown, and the data can't be assigned to a block */
+    if (trans != NULL) {
+        save_fragmented = pinfo->fragmented;
+        pinfo->fragmented = TRUE;
+        fd_head = fragment_add_seq_next(&s7comm_upload_reassembly_table,
+                                         tvb, offset, pinfo,
+                                         trans->upload_id,      /* ID for fragments belonging together */
+                                         NULL,                  /* void *data */
+                                         upload_len,            /* fragment length */
+                                         (status & S7COMM_BLOCKCONTROL_STATUS_MORE)); /* More fragments? */
+        new_tvb = process_reassembled_data(tvb, offset, pinfo,
+                                           "Uploaded block", fd_head, &s7comm_upload_frag_items,
+                                           NULL, data_tree);
+        pinfo->fragmented = save_fragmented;
+        if (new_tvb != NULL) {
+            item = proto_tree_add_item(data_tree, hf_s7comm_data_blockcontrol_block, new_tvb, 0, -1, ENC_NA);
+            if (trans->block_name != NULL) {
+                proto_item_append_text(item, " (%s)", trans->block_name);
+                col_append_fstr(pinfo->cinfo, COL_INFO, " Block:[%s] complete", trans->block_name);
+            }
+            if (have_tap_listener(s7comm_eo_tap)) {
+                eo_info = wmem_new(wmem_packet_scope(), s7comm_eo_t);
+                if (trans->block_name != NULL) {
+                    eo_info->filename = wmem_strdup_printf(wmem_packet_scope(), "%s.mc7", trans->block_name);
+                } else {
+                    eo_info->filename = wmem_strdup_printf(wmem_packet_scope(), "upload_%u.mc7", trans->upload_id);
+                }
+                eo_info->payload_len = tvb_reported_length(new_tvb);
+                /* new_tvb is backed by the reassembled buffer, so this is no copy */
+                eo_info->payload_data = tvb_get_ptr(new_tvb, 0, eo_info->payload_len);
+                tap_queue_packet(s7comm_eo_tap, pinfo, eo_info);
+            }
+        }
+    }
+    return data_end;
+}
+
 /*******************************************************************************************************
  *
  * PDU Type: User Data -> Function group 1 -> Programmer commands -> Request diagnostic data (0x13 or 0x01)
@@ -2631,6 +3504,9 @@ s7comm_decode_ud_prog_vartab_req_item(tvbuff_t *tvb,
     proto_tree_add_uint(sub_tree, hf_s7comm_vartab_req_startaddress, tvb, offset, 2, bytepos);
     offset += 2;
 
+    if (!S7COMM_TREE_VISIBLE(sub_tree)) {
+        return offset;
+    }
     /* build a full address to show item data directly beside the item */
     switch (area) {
         case S7COMM_UD_SUBF_PROG_VARTAB_AREA_MB:
@@ -2736,7 +3612,9 @@ s7comm_decode_ud_prog_vartab_res_item(tvbuff_t *tvb,
     item = proto_tree_add_item(sub_tree, hf_s7comm_data_item, tvb, offset, len + head_len, ENC_NA);
     sub_tree = proto_item_add_subtree(item, ett_s7comm_data_item);
 
-    proto_item_append_text(item, " [%d]: (%s)", item_no + 1, val_to_str(ret_val, s7comm_item_return_valuenames, "Unknown code: 0x%02x"));
+    if (S7COMM_TREE_VISIBLE(sub_tree)) {
+        proto_item_append_text(item, " [%d]: (%s)", item_no + 1, val_to_str(ret_val, s7comm_item_return_valuenames, "Unknown code: 0x%02x"));
+    }
 
     proto_tree_add_uint(sub_tree, hf_s7comm_data_returncode, tvb, offset, 1, ret_val);
     proto_tree_add_uint(sub_tree, hf_s7comm_data_transport_size, tvb, offset + 1, 1, tsize);
@@ -3015,7 +3893,7 @@ s7comm_decode_ud_cpu_alarm_main(tvbuff_t *tvb,
                             asc_start_offset = offset;
                             msg_work_item = proto_tree_add_item(msg_obj_item_tree, hf_s7comm_cpu_alarm_message_associated_value, tvb, offset, 0, ENC_NA);
                             msg_work_item_tree = proto_item_add_subtree(msg_work_item, ett_s7comm_cpu_alarm_message_associated_value);
-                            offset = s7comm_decode_response_read_data(tvb, msg_work_item_tree, nr_of_additional_values, offset);
+                            offset = s7comm_decode_response_read_data(tvb, msg_work_item_tree, nr_of_additional_values, NULL, 0, offset);
                             proto_item_set_len(msg_work_item_tree, offset - asc_start_offset);
                         }
                     }
@@ -3174,7 +4052,7 @@ s7comm_decode_ud_cpu_alarm_query_response(tvbuff_t *tvb,
                 asc_start_offset = offset;
                 msg_work_item = proto_tree_add_item(msg_obj_item_tree, hf_s7comm_cpu_alarm_message_associated_value, tvb, offset, 0, ENC_NA);
                 msg_work_item_tree = proto_item_add_subtree(msg_work_item, ett_s7comm_cpu_alarm_message_associated_value);
-                offset = s7comm_decode_response_read_data(tvb, msg_work_item_tree, 1, offset);
+                offset = s7comm_decode_response_read_data(tvb, msg_work_item_tree, 1, NULL, 0, offset);
                 proto_item_set_len(msg_work_item_tree, offset - asc_start_offset);
                 /* 8 bytes timestamp (going)
                  * If all bytes in timestamp are zero, then the message is still active. */
@@ -3185,7 +4063,7 @@ s7comm_decode_ud_cpu_alarm_query_response(tvbuff_t *tvb,
                 asc_start_offset = offset;
                 msg_work_item = proto_tree_add_item(msg_obj_item_tree, hf_s7comm_cpu_alarm_message_associated_value, tvb, offset, 0, ENC_NA);
                 msg_work_item_tree = proto_item_add_subtree(msg_work_item, ett_s7comm_cpu_alarm_message_associated_value);
-                offset = s7comm_decode_response_read_data(tvb, msg_work_item_tree, 1, offset);
+                offset = s7comm_decode_response_read_data(tvb, msg_work_item_tree, 1, NULL, 0, offset);
                 proto_item_set_len(msg_work_item_tree, offset - asc_start_offset);
             }
             remaining_length = remaining_length - (offset - msg_obj_start_offset);
@@ -3342,6 +4220,7 @@ s7comm_decode_ud_block_subfunc(tvbuff_t *tvb,
     guint8 *pBlocknumber;
     guint16 blocknumber;
     guint8 blocktype;
+    const gchar *blocktype_str;
     gboolean know_data = FALSE;
     proto_item *item = NULL;
     proto_tree *item_tree = NULL;
@@ -3364,7 +4243,9 @@ s7comm_decode_ud_block_subfunc(tvbuff_t *tvb,
                     item = proto_tree_add_item(data_tree, hf_s7comm_data_item, tvb, offset, 4, ENC_NA);
                     item_tree = proto_item_add_subtree(item, ett_s7comm_data_item);
                     offset += 1; /* skip first byte */
-                    proto_item_append_text(item, " [%d]: (Block type %s)", i+1, val_to_str(tvb_get_guint8(tvb, offset), blocktype_names, "Unknown Block type: 0x%02x"));
+                    if (S7COMM_TREE_VISIBLE(item_tree)) {
+                        proto_item_append_text(item, " [%d]: (Block type %s)", i+1, val_to_str(tvb_get_guint8(tvb, offset), blocktype_names, "Unknown Block type: 0x%02x"));
+                    }
                     proto_tree_add_item(item_tree, hf_s7comm_ud_blockinfo_block_type, tvb, offset, 1, ENC_BIG_ENDIAN);
                     offset += 1;
                     proto_tree_add_item(item_tree, hf_s7comm_ud_blockinfo_block_cnt, tvb, offset, 2, ENC_BIG_ENDIAN);
@@ -3381,10 +4262,11 @@ s7comm_decode_ud_block_subfunc(tvbuff_t *tvb,
                 if (tsize != S7COMM_DATA_TRANSPORT_SIZE_NULL) {
                     offset += 1; /* skip first byte */
                     proto_tree_add_item(data_tree, hf_s7comm_ud_blockinfo_block_type, tvb, offset, 1, ENC_BIG_ENDIAN);
-                    col_append_fstr(pinfo->cinfo, COL_INFO, " Type:[%s]",
-                        val_to_str(tvb_get_guint8(tvb, offset), blocktype_names, "Unknown Block type: 0x%02x"));
-                    proto_item_append_text(data_tree, ": (%s)",
-                        val_to_str(tvb_get_guint8(tvb, offset), blocktype_names, "Unknown Block type: 0x%02x"));
+                    blocktype_str = val_to_str(tvb_get_guint8(tvb, offset), blocktype_names, "Unknown Block type: 0x%02x");
+                    col_append_fstr(pinfo->cinfo, COL_INFO, " Type:[%s]", blocktype_str);
+                    if (S7COMM_TREE_VISIBLE(data_tree)) {
+                        proto_item_append_text(data_tree, ": (%s)", blocktype_str);
+                    }
                     offset += 1;
                 }
                 know_data = TRUE;
@@ -3398,7 +4280,9 @@ s7comm_decode_ud_block_subfunc(tvbuff_t *tvb,
                         item = proto_tree_add_item(data_tree, hf_s7comm_data_item, tvb, offset, 4, ENC_NA);
                         item_tree = proto_item_add_subtree(item, ett_s7comm_data_item);
 
-                        proto_item_append_text(item, " [%d]: (Block number %d)", i+1, tvb_get_ntohs(tvb, offset));
+                        if (S7COMM_TREE_VISIBLE(item_tree)) {
+                            proto_item_append_text(item, " [%d]: (Block number %d)", i+1, tvb_get_ntohs(tvb, offset));
+                        }
                         proto_tree_add_item(item_tree, hf_s7comm_ud_blockinfo_block_num, tvb, offset, 2, ENC_BIG_ENDIAN);
                         offset += 2;
                         /* The first Byte is unknown, kind of flags? */
@@ -3531,6 +4415,93 @@ s7comm_decode_ud_block_subfunc(tvbuff_t *tvb,
     return offset;
 }
 
+/*******************************************************************************************************
+ *
+ * Cyclic data: Link the response and the pushes to the subscribing request.
+ * The time between the pushes is compared with the requested interval.
+ *
+ *******************************************************************************************************/
+static s7comm_cyclic_sub_t *
+s7comm_link_cyclic_push(tvbuff_t *tvb,
+                        packet_info *pinfo,
+                        proto_tree *tree,
+                        guint8 type,
+                        guint8 job_id,
+                        guint32 bytes,
+                        s7comm_transaction_t *trans)
+{
+    s7comm_conv_info_t *conv_info;
+    s7comm_cyclic_sub_t *sub = NULL;
+    s7comm_cyclic_push_t *push = NULL;
+    proto_item *item = NULL;
+    nstime_t interval;
+    nstime_t lateness;
+
+    if (!PINFO_FD_VISITED(pinfo)) {
+        conv_info = s7comm_get_conv_info(pinfo);
+        if (type == S7COMM_UD_TYPE_RES) {
+            /* Without the request the pushed data can't be decoded */
+            if (trans == NULL || trans->items == NULL) {
+                return NULL;
+            }
+            sub = wmem_new0(wmem_file_scope(), s7comm_cyclic_sub_t);
+            sub->req_frame = trans->req_frame;
+            sub->job_id = job_id;
+            sub->interval_ms = trans->cyclic_interval_ms;
+            sub->item_count = trans->item_count;
+            sub->items = trans->items;
+            wmem_tree_insert32(conv_info->subscriptions, job_id, (void *)sub);
+        } else {
+            sub = (s7comm_cyclic_sub_t *)wmem_tree_lookup32(conv_info->subscriptions, job_id);
+        }
+        if (sub == NULL) {
+            return NULL;
+        }
+        push = wmem_new0(wmem_file_scope(), s7comm_cyclic_push_t);
+        push->sub = sub;
+        push->push_no = sub->push_count;
+        push->bytes = bytes;
+        if (type == S7COMM_UD_TYPE_PUSH) {
+            push->push_no = ++sub->push_count;
+            nstime_delta(&push->delta, &pinfo->fd->abs_ts, &sub->last_time);
+        }
+        sub->last_time = pinfo->fd->abs_ts;
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_s7comm, S7COMM_PROTO_DATA_CYCLIC(pinfo->curr_layer_num), push);
+    } else {
+        push = (s7comm_cyclic_push_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_s7comm, S7COMM_PROTO_DATA_CYCLIC(pinfo->curr_layer_num));
+    }
+    if (push == NULL) {
+        return NULL;
+    }
+    sub = push->sub;
+
+    item = proto_tree_add_uint(tree, hf_s7comm_cycl_request_in, tvb, 0, 0, sub->req_frame);
+    proto_item_set_generated(item);
+    if (sub->interval_ms > 0) {
+        item = proto_tree_add_uint(tree, hf_s7comm_cycl_interval, tvb, 0, 0, sub->interval_ms);
+        proto_item_set_generated(item);
+    }
+    if (push->push_no > 0) {
+        item = proto_tree_add_uint(tree, hf_s7comm_cycl_push_no, tvb, 0, 0, push->push_no);
+        proto_item_set_generated(item);
+        item = proto_tree_add_time(tree, hf_s7comm_cycl_delta, tvb, 0, 0, &push->delta);
+        proto_item_set_generated(item);
+        if (sub->interval_ms > 0) {
+            interval.secs = sub->interval_ms / 1000;
+            interval.nsecs = (sub->interval_ms % 1000) * 1000000;
+            nstime_delta(&lateness, &push->delta, &interval);
+            item = proto_tree_add_time(tree, hf_s7comm_cycl_lateness, tvb, 0, 0, &lateness);
+            proto_item_set_generated(item);
+            if (nstime_to_msec(&push->delta) >= 2.0 * sub->interval_ms) {
+                expert_add_info_format(pinfo, item, &ei_s7comm_cycl_missed_push,
+                    "%.0f ms since the previous push, at least one push of the %u ms interval is missing",
+                    nstime_to_msec(&push->delta), sub->interval_ms);
+            }
+        }
+    }
+    return sub;
+}
+
 /*******************************************************************************************************
  *
  * PDU Type: User Data -> Function group 2 -> cyclic data
@@ -3538,17 +4509,26 @@ s7comm_decode_ud_block_subfunc(tvbuff_t *tvb,
  *******************************************************************************************************/
 static guint32
 s7comm_decode_ud_cyclic_subfunc(tvbuff_t *tvb,
+                                    packet_info *pinfo,
                                     proto_tree *data_tree,
                                     guint8 type,                /* Type of data (request/response) */
                                     guint8 subfunc,             /* Subfunction */
+                                    guint8 data_unit_ref,       /* Job id of the subscription in response and push */
+                                    guint16 len,                /* length of data after the 4 byte header */
                                     guint16 dlength,            /* length of data part given in header */
-                                    guint32 offset)             /* Offset on data part +4 */
+                                    guint32 offset,             /* Offset on data part +4 */
+                                    s7comm_transaction_t *trans)
 {
     gboolean know_data = FALSE;
     guint32 offset_old;
     guint32 len_item;
     guint8 item_count;
     guint8 i;
+    guint8 timebase;
+    guint8 interval_time;
+    s7comm_item_info_t *items = NULL;
+    s7comm_cyclic_sub_t *sub;
+    proto_item *item = NULL;
 
     switch (subfunc)
     {
@@ -3558,14 +4538,39 @@ s7comm_decode_ud_cyclic_subfunc(tvbuff_t *tvb,
             proto_tree_add_uint(data_tree, hf_s7comm_param_itemcount, tvb, offset, 2, item_count);
             offset += 2;
             if (type == S7COMM_UD_TYPE_REQ) {                   /* Request to PLC to send cyclic data */
-                proto_tree_add_item(data_tree, hf_s7comm_cycl_interval_timebase, tvb, offset, 1, ENC_BIG_ENDIAN);
+                timebase = tvb_get_guint8(tvb, offset);
+                proto_tree_add_uint(data_tree, hf_s7comm_cycl_interval_timebase, tvb, offset, 1, timebase);
                 offset += 1;
-                proto_tree_add_item(data_tree, hf_s7comm_cycl_interval_time, tvb, offset, 1, ENC_BIG_ENDIAN);
+                interval_time = tvb_get_guint8(tvb, offset);
+                proto_tree_add_uint(data_tree, hf_s7comm_cycl_interval_time, tvb, offset, 1, interval_time);
                 offset += 1;
+                /* Store the items and the interval in the transaction, to decode the pushed data */
+                if (trans != NULL && trans->items == NULL) {
+                    trans->items = wmem_alloc_array(wmem_file_scope(), s7comm_item_info_t, item_count);
+                    trans->item_count = item_count;
+                    switch (timebase) {
+                        case S7COMM_CYCL_TIMEBASE_100MS:
+                            trans->cyclic_interval_ms = interval_time * 100;
+                            break;
+                        case S7COMM_CYCL_TIMEBASE_1S:
+                            trans->cyclic_interval_ms = interval_time * 1000;
+                            break;
+                        case S7COMM_CYCL_TIMEBASE_10S:
+                            trans->cyclic_interval_ms = interval_time * 10000;
+                            break;
+                    }
+                }
+                if (trans != NULL) {
+                    items = trans->items;
+                    if (trans->cyclic_interval_ms > 0) {
+                        item = proto_tree_add_uint(data_tree, hf_s7comm_cycl_interval, tvb, offset - 2, 2, trans->cyclic_interval_ms);
+                        proto_item_set_generated(item);
+                    }
+                }
                 /* parse item data */
                 for (i = 0; i < item_count; i++) {
                     offset_old = offset;
-                    offset = s7comm_decode_param_item(tvb, offset, data_tree, i);
+                    offset = s7comm_decode_param_item(tvb, offset, data_tree, i, (items != NULL) ? &items[i] : NULL);
                     /* if length is not a multiple of 2 and this is not the last item, then add a fill-byte */
                     len_item = offset - offset_old;
                     if ((len_item % 2) && (i < item_count)) {
@@ -3574,8 +4579,13 @@ s7comm_decode_ud_cyclic_subfunc(tvbuff_t *tvb,
                 }
 
             } else if (type == S7COMM_UD_TYPE_RES || type == S7COMM_UD_TYPE_PUSH) {   /* Response from PLC with the requested data */
+                sub = s7comm_link_cyclic_push(tvb, pinfo, data_tree, type, data_unit_ref, len, trans);
                 /* parse item data */
-                offset = s7comm_decode_response_read_data(tvb, data_tree, item_count, offset);
+                if (sub != NULL) {
+                    offset = s7comm_decode_response_read_data(tvb, data_tree, item_count, sub->items, sub->item_count, offset);
+                } else {
+                    offset = s7comm_decode_response_read_data(tvb, data_tree, item_count, NULL, 0, offset);
+                }
             }
             know_data = TRUE;
             break;
@@ -3692,7 +4702,8 @@ s7comm_decode_ud(tvbuff_t *tvb,
                        proto_tree *tree,
                        guint16 plength,
                        guint16 dlength,
-                       guint32 offset)
+                       guint32 offset,
+                       s7comm_transaction_t *trans)
 {
     proto_item *item = NULL;
     proto_tree *param_tree = NULL;
@@ -3706,6 +4717,9 @@ s7comm_decode_ud(tvbuff_t *tvb,
     guint8 type;
     guint8 funcgroup;
     guint8 subfunc;
+    const gchar *type_str;
+    const gchar *funcgroup_str;
+    const value_string *subfunc_names = NULL;
     guint8 data_unit_ref = 0;
     guint8 last_data_unit = 0;
 
@@ -3731,13 +4745,12 @@ s7comm_decode_ud(tvbuff_t *tvb,
     funcgroup = (tvb_get_guint8(tvb, offset_temp) & 0x0f);
     proto_tree_add_item(param_tree, hf_s7comm_userdata_param_type, tvb, offset_temp, 1, ENC_BIG_ENDIAN);
 
-    col_append_fstr(pinfo->cinfo, COL_INFO, " Function:[%s] -> [%s]",
-        val_to_str(type, userdata_type_names, "Unknown type: 0x%02x"),
-        val_to_str(funcgroup, userdata_functiongroup_names, "Unknown function: 0x%02x")
-        );
-
-    proto_item_append_text(param_tree, ": (%s)", val_to_str(type, userdata_type_names, "Unknown type: 0x%02x"));
-    proto_item_append_text(param_tree, " ->(%s)", val_to_str(funcgroup, userdata_functiongroup_names, "Unknown function: 0x%02x"));
+    type_str = val_to_str(type, userdata_type_names, "Unknown type: 0x%02x");
+    funcgroup_str = val_to_str(funcgroup, userdata_functiongroup_names, "Unknown function: 0x%02x");
+    col_append_fstr(pinfo->cinfo, COL_INFO, " Function:[%s] -> [%s]", type_str, funcgroup_str);
+    if (S7COMM_TREE_VISIBLE(param_tree)) {
+        proto_item_append_text(param_tree, ": (%s) ->(%s)", type_str, funcgroup_str);
+    }
 
     /* Low nibble function group  */
     proto_tree_add_item(param_tree, hf_s7comm_userdata_param_funcgroup, tvb, offset_temp, 1, ENC_BIG_ENDIAN);
@@ -3747,50 +4760,43 @@ s7comm_decode_ud(tvbuff_t *tvb,
     switch (funcgroup){
         case S7COMM_UD_FUNCGROUP_PROG:
             proto_tree_add_uint(param_tree, hf_s7comm_userdata_param_subfunc_prog, tvb, offset_temp, 1, subfunc);
-            col_append_fstr(pinfo->cinfo, COL_INFO, " -> [%s]",
-                val_to_str(subfunc, userdata_prog_subfunc_names, "Unknown subfunc: 0x%02x"));
-            proto_item_append_text(param_tree, " ->(%s)", val_to_str(subfunc, userdata_prog_subfunc_names, "Unknown subfunc: 0x%02x"));
+            subfunc_names = userdata_prog_subfunc_names;
             break;
         case S7COMM_UD_FUNCGROUP_CYCLIC:
             proto_tree_add_uint(param_tree, hf_s7comm_userdata_param_subfunc_cyclic, tvb, offset_temp, 1, subfunc);
-            col_append_fstr(pinfo->cinfo, COL_INFO, " -> [%s]",
-                val_to_str(subfunc, userdata_cyclic_subfunc_names, "Unknown subfunc: 0x%02x"));
-            proto_item_append_text(param_tree, " ->(%s)", val_to_str(subfunc, userdata_cyclic_subfunc_names, "Unknown subfunc: 0x%02x"));
+            subfunc_names = userdata_cyclic_subfunc_names;
             break;
         case S7COMM_UD_FUNCGROUP_BLOCK:
             proto_tree_add_uint(param_tree, hf_s7comm_userdata_param_subfunc_block, tvb, offset_temp, 1, subfunc);
-            col_append_fstr(pinfo->cinfo, COL_INFO, " -> [%s]",
-                val_to_str(subfunc, userdata_block_subfunc_names, "Unknown subfunc: 0x%02x"));
-            proto_item_append_text(param_tree, " ->(%s)", val_to_str(subfunc, userdata_block_subfunc_names, "Unknown subfunc: 0x%02x"));
+            subfunc_names = userdata_block_subfunc_names;
             break;
         case S7COMM_UD_FUNCGROUP_CPU:
             proto_tree_add_uint(param_tree, hf_s7comm_userdata_param_subfunc_cpu, tvb, offset_temp, 1, subfunc);
-            col_append_fstr(pinfo->cinfo, COL_INFO, " -> [%s]",
-                val_to_str(subfunc, userdata_cpu_subfunc_names, "Unknown subfunc: 0x%02x"));
-            proto_item_append_text(param_tree, " ->(%s)", val_to_str(subfunc, userdata_cpu_subfunc_names, "Unknown subfunc: 0x%02x"));
+            subfunc_names = userdata_cpu_subfunc_names;
             break;
         case S7COMM_UD_FUNCGROUP_SEC:
             proto_tree_add_uint(param_tree, hf_s7comm_userdata_param_subfunc_sec, tvb, offset_temp, 1, subfunc);
-            col_append_fstr(pinfo->cinfo, COL_INFO, " -> [%s]",
-                val_to_str(subfunc, userdata_sec_subfunc_names, "Unknown subfunc: 0x%02x"));
-            proto_item_append_text(param_tree, " ->(%s)", val_to_str(subfunc, userdata_sec_subfunc_names, "Unknown subfunc: 0x%02x"));
+            subfunc_names = userdata_sec_subfunc_names;
             break;
         case S7COMM_UD_FUNCGROUP_TIME:
             proto_tree_add_uint(param_tree, hf_s7comm_userdata_param_subfunc_time, tvb, offset_temp, 1, subfunc);
-            col_append_fstr(pinfo->cinfo, COL_INFO, " -> [%s]",
-                val_to_str(subfunc, userdata_time_subfunc_names, "Unknown subfunc: 0x%02x"));
-            proto_item_append_text(param_tree, " ->(%s)", val_to_str(subfunc, userdata_time_subfunc_names, "Unknown subfunc: 0x%02x"));
+            subfunc_names = userdata_time_subfunc_names;
             break;
         case S7COMM_UD_FUNCGROUP_MODETRANS:
             proto_tree_add_uint(param_tree, hf_s7comm_modetrans_param_subfunc, tvb, offset_temp, 1, subfunc);
-            col_append_fstr(pinfo->cinfo, COL_INFO, " -> [%s]",
-                val_to_str(subfunc, modetrans_param_subfunc_names, "Unknown subfunc: 0x%02x"));
-            proto_item_append_text(param_tree, " ->(%s)", val_to_str(subfunc, modetrans_param_subfunc_names, "Unknown subfunc: 0x%02x"));
+            subfunc_names = modetrans_param_subfunc_names;
             break;
         default:
             proto_tree_add_uint(param_tree, hf_s7comm_userdata_param_subfunc, tvb, offset_temp, 1, subfunc);
             break;
     }
+    if (subfunc_names != NULL) {
+        const gchar *subfunc_str = val_to_str(subfunc, subfunc_names, "Unknown subfunc: 0x%02x");
+        col_append_fstr(pinfo->cinfo, COL_INFO, " -> [%s]", subfunc_str);
+        if (S7COMM_TREE_VISIBLE(param_tree)) {
+            proto_item_append_text(param_tree, " ->(%s)", subfunc_str);
+        }
+    }
     offset_temp += 1;
     /* 1 Byte sequence number  */
     proto_tree_add_item(param_tree, hf_s7comm_userdata_param_seq_num, tvb, offset_temp, 1, ENC_BIG_ENDIAN);
@@ -3839,7 +4845,7 @@ s7comm_decode_ud(tvbuff_t *tvb,
                     offset = s7comm_decode_ud_prog_subfunc(tvb, data_tree, type, subfunc, dlength, offset);
                     break;
                 case S7COMM_UD_FUNCGROUP_CYCLIC:
-                    offset = s7comm_decode_ud_cyclic_subfunc(tvb, data_tree, type, subfunc, dlength, offset);
+                    offset = s7comm_decode_ud_cyclic_subfunc(tvb, pinfo, data_tree, type, subfunc, data_unit_ref, len, dlength, offset, trans);
                     break;
                 case S7COMM_UD_FUNCGROUP_BLOCK:
                     offset = s7comm_decode_ud_block_subfunc(tvb, pinfo, data_tree, type, subfunc, ret_val, tsize, len, dlength, offset);
@@ -3896,16 +4902,19 @@ s7comm_decode_req_resp(tvbuff_t *tvb,
                       guint16 plength,
                       guint16 dlength,
                       guint32 offset,
-                      guint8 rosctr)
+                      guint8 rosctr,
+                      s7comm_transaction_t *trans)
 {
     proto_item *item = NULL;
     proto_tree *param_tree = NULL;
     proto_tree *data_tree = NULL;
     guint8 function = 0;
+    const gchar *function_str;
     guint8 item_count = 0;
     guint8 i;
     guint32 offset_old;
     guint32 len;
+    s7comm_item_info_t *items = NULL;
 
     if (plength > 0) {
         /* Add parameter tree */
@@ -3913,11 +4922,14 @@ s7comm_decode_req_resp(tvbuff_t *tvb,
         param_tree = proto_item_add_subtree(item, ett_s7comm_param);
         /* Analyze function */
         function = tvb_get_guint8(tvb, offset);
+        function_str = val_to_str(function, param_functionnames, "Unknown function: 0x%02x");
         /* add param.function to info column */
-        col_append_fstr(pinfo->cinfo, COL_INFO, " Function:[%s]", val_to_str(function, param_functionnames, "Unknown function: 0x%02x"));
+        col_append_fstr(pinfo->cinfo, COL_INFO, " Function:[%s]", function_str);
         proto_tree_add_uint(param_tree, hf_s7comm_param_service, tvb, offset, 1, function);
         /* show param.function code at the tree */
-        proto_item_append_text(param_tree, ": (%s)", val_to_str(function, param_functionnames, "Unknown function: 0x%02x"));
+        if (S7COMM_TREE_VISIBLE(param_tree)) {
+            proto_item_append_text(param_tree, ": (%s)", function_str);
+        }
         offset += 1;
 
         if (rosctr == S7COMM_ROSCTR_JOB) {
@@ -3927,26 +4939,41 @@ s7comm_decode_req_resp(tvbuff_t *tvb,
                     item_count = tvb_get_guint8(tvb, offset);
                     proto_tree_add_uint(param_tree, hf_s7comm_param_itemcount, tvb, offset, 1, item_count);
                     offset += 1;
+                    /* Store the items in the transaction, to decode the data of the response.
+                     * The data of a write request uses the items of the same PDU.
+                     */
+                    if (trans != NULL && trans->items == NULL) {
+                        trans->items = wmem_alloc_array(wmem_file_scope(), s7comm_item_info_t, item_count);
+                        trans->item_count = item_count;
+                    }
+                    if (trans != NULL) {
+                        items = trans->items;
+                    } else {
+                        items = wmem_alloc_array(wmem_packet_scope(), s7comm_item_info_t, item_count);
+                    }
                     /* parse item data */
                     for (i = 0; i < item_count; i++) {
                         offset_old = offset;
-                        offset = s7comm_decode_param_item(tvb, offset, param_tree, i);
+                        offset = s7comm_decode_param_item(tvb, offset, param_tree, i, &items[i]);
                         /* if length is not a multiple of 2 and this is not the last item, then add a fill-byte */
                         len = offset - offset_old;
                         if ((len % 2) && (i < item_count)) {
                             offset += 1;
                         }
                     }
+                    if (function == S7COMM_SERV_READVAR) {
+                        s7comm_analyze_read_request(tvb, pinfo, param_tree, plength, item_count, items, trans);
+                    }
                     /* in write-function there is a data part */
                     if ((function == S7COMM_SERV_WRITEVAR) && (dlength > 0)) {
                         item = proto_tree_add_item(tree, hf_s7comm_data, tvb, offset, dlength, ENC_NA);
                         data_tree = proto_item_add_subtree(item, ett_s7comm_data);
                         /* Add returned data to data-tree */
-                        offset = s7comm_decode_response_read_data(tvb, data_tree, item_count, offset);
+                        offset = s7comm_decode_response_read_data(tvb, data_tree, item_count, items, item_count, offset);
                     }
                     break;
                 case S7COMM_SERV_SETUPCOMM:
-                    offset = s7comm_decode_pdu_setup_communication(tvb, param_tree, offset);
+                    offset = s7comm_decode_pdu_setup_communication(tvb, pinfo, param_tree, offset);
                     break;
                 /* Special functions */
                 case S7COMM_FUNCREQUESTDOWNLOAD:
@@ -3955,7 +4982,7 @@ s7comm_decode_req_resp(tvbuff_t *tvb,
                 case S7COMM_FUNCSTARTUPLOAD:
                 case S7COMM_FUNCUPLOAD:
                 case S7COMM_FUNCENDUPLOAD:
-                    offset = s7comm_decode_plc_controls_param_hex1x(tvb, pinfo, param_tree, plength, offset -1);
+                    offset = s7comm_decode_plc_controls_param_hex1x(tvb, pinfo, param_tree, plength, offset -1, trans);
                     break;
                 case S7COMM_FUNC_PLC_CONTROL:
                     offset = s7comm_decode_plc_controls_param_hex28(tvb, pinfo, param_tree, offset -1);
@@ -3995,13 +5022,21 @@ s7comm_decode_req_resp(tvbuff_t *tvb,
                     data_tree = proto_item_add_subtree(item, ett_s7comm_data);
                     /* Add returned data to data-tree */
                     if ((function == S7COMM_SERV_READVAR) && (dlength > 0)) {
-                        offset = s7comm_decode_response_read_data(tvb, data_tree, item_count, offset);
+                        if (trans != NULL && trans->function == S7COMM_SERV_READVAR) {
+                            offset = s7comm_decode_response_read_data(tvb, data_tree, item_count, trans->items, trans->item_count, offset);
+                        } else {
+                            offset = s7comm_decode_response_read_data(tvb, data_tree, item_count, NULL, 0, offset);
+                        }
                     } else if ((function == S7COMM_SERV_WRITEVAR) && (dlength > 0)) {
                         offset = s7comm_decode_response_write_data(tvb, data_tree, item_count, offset);
                     }
                     break;
                 case S7COMM_SERV_SETUPCOMM:
-                    offset = s7comm_decode_pdu_setup_communication(tvb, param_tree, offset);
+                    offset = s7comm_decode_pdu_setup_communication(tvb, pinfo, param_tree, offset);
+                    break;
+                case S7COMM_FUNCSTARTUPLOAD:
+                case S7COMM_FUNCUPLOAD:
+                    offset = s7comm_decode_plc_controls_upload_response(tvb, pinfo, tree, param_tree, plength, dlength, offset - 1, trans);
                     break;
                 default:
                     /* Print unknown part as raw bytes */
@@ -4026,6 +5061,82 @@ s7comm_decode_req_resp(tvbuff_t *tvb,
     return offset;
 }
 
+/*******************************************************************************************************
+ *
+ * Match a Job to its Ack/Ack_Data (or a Userdata request to its response) by the PDU reference
+ * and add the generated fields
+ *
+ *******************************************************************************************************/
+static s7comm_transaction_t *
+s7comm_match_transaction(tvbuff_t *tvb,
+                         packet_info *pinfo,
+                         proto_tree *tree,
+                         guint8 rosctr,
+                         gboolean is_request,
+                         guint16 pduref,
+                         guint8 function,
+                         guint8 subfunc)
+{
+    s7comm_conv_info_t *conv_info;
+    s7comm_transaction_t *trans = NULL;
+    proto_item *item = NULL;
+    nstime_t ns;
+
+    if (!PINFO_FD_VISITED(pinfo)) {
+        conv_info = s7comm_get_conv_info(pinfo);
+        if (is_request) {
+            trans = wmem_new(wmem_file_scope(), s7comm_transaction_t);
+            trans->req_frame = pinfo->fd->num;
+            trans->rep_frame = 0;
+            trans->req_time = pinfo->fd->abs_ts;
+            trans->rosctr = rosctr;
+            trans->function = function;
+            trans->subfunc = subfunc;
+            trans->item_count = 0;
+            trans->items = NULL;
+            trans->upload_id = 0;
+            trans->block_name = NULL;
+            trans->pdu_length = conv_info->pdu_length;
+            trans->overlap_frame = 0;
+            trans->cyclic_interval_ms = 0;
+            wmem_tree_insert32(conv_info->transactions, pduref, (void *)trans);
+        } else {
+            trans = (s7comm_transaction_t *)wmem_tree_lookup32(conv_info->transactions, pduref);
+            /* Only the first response to a request is linked, a repeated one is not.
+             * Ack/Ack_Data belongs to a Job, a Userdata response to a Userdata request.
+             */
+            if (trans != NULL && trans->rep_frame == 0 &&
+                ((rosctr == S7COMM_ROSCTR_USERDATA) == (trans->rosctr == S7COMM_ROSCTR_USERDATA))) {
+                trans->rep_frame = pinfo->fd->num;
+            } else {
+                trans = NULL;
+            }
+        }
+        if (trans != NULL) {
+            p_add_proto_data(wmem_file_scope(), pinfo, proto_s7comm, S7COMM_PROTO_DATA_TRANS(pinfo->curr_layer_num), trans);
+        }
+    } else {
+        trans = (s7comm_transaction_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_s7comm, S7COMM_PROTO_DATA_TRANS(pinfo->curr_layer_num));
+    }
+
+    if (trans == NULL) {
+        return NULL;
+    }
+    if (is_request) {
+        if (trans->rep_frame) {
+            item = proto_tree_add_uint(tree, hf_s7comm_response_in, tvb, 0, 0, trans->rep_frame);
+            proto_item_set_generated(item);
+        }
+    } else {
+        item = proto_tree_add_uint(tree, hf_s7comm_response_to, tvb, 0, 0, trans->req_frame);
+        proto_item_set_generated(item);
+        nstime_delta(&ns, &pinfo->fd->abs_ts, &trans->req_time);
+        item = proto_tree_add_time(tree, hf_s7comm_response_time, tvb, 0, 0, &ns);
+        proto_item_set_generated(item);
+    }
+    return trans;
+}
+
 /*******************************************************************************************************
  *******************************************************************************************************
  *
@@ -4033,7 +5144,7 @@ s7comm_decode_req_resp(tvbuff_t *tvb,
  *
  *******************************************************************************************************
  *******************************************************************************************************/
-static gboolean
+static bool
 dissect_s7comm(tvbuff_t *tvb,
                 packet_info *pinfo,
                 proto_tree *tree,
@@ -4050,6 +5161,13 @@ dissect_s7comm(tvbuff_t *tvb,
     guint8 hlength = 10;                /* Header 10 Bytes, when type 2 or 3 (Response) -> 12 Bytes */
     guint16 plength = 0;
     guint16 dlength = 0;
+    guint16 pduref = 0;
+    guint8 function = 0;
+    guint8 subfunc = 0;
+    guint8 ud_type = 0;
+    s7comm_transaction_t *trans = NULL;
+    s7comm_tap_info_t *tap_info;
+    s7comm_cyclic_push_t *push;
 
     /*----------------- Heuristic Checks - Begin */
     /* 1) check for minimum length */
@@ -4063,6 +5181,10 @@ dissect_s7comm(tvbuff_t *tvb,
         return FALSE;
     /*----------------- Heuristic Checks - End */
 
+    if (!PINFO_FD_VISITED(pinfo)) {
+        s7comm_bind_conversation(pinfo);
+    }
+
     col_set_str(pinfo->cinfo, COL_PROTOCOL, PROTO_TAG_S7COMM);
     col_clear(pinfo->cinfo, COL_INFO);
 
@@ -4089,13 +5211,16 @@ dissect_s7comm(tvbuff_t *tvb,
     /* ROSCTR (Remote Operating Service Control) - PDU Type */
     proto_tree_add_uint(s7comm_header_tree, hf_s7comm_header_rosctr, tvb, offset, 1, rosctr);
     /* Show pdu type beside the header tree */
-    proto_item_append_text(s7comm_header_tree, ": (%s)", val_to_str(rosctr, rosctr_names, "Unknown ROSCTR: 0x%02x"));
+    if (S7COMM_TREE_VISIBLE(s7comm_header_tree)) {
+        proto_item_append_text(s7comm_header_tree, ": (%s)", val_to_str(rosctr, rosctr_names, "Unknown ROSCTR: 0x%02x"));
+    }
     offset += 1;
     /* Redundancy ID, reserved */
     proto_tree_add_item(s7comm_header_tree, hf_s7comm_header_redid, tvb, offset, 2, ENC_BIG_ENDIAN);
     offset += 2;
     /* Protocol Data Unit Reference */
-    proto_tree_add_item(s7comm_header_tree, hf_s7comm_header_pduref, tvb, offset, 2, ENC_BIG_ENDIAN);
+    pduref = tvb_get_ntohs(tvb, offset);
+    proto_tree_add_uint(s7comm_header_tree, hf_s7comm_header_pduref, tvb, offset, 2, pduref);
     offset += 2;
     /* Parameter length */
     plength = tvb_get_ntohs(tvb, offset);
@@ -4113,20 +5238,380 @@ dissect_s7comm(tvbuff_t *tvb,
         offset += 1;
     }
 
+    switch (rosctr) {
+        case S7COMM_ROSCTR_JOB:
+        case S7COMM_ROSCTR_ACK:
+        case S7COMM_ROSCTR_ACK_DATA:
+            if (plength > 0) {
+                function = tvb_get_guint8(tvb, offset);
+            }
+            trans = s7comm_match_transaction(tvb, pinfo, s7comm_tree, rosctr, (rosctr == S7COMM_ROSCTR_JOB), pduref, function, 0);
+            break;
+        case S7COMM_ROSCTR_USERDATA:
+            /* Type and function group are at byte 5 of the parameter part, the subfunction at byte 6.
+             * Push telegrams from the PLC have no request.
+             */
+            if (plength >= 8) {
+                ud_type = (tvb_get_guint8(tvb, offset + 5) & 0xf0) >> 4;
+                function = tvb_get_guint8(tvb, offset + 5) & 0x0f;
+                subfunc = tvb_get_guint8(tvb, offset + 6);
+                if (ud_type == S7COMM_UD_TYPE_REQ || ud_type == S7COMM_UD_TYPE_RES) {
+                    trans = s7comm_match_transaction(tvb, pinfo, s7comm_tree, rosctr, (ud_type == S7COMM_UD_TYPE_REQ), pduref, function, subfunc);
+                }
+            }
+            break;
+    }
+
     switch (rosctr) {
         case S7COMM_ROSCTR_JOB:
         case S7COMM_ROSCTR_ACK_DATA:
-            s7comm_decode_req_resp(tvb, pinfo, s7comm_tree, plength, dlength, offset, rosctr);
+            s7comm_decode_req_resp(tvb, pinfo, s7comm_tree, plength, dlength, offset, rosctr, trans);
             break;
         case S7COMM_ROSCTR_USERDATA:
-            s7comm_decode_ud(tvb, pinfo, s7comm_tree, plength, dlength, offset);
+            s7comm_decode_ud(tvb, pinfo, s7comm_tree, plength, dlength, offset, trans);
             break;
     }
     /*else {  Unknown pdu, maybe passed to another dissector? }
     */
+
+    /* Tap info, a response carries the values of its request */
+    tap_info = wmem_new0(wmem_packet_scope(), s7comm_tap_info_t);
+    tap_info->rosctr = rosctr;
+    tap_info->pduref = pduref;
+    if (trans != NULL) {
+        tap_info->req_rosctr = trans->rosctr;
+        tap_info->function = trans->function;
+        tap_info->subfunc = trans->subfunc;
+        tap_info->item_count = trans->item_count;
+        tap_info->items = trans->items;
+        tap_info->is_response = (trans->req_frame != pinfo->fd->num);
+        if (tap_info->is_response) {
+            tap_info->req_frame = trans->req_frame;
+            nstime_delta(&tap_info->resp_time, &pinfo->fd->abs_ts, &trans->req_time);
+        }
+    } else {
+        tap_info->req_rosctr = rosctr;
+        tap_info->function = function;
+        tap_info->subfunc = subfunc;
+    }
+    push = (s7comm_cyclic_push_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_s7comm, S7COMM_PROTO_DATA_CYCLIC(pinfo->curr_layer_num));
+    if (push != NULL && push->push_no > 0) {
+        tap_info->cyclic_push_no = push->push_no;
+        tap_info->cyclic_req_frame = push->sub->req_frame;
+        tap_info->cyclic_job_id = push->sub->job_id;
+        tap_info->cyclic_interval_ms = push->sub->interval_ms;
+        tap_info->cyclic_delta = push->delta;
+        tap_info->cyclic_bytes = push->bytes;
+    }
+    tap_queue_packet(s7comm_tap, pinfo, tap_info);
+
     return TRUE;
 }
 
+/*******************************************************************************************************
+ *
+ * Statistics: Service response time, "-z srt,s7comm"
+ * One table for the functions of Job requests, one for the function groups of Userdata requests.
+ * A row per function, unknown function codes are shown with their value.
+ *
+ *******************************************************************************************************/
+#define S7COMM_SRT_TABLE_JOB                0
+#define S7COMM_SRT_TABLE_USERDATA           1
+#define S7COMM_SRT_JOB_FUNCTIONS            256
+#define S7COMM_SRT_USERDATA_FUNCGROUPS      16
+
+static void
+s7comm_srt_init_rows(srt_stat_table *srt_table,
+                     int num_rows,
+                     const value_string *names)
+{
+    const gchar *str;
+    gchar name[16];
+    int i;
+
+    for (i = 0; i < num_rows; i++) {
+        str = try_val_to_str(i, names);
+        if (str == NULL) {
+            snprintf(name, sizeof(name), "0x%02x", i);
+            str = name;
+        }
+        init_srt_table_row(srt_table, i, str);
+    }
+}
+
+static void
+s7comm_srt_init(struct register_srt *srt _U_, GArray *srt_array)
+{
+    srt_stat_table *srt_table;
+
+    srt_table = init_srt_table("S7COMM Job functions", NULL, srt_array, S7COMM_SRT_JOB_FUNCTIONS,
+        "Function", "s7comm.param.func", NULL);
+    s7comm_srt_init_rows(srt_table, S7COMM_SRT_JOB_FUNCTIONS, param_functionnames);
+
+    srt_table = init_srt_table("S7COMM Userdata function groups", NULL, srt_array, S7COMM_SRT_USERDATA_FUNCGROUPS,
+        "Function group", "s7comm.param.userdata.funcgroup", NULL);
+    s7comm_srt_init_rows(srt_table, S7COMM_SRT_USERDATA_FUNCGROUPS, userdata_functiongroup_names);
+}
+
+static tap_packet_status
+s7comm_srt_packet(void *pss,
+                  packet_info *pinfo,
+                  epan_dissect_t *edt _U_,
+                  const void *prv,
+                  tap_flags_t flags _U_)
+{
+    srt_data_t *data = (srt_data_t *)pss;
+    const s7comm_tap_info_t *tap_info = (const s7comm_tap_info_t *)prv;
+    srt_stat_table *srt_table;
+    nstime_t req_time;
+    int row;
+
+    if (!tap_info->is_response) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    if (tap_info->req_rosctr == S7COMM_ROSCTR_USERDATA) {
+        srt_table = g_array_index(data->srt_array, srt_stat_table *, S7COMM_SRT_TABLE_USERDATA);
+        row = tap_info->function & 0x0f;
+    } else {
+        srt_table = g_array_index(data->srt_array, srt_stat_table *, S7COMM_SRT_TABLE_JOB);
+        row = tap_info->function;
+    }
+    /* The table calculates the response time from the time of the request */
+    nstime_delta(&req_time, &pinfo->fd->abs_ts, &tap_info->resp_time);
+    add_srt_table_data(srt_table, row, &req_time, pinfo);
+    return TAP_PACKET_REDRAW;
+}
+
+/*******************************************************************************************************
+ *
+ * Statistics: Service response time histogram, "-z s7comm,srt_hist"
+ * The SRT table gives min, max and average per function. This tree gives the distribution of all
+ * response times in milliseconds, from which the percentiles can be read, and the average in
+ * microseconds per ROSCTR and function (Job) or function group (Userdata).
+ *
+ *******************************************************************************************************/
+static const gchar *st_str_s7comm_srt = "Service Response Time [us]";
+static const gchar *st_str_s7comm_srt_hist = "Response Time Histogram [ms]";
+static int st_node_s7comm_srt = -1;
+static int st_node_s7comm_srt_hist = -1;
+
+static void
+s7comm_srt_stats_tree_init(stats_tree *st)
+{
+    st_node_s7comm_srt = stats_tree_create_node(st, st_str_s7comm_srt, 0, STAT_DT_INT, TRUE);
+    st_node_s7comm_srt_hist = stats_tree_create_range_node(st, st_str_s7comm_srt_hist, 0,
+        "0-1", "2-5", "6-10", "11-20", "21-50", "51-100", "101-200", "201-500", "501-1000", "1001-", NULL);
+}
+
+static tap_packet_status
+s7comm_srt_stats_tree_packet(stats_tree *st,
+                             packet_info *pinfo _U_,
+                             epan_dissect_t *edt _U_,
+                             const void *p,
+                             tap_flags_t flags _U_)
+{
+    const s7comm_tap_info_t *tap_info = (const s7comm_tap_info_t *)p;
+    int rosctr_node;
+    gint64 usec64;
+    int usec;
+    int msec;
+    const gchar *name;
+
+    /* A negative time comes from timestamps out of order */
+    if (!tap_info->is_response || tap_info->resp_time.secs < 0 || tap_info->resp_time.nsecs < 0) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    usec64 = (gint64)tap_info->resp_time.secs * 1000000 + tap_info->resp_time.nsecs / 1000;
+    usec = (usec64 > G_MAXINT) ? G_MAXINT : (int)usec64;
+    msec = (usec64 / 1000 > G_MAXINT) ? G_MAXINT : (int)(usec64 / 1000);
+
+    avg_stat_node_add_value_int(st, st_str_s7comm_srt, 0, TRUE, usec);
+    rosctr_node = avg_stat_node_add_value_int(st, val_to_str(tap_info->req_rosctr, rosctr_names, "Unknown ROSCTR: 0x%02x"),
+        st_node_s7comm_srt, TRUE, usec);
+    if (tap_info->req_rosctr == S7COMM_ROSCTR_USERDATA) {
+        name = val_to_str(tap_info->function, userdata_functiongroup_names, "Unknown function group: 0x%02x");
+    } else {
+        name = val_to_str(tap_info->function, param_functionnames, "Unknown function: 0x%02x");
+    }
+    avg_stat_node_add_value_int(st, name, rosctr_node, FALSE, usec);
+
+    stats_tree_tick_range(st, st_str_s7comm_srt_hist, 0, msec);
+    return TAP_PACKET_REDRAW;
+}
+
+/*******************************************************************************************************
+ *
+ * Statistics: Accessed addresses, "-z s7comm,addresses"
+ * Read/Write Var requests per PLC, client, area and address range, with the number of bytes requested.
+ * The rate column of the statistic gives the requests per time.
+ *
+ *******************************************************************************************************/
+static const gchar *st_str_s7comm_addr = "Read/Write Var Requests by PLC";
+static int st_node_s7comm_addr = -1;
+
+static void
+s7comm_addr_stats_tree_init(stats_tree *st)
+{
+    st_node_s7comm_addr = stats_tree_create_node(st, st_str_s7comm_addr, 0, STAT_DT_INT, TRUE);
+}
+
+static tap_packet_status
+s7comm_addr_stats_tree_packet(stats_tree *st,
+                              packet_info *pinfo,
+                              epan_dissect_t *edt _U_,
+                              const void *p,
+                              tap_flags_t flags _U_)
+{
+    const s7comm_tap_info_t *tap_info = (const s7comm_tap_info_t *)p;
+    const s7comm_item_info_t *item_info;
+    gboolean is_write;
+    const gchar *plc_str;
+    const gchar *client_str;
+    const gchar *area_str;
+    const gchar *range_str;
+    int plc_node;
+    int client_node;
+    int area_node;
+    int access_node;
+    guint32 bytes;
+    guint8 i;
+
+    if (tap_info->rosctr != S7COMM_ROSCTR_JOB || tap_info->items == NULL ||
+        (tap_info->function != S7COMM_SERV_READVAR && tap_info->function != S7COMM_SERV_WRITEVAR)) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    is_write = (tap_info->function == S7COMM_SERV_WRITEVAR);
+    plc_str = address_to_str(wmem_packet_scope(), &pinfo->dst);
+    client_str = address_to_str(wmem_packet_scope(), &pinfo->src);
+    tick_stat_node(st, st_str_s7comm_addr, 0, TRUE);
+    plc_node = tick_stat_node(st, plc_str, st_node_s7comm_addr, TRUE);
+    client_node = tick_stat_node(st, client_str, plc_node, TRUE);
+
+    for (i = 0; i < tap_info->item_count; i++) {
+        item_info = &tap_info->items[i];
+        if (item_info->syntax_id != S7COMM_SYNTAXID_S7ANY) {
+            continue;
+        }
+        area_str = s7comm_get_area_str(item_info->area, item_info->db);
+        bytes = item_info->len * s7comm_get_transport_size_bytes(item_info->t_size);
+        if (item_info->area == S7COMM_AREA_TIMER || item_info->area == S7COMM_AREA_COUNTER) {
+            /* Timers and counters are addressed by number */
+            range_str = wmem_strdup_printf(wmem_packet_scope(), "Number %u-%u",
+                item_info->bytepos * 8 + item_info->bitpos, item_info->bytepos * 8 + item_info->bitpos + item_info->len - 1);
+        } else if (item_info->t_size == S7COMM_TRANSPORT_SIZE_BIT) {
+            range_str = wmem_strdup_printf(wmem_packet_scope(), "Bit %u.%u", item_info->bytepos, item_info->bitpos);
+        } else {
+            range_str = wmem_strdup_printf(wmem_packet_scope(), "Byte %u-%u",
+                item_info->bytepos, item_info->bytepos + (bytes > 0 ? bytes - 1 : 0));
+        }
+        area_node = tick_stat_node(st, area_str, client_node, TRUE);
+        access_node = tick_stat_node(st, is_write ? "Write" : "Read", area_node, TRUE);
+        tick_stat_node(st, range_str, access_node, FALSE);
+        increase_stat_node(st, is_write ? "Bytes written" : "Bytes read", area_node, FALSE, bytes);
+    }
+    return TAP_PACKET_REDRAW;
+}
+
+/*******************************************************************************************************
+ *
+ * Statistics: Cyclic data, "-z s7comm,cyclic"
+ * Per subscription the time between the pushes, the deviation from the requested interval (jitter),
+ * the lateness and the number of data bytes. The rate column of the bytes gives the throughput.
+ *
+ *******************************************************************************************************/
+static const gchar *st_str_s7comm_cyclic = "Cyclic Data Pushes, Time Between Pushes [us]";
+static int st_node_s7comm_cyclic = -1;
+
+static void
+s7comm_cyclic_stats_tree_init(stats_tree *st)
+{
+    st_node_s7comm_cyclic = stats_tree_create_node(st, st_str_s7comm_cyclic, 0, STAT_DT_INT, TRUE);
+}
+
+static tap_packet_status
+s7comm_cyclic_stats_tree_packet(stats_tree *st,
+                                packet_info *pinfo,
+                                epan_dissect_t *edt _U_,
+                                const void *p,
+                                tap_flags_t flags _U_)
+{
+    const s7comm_tap_info_t *tap_info = (const s7comm_tap_info_t *)p;
+    const gchar *plc_str;
+    const gchar *name;
+    int sub_node;
+    gint64 delta_us;
+    gint64 interval_us;
+
+    if (tap_info->cyclic_push_no == 0) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    delta_us = (gint64)tap_info->cyclic_delta.secs * 1000000 + tap_info->cyclic_delta.nsecs / 1000;
+    if (delta_us < 0) {
+        delta_us = 0;
+    } else if (delta_us > G_MAXINT) {
+        delta_us = G_MAXINT;
+    }
+    plc_str = address_to_str(wmem_packet_scope(), &pinfo->src);
+    name = wmem_strdup_printf(wmem_packet_scope(), "%s Job %u, request in frame %u, interval %u ms",
+        plc_str, tap_info->cyclic_job_id, tap_info->cyclic_req_frame, tap_info->cyclic_interval_ms);
+
+    avg_stat_node_add_value_int(st, st_str_s7comm_cyclic, 0, TRUE, (int)delta_us);
+    sub_node = avg_stat_node_add_value_int(st, name, st_node_s7comm_cyclic, TRUE, (int)delta_us);
+    if (tap_info->cyclic_interval_ms > 0) {
+        interval_us = MIN((gint64)tap_info->cyclic_interval_ms * 1000, G_MAXINT);
+        avg_stat_node_add_value_int(st, "Jitter [us]", sub_node, FALSE,
+            (int)((delta_us > interval_us) ? (delta_us - interval_us) : (interval_us - delta_us)));
+        avg_stat_node_add_value_int(st, "Lateness [us]", sub_node, FALSE,
+            (int)((delta_us > interval_us) ? (delta_us - interval_us) : 0));
+    }
+    increase_stat_node(st, "Data bytes", sub_node, FALSE, tap_info->cyclic_bytes);
+    return TAP_PACKET_REDRAW;
+}
+
+/*******************************************************************************************************
+ *
+ * Export objects: Blocks from a complete upload, File -> Export Objects -> S7COMM
+ *
+ *******************************************************************************************************/
+static tap_packet_status
+s7comm_eo_packet(void *tapdata,
+                 packet_info *pinfo,
+                 epan_dissect_t *edt _U_,
+                 const void *data,
+                 tap_flags_t flags _U_)
+{
+    export_object_list_t *object_list = (export_object_list_t *)tapdata;
+    const s7comm_eo_t *eo_info = (const s7comm_eo_t *)data;
+    export_object_entry_t *entry;
+
+    if (eo_info == NULL) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    entry = g_new0(export_object_entry_t, 1);
+    entry->pkt_num = pinfo->num;
+    entry->hostname = g_strdup(address_to_str(wmem_packet_scope(), &pinfo->src));
+    entry->content_type = g_strdup("application/octet-stream");
+    entry->filename = g_strdup(eo_info->filename);
+    entry->payload_len = eo_info->payload_len;
+    /* The entry is freed by the export object list with g_free, and may outlive
+     * the reassembly table (which is cleared on a new file), so it needs its own copy. */
+    entry->payload_data = (guint8 *)g_memdup2(eo_info->payload_data, eo_info->payload_len);
+    object_list->add_entry(object_list->gui_data, entry);
+    return TAP_PACKET_REDRAW;
+}
+
+/*******************************************************************************************************
+ *
+ * Initialize the reassembly table, called on every new capture file
+ *
+ *******************************************************************************************************/
+static void
+s7comm_defragment_init(void)
+{
+    reassembly_table_init(&s7comm_upload_reassembly_table,
+                          &addresses_ports_reassembly_table_functions);
+}
+
 /*******************************************************************************************************
  *******************************************************************************************************/
 void
@@ -4151,6 +5636,15 @@ proto_register_s7comm (void)
         { &hf_s7comm_header_pduref,
         { "Protocol Data Unit Reference", "s7comm.header.pduref", FT_UINT16, BASE_DEC, NULL, 0x0,
           NULL, HFILL }},
+        { &hf_s7comm_response_in,
+        { "Response In", "s7comm.response_in", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "The response to this request is in this frame", HFILL }},
+        { &hf_s7comm_response_to,
+        { "Request In", "s7comm.response_to", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "This is a response to the request in this frame", HFILL }},
+        { &hf_s7comm_response_time,
+        { "Time", "s7comm.time", FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+          "The time between the request and the response", HFILL }},
         { &hf_s7comm_header_parlg,
         { "Parameter length", "s7comm.header.parlg", FT_UINT16, BASE_DEC, NULL, 0x0,
           "Specifies the entire length of the parameter block in bytes", HFILL }},
@@ -4289,6 +5783,56 @@ proto_register_s7comm (void)
         { &hf_s7comm_data_fillbyte,
         { "Fill byte", "s7comm.data.fillbyte", FT_UINT8, BASE_HEX, NULL, 0x0,
           NULL, HFILL }},
+        { &hf_s7comm_data_value_word,
+        { "WORD", "s7comm.data.value.word", FT_UINT16, BASE_HEX, NULL, 0x0,
+          "Value of type WORD, transport size taken from the request item", HFILL }},
+        { &hf_s7comm_data_value_int,
+        { "INT", "s7comm.data.value.int", FT_INT16, BASE_DEC, NULL, 0x0,
+          "Value of type INT, transport size taken from the request item", HFILL }},
+        { &hf_s7comm_data_value_dword,
+        { "DWORD", "s7comm.data.value.dword", FT_UINT32, BASE_HEX, NULL, 0x0,
+          "Value of type DWORD, transport size taken from the request item", HFILL }},
+        { &hf_s7comm_data_value_dint,
+        { "DINT", "s7comm.data.value.dint", FT_INT32, BASE_DEC, NULL, 0x0,
+          "Value of type DINT, transport size taken from the request item", HFILL }},
+        { &hf_s7comm_data_value_real,
+        { "REAL", "s7comm.data.value.real", FT_FLOAT, BASE_NONE, NULL, 0x0,
+          "Value of type REAL, transport size taken from the request item", HFILL }},
+        { &hf_s7comm_data_value_byte,
+        { "BYTE", "s7comm.data.value.byte", FT_BYTES, BASE_NONE, NULL, 0x0,
+          "Values of type BYTE, transport size taken from the request item", HFILL }},
+        { &hf_s7comm_data_value_char,
+        { "CHAR", "s7comm.data.value.char", FT_STRING, BASE_NONE, NULL, 0x0,
+          "Values of type CHAR, transport size taken from the request item", HFILL }},
+        { &hf_s7comm_data_value_not_shown,
+        { "Values not shown", "s7comm.data.value.not_shown", FT_UINT16, BASE_DEC, NULL, 0x0,
+          "Number of typed values after the display limit, which are only contained in the data bytes", HFILL }},
+
+        /* Packing analysis of Read Var requests */
+        { &hf_s7comm_analysis,
+        { "Packing analysis", "s7comm.analysis", FT_NONE, BASE_NONE, NULL, 0x0,
+          "How well the items of this Read Var request are packed", HFILL }},
+        { &hf_s7comm_analysis_pdu_length,
+        { "Negotiated PDU length", "s7comm.analysis.pdu_length", FT_UINT16, BASE_DEC, NULL, 0x0,
+          "PDU length of the setup communication of this connection", HFILL }},
+        { &hf_s7comm_analysis_resp_size,
+        { "Expected response size", "s7comm.analysis.resp_size", FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Size of the Ack_Data PDU with the data of all items", HFILL }},
+        { &hf_s7comm_analysis_pdu_fill,
+        { "PDU fill level [%]", "s7comm.analysis.pdu_fill", FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Size of the larger of request and response, in percent of the negotiated PDU length", HFILL }},
+        { &hf_s7comm_analysis_coalesced_count,
+        { "Coalesced item count", "s7comm.analysis.coalesced_count", FT_UINT8, BASE_DEC, NULL, 0x0,
+          "Number of items needed when overlapping and adjacent items are merged", HFILL }},
+        { &hf_s7comm_analysis_coalesced,
+        { "Coalesced items", "s7comm.analysis.coalesced", FT_STRING, BASE_NONE, NULL, 0x0,
+          "Byte ranges when overlapping and adjacent items are merged, and the items which can't be merged", HFILL }},
+        { &hf_s7comm_analysis_coalesced_requests,
+        { "Coalesced request count", "s7comm.analysis.coalesced_requests", FT_UINT8, BASE_DEC, NULL, 0x0,
+          "Number of requests needed for the coalesced items within the negotiated PDU length", HFILL }},
+        { &hf_s7comm_analysis_overlap_frame,
+        { "Overlaps request in frame", "s7comm.analysis.overlap_frame", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "A Read Var request of the same poll cycle reading an overlapping range", HFILL }},
 
         { &hf_s7comm_userdata_data,
         { "Data", "s7comm.data.userdata", FT_BYTES, BASE_NONE, NULL, 0x0,
@@ -4615,6 +6159,58 @@ proto_register_s7comm (void)
         { &hf_s7comm_data_blockcontrol_mc7code_len,
         { "Length of MC7 code", "s7comm.data.blockcontrol.mc7code_len", FT_STRING, BASE_NONE, NULL, 0x0,
           "Length of MC7 code in bytes", HFILL }},
+        { &hf_s7comm_data_blockcontrol_functionstatus,
+        { "Function status", "s7comm.data.blockcontrol.functionstatus", FT_UINT8, BASE_HEX, NULL, 0x0,
+          "Function status of the response, 0x01: More data following", HFILL }},
+        { &hf_s7comm_data_blockcontrol_uploadid,
+        { "Upload ID", "s7comm.data.blockcontrol.uploadid", FT_UINT32, BASE_HEX, NULL, 0x0,
+          "ID of the upload, given by the PLC in the start upload response", HFILL }},
+        { &hf_s7comm_data_blockcontrol_blocklen,
+        { "Length of the block", "s7comm.data.blockcontrol.blocklen", FT_STRING, BASE_NONE, NULL, 0x0,
+          "Length of the complete block in bytes", HFILL }},
+        { &hf_s7comm_data_blockcontrol_upload_len,
+        { "Length", "s7comm.data.blockcontrol.upload_len", FT_UINT16, BASE_DEC, NULL, 0x0,
+          "Length of the upload data in this PDU", HFILL }},
+        { &hf_s7comm_data_blockcontrol_upload_unknown,
+        { "Unknown", "s7comm.data.blockcontrol.upload_unknown", FT_BYTES, BASE_NONE, NULL, 0x0,
+          NULL, HFILL }},
+        { &hf_s7comm_data_blockcontrol_upload_data,
+        { "Upload data", "s7comm.data.blockcontrol.upload_data", FT_BYTES, BASE_NONE, NULL, 0x0,
+          "Part of the block in this PDU", HFILL }},
+        { &hf_s7comm_data_blockcontrol_block,
+        { "Block", "s7comm.data.blockcontrol.block", FT_BYTES, BASE_NONE, NULL, 0x0,
+          "Complete block from all upload PDUs", HFILL }},
+        /* Upload fragment fields */
+        { &hf_s7comm_upload_fragment_overlap,
+        { "Fragment overlap", "s7comm.upload.fragment.overlap", FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+          "Fragment overlaps with other fragments", HFILL }},
+        { &hf_s7comm_upload_fragment_overlap_conflict,
+        { "Conflicting data in fragment overlap", "s7comm.upload.fragment.overlap.conflict", FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+          "Overlapping fragments contained conflicting data", HFILL }},
+        { &hf_s7comm_upload_fragment_multiple_tails,
+        { "Multiple tail fragments found", "s7comm.upload.fragment.multipletails", FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+          "Several tails were found when defragmenting the packet", HFILL }},
+        { &hf_s7comm_upload_fragment_too_long_fragment,
+        { "Fragment too long", "s7comm.upload.fragment.toolongfragment", FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+          "Fragment contained data past end of packet", HFILL }},
+        { &hf_s7comm_upload_fragment_error,
+        { "Defragmentation error", "s7comm.upload.fragment.error", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "Defragmentation error due to illegal fragments", HFILL }},
+        { &hf_s7comm_upload_fragment_count,
+        { "Fragment count", "s7comm.upload.fragment.count", FT_UINT32, BASE_DEC, NULL, 0x0,
+          NULL, HFILL }},
+        { &hf_s7comm_upload_reassembled_in,
+        { "Reassembled in", "s7comm.upload.reassembled.in", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "Upload fragments are reassembled in the given packet", HFILL }},
+        { &hf_s7comm_upload_reassembled_length,
+        { "Reassembled block length", "s7comm.upload.reassembled.length", FT_UINT32, BASE_DEC, NULL, 0x0,
+          "The total length of the uploaded block", HFILL }},
+        { &hf_s7comm_upload_fragment,
+        { "Upload Fragment", "s7comm.upload.fragment", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          NULL, HFILL }},
+        { &hf_s7comm_upload_fragments,
+        { "Upload Fragments", "s7comm.upload.fragments", FT_NONE, BASE_NONE, NULL, 0x0,
+          NULL, HFILL }},
 
         /* Variable table */
         { &hf_s7comm_vartab_data_type,
@@ -4644,11 +6240,26 @@ proto_register_s7comm (void)
 
         /* cyclic data */
         { &hf_s7comm_cycl_interval_timebase,
-        { "Interval timebase", "s7comm.cyclic.interval_timebase", FT_UINT8, BASE_DEC, NULL, 0x0,
+        { "Interval timebase", "s7comm.cyclic.interval_timebase", FT_UINT8, BASE_DEC, VALS(cycl_interval_timebase_names), 0x0,
           NULL, HFILL }},
         { &hf_s7comm_cycl_interval_time,
         { "Interval time", "s7comm.cyclic.interval_time", FT_UINT8, BASE_DEC, NULL, 0x0,
           NULL, HFILL }},
+        { &hf_s7comm_cycl_interval,
+        { "Interval [ms]", "s7comm.cyclic.interval", FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Requested interval of the subscription in milliseconds", HFILL }},
+        { &hf_s7comm_cycl_request_in,
+        { "Subscription request in", "s7comm.cyclic.request_in", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "The request of this cyclic data subscription is in this frame", HFILL }},
+        { &hf_s7comm_cycl_push_no,
+        { "Push number", "s7comm.cyclic.push_no", FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Number of this push in the subscription", HFILL }},
+        { &hf_s7comm_cycl_delta,
+        { "Time since previous push", "s7comm.cyclic.delta", FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+          "Time since the previous push or the response of the subscription", HFILL }},
+        { &hf_s7comm_cycl_lateness,
+        { "Lateness", "s7comm.cyclic.lateness", FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+          "Time since previous push minus the requested interval, negative if early", HFILL }},
 
         /* PBC, Programmable Block Functions */
         { &hf_s7comm_pbc_unknown,
@@ -4894,9 +6505,29 @@ proto_register_s7comm (void)
         &ett_s7comm_cpu_alarm_message_associated_value,
         &ett_s7comm_cpu_diag_msg,
         &ett_s7comm_cpu_diag_msg_eventid,
-        &ett_s7comm_cpu_msgservice_subscribe_events
+        &ett_s7comm_cpu_msgservice_subscribe_events,
+        &ett_s7comm_upload_fragment,
+        &ett_s7comm_upload_fragments,
+        &ett_s7comm_analysis
+    };
+
+    static ei_register_info ei[] = {
+        { &ei_s7comm_analysis_item_overlap,
+        { "s7comm.analysis.item_overlap", PI_PROTOCOL, PI_WARN,
+          "Items of a Read Var request read overlapping ranges", EXPFILL }},
+        { &ei_s7comm_analysis_item_adjacent,
+        { "s7comm.analysis.item_adjacent", PI_PROTOCOL, PI_NOTE,
+          "Items of a Read Var request read adjacent ranges", EXPFILL }},
+        { &ei_s7comm_analysis_redundant_read,
+        { "s7comm.analysis.redundant_read", PI_PROTOCOL, PI_WARN,
+          "Read Var request reads ranges already read in the same poll cycle", EXPFILL }},
+        { &ei_s7comm_cycl_missed_push,
+        { "s7comm.cyclic.missed_push", PI_SEQUENCE, PI_WARN,
+          "Cyclic data push is late by at least one interval", EXPFILL }},
     };
 
+    expert_module_t *expert_s7comm;
+
     proto_s7comm = proto_register_protocol (
             "S7 Communication",         /* name */
             "S7COMM",                   /* short name */
@@ -4908,6 +6539,15 @@ proto_register_s7comm (void)
     s7comm_register_szl_types(proto_s7comm);
 
     proto_register_subtree_array(ett, array_length (ett));
+
+    expert_s7comm = expert_register_protocol(proto_s7comm);
+    expert_register_field_array(expert_s7comm, ei, array_length (ei));
+
+    s7comm_tap = register_tap("s7comm");
+    register_srt_table(proto_s7comm, NULL, 2, s7comm_srt_packet, s7comm_srt_init, NULL);
+    s7comm_eo_tap = register_export_object(proto_s7comm, s7comm_eo_packet, NULL);
+
+    register_init_routine(s7comm_defragment_init);
 }
 
 /* Register this protocol */
@@ -4915,8 +6555,16 @@ void
 proto_reg_handoff_s7comm(void)
 {
     /* register ourself as an heuristic cotp (ISO 8073) payload dissector */
-    heur_dissector_add("cotp", dissect_s7comm, proto_s7comm);
-    heur_dissector_add("cotp_is", dissect_s7comm, proto_s7comm);
+    heur_dissector_add("cotp", dissect_s7comm, "S7 Communication over COTP", "s7comm_cotp", proto_s7comm, HEURISTIC_ENABLE);
+    heur_dissector_add("cotp_is", dissect_s7comm, "S7 Communication over COTP", "s7comm_cotp_is", proto_s7comm, HEURISTIC_ENABLE);
+    tpkt_handle = find_dissector("tpkt");
+
+    stats_tree_register_plugin("s7comm", "s7comm,srt_hist", "S7COMM/Service Response Time Histogram", 0,
+        s7comm_srt_stats_tree_packet, s7comm_srt_stats_tree_init, NULL);
+    stats_tree_register_plugin("s7comm", "s7comm,addresses", "S7COMM/Read-Write Var Addresses", 0,
+        s7comm_addr_stats_tree_packet, s7comm_addr_stats_tree_init, NULL);
+    stats_tree_register_plugin("s7comm", "s7comm,cyclic", "S7COMM/Cyclic Data", 0,
+        s7comm_cyclic_stats_tree_packet, s7comm_cyclic_stats_tree_init, NULL);
 }
 
 /*
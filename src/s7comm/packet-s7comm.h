@@ -65,6 +65,42 @@
 
 extern const value_string s7comm_item_return_valuenames[];
 
+/**************************************************************************
+ * Address of a S7ANY item of a read/write request
+ */
+typedef struct {
+    guint8 syntax_id;                   /* S7COMM_SYNTAXID_S7ANY if the address below is valid, otherwise 0 */
+    guint8 t_size;                      /* Transport size of the request */
+    guint16 len;                        /* Number of elements of t_size */
+    guint16 db;
+    guint8 area;
+    guint32 bytepos;
+    guint8 bitpos;
+} s7comm_item_info_t;
+
+/**************************************************************************
+ * Info passed to the "s7comm" tap for every PDU.
+ * For a matched response the function is the one of the request.
+ */
+typedef struct {
+    guint8 rosctr;              /* ROSCTR of this PDU */
+    guint8 req_rosctr;          /* ROSCTR of the request, Job or Userdata */
+    guint16 pduref;
+    guint8 function;            /* Function code of a Job, or function group of a Userdata request */
+    guint8 subfunc;             /* Subfunction of a Userdata request */
+    gboolean is_response;       /* TRUE if this is a response matched to a request */
+    guint32 req_frame;          /* Frame number of the request, if is_response */
+    nstime_t resp_time;         /* Time between request and response, if is_response */
+    guint8 item_count;          /* Number of items of a Read/Write Var request */
+    const s7comm_item_info_t *items;    /* Items of a Read/Write Var request, NULL if not available */
+    guint32 cyclic_push_no;     /* Number of a cyclic data push in its subscription, 0 if no push */
+    guint32 cyclic_req_frame;   /* Frame number of the subscribing request, if cyclic_push_no > 0 */
+    guint8 cyclic_job_id;       /* Job id of the subscription, if cyclic_push_no > 0 */
+    guint32 cyclic_interval_ms; /* Requested interval, 0 if unknown */
+    nstime_t cyclic_delta;      /* Time since the previous push or response, if cyclic_push_no > 0 */
+    guint32 cyclic_bytes;       /* Length of the pushed data */
+} s7comm_tap_info_t;
+
 guint32 s7comm_decode_ud_cpu_diagnostic_message(tvbuff_t *tvb, packet_info *pinfo, gboolean add_info_to_col, proto_tree *data_tree, guint32 offset);
 
 #endif
@@ -25,12 +25,53 @@
 #include "config.h"
 
 #include <epan/packet.h>
+#include <epan/reassemble.h>
 
 #include "packet-s7comm.h"
 #include "packet-s7comm_szl_ids.h"
 
 static gint ett_s7comm_szl = -1;
 
+/* These fields used when reassembling SZL responses over several PDUs */
+static gint hf_s7comm_szl_fragments = -1;
+static gint hf_s7comm_szl_fragment = -1;
+static gint hf_s7comm_szl_fragment_overlap = -1;
+static gint hf_s7comm_szl_fragment_overlap_conflict = -1;
+static gint hf_s7comm_szl_fragment_multiple_tails = -1;
+static gint hf_s7comm_szl_fragment_too_long_fragment = -1;
+static gint hf_s7comm_szl_fragment_error = -1;
+static gint hf_s7comm_szl_fragment_count = -1;
+static gint hf_s7comm_szl_reassembled_in = -1;
+static gint hf_s7comm_szl_reassembled_length = -1;
+static gint ett_s7comm_szl_fragment = -1;
+static gint ett_s7comm_szl_fragments = -1;
+
+static const fragment_items s7comm_szl_frag_items = {
+    /* Fragment subtrees */
+    &ett_s7comm_szl_fragment,
+    &ett_s7comm_szl_fragments,
+    /* Fragment fields */
+    &hf_s7comm_szl_fragments,
+    &hf_s7comm_szl_fragment,
+    &hf_s7comm_szl_fragment_overlap,
+    &hf_s7comm_szl_fragment_overlap_conflict,
+    &hf_s7comm_szl_fragment_multiple_tails,
+    &hf_s7comm_szl_fragment_too_long_fragment,
+    &hf_s7comm_szl_fragment_error,
+    &hf_s7comm_szl_fragment_count,
+    /* Reassembled in field */
+    &hf_s7comm_szl_reassembled_in,
+    /* Reassembled length field */
+    &hf_s7comm_szl_reassembled_length,
+    /* Reassembled data field */
+    NULL,
+    /* Tag */
+    "SZL fragments"
+};
+
+/* The fragments of a response are identified by the data-unit-reference, addresses and ports */
+static reassembly_table s7comm_szl_reassembly_table;
+
 static gint hf_s7comm_userdata_szl_partial_list = -1;           /* Partial list in szl response */
 static gint hf_s7comm_userdata_szl_id = -1;                     /* SZL id */
 
@@ -3801,6 +3842,18 @@ s7comm_decode_szl_id_0424_idx_0000(tvbuff_t *tvb,
     return offset;
 }
 
+/*******************************************************************************************************
+ *
+ * Initialize the reassembly table, called on every new capture file
+ *
+ *******************************************************************************************************/
+static void
+s7comm_szl_defragment_init(void)
+{
+    reassembly_table_init(&s7comm_szl_reassembly_table,
+                          &addresses_ports_reassembly_table_functions);
+}
+
 /*******************************************************************************************************
  *
  * Register SZL header fields
@@ -3846,12 +3899,45 @@ s7comm_register_szl_types(int proto)
         { &hf_s7comm_userdata_szl_data,
         { "SZL data", "s7comm.param.userdata.szl_data", FT_BYTES, BASE_NONE, NULL, 0x0,
           NULL, HFILL }},
+        /* Fragment fields */
+        { &hf_s7comm_szl_fragment_overlap,
+        { "Fragment overlap", "s7comm.szl.fragment.overlap", FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+          "Fragment overlaps with other fragments", HFILL }},
+        { &hf_s7comm_szl_fragment_overlap_conflict,
+        { "Conflicting data in fragment overlap", "s7comm.szl.fragment.overlap.conflict", FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+          "Overlapping fragments contained conflicting data", HFILL }},
+        { &hf_s7comm_szl_fragment_multiple_tails,
+        { "Multiple tail fragments found", "s7comm.szl.fragment.multipletails", FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+          "Several tails were found when defragmenting the packet", HFILL }},
+        { &hf_s7comm_szl_fragment_too_long_fragment,
+        { "Fragment too long", "s7comm.szl.fragment.toolongfragment", FT_BOOLEAN, BASE_NONE, NULL, 0x0,
+          "Fragment contained data past end of packet", HFILL }},
+        { &hf_s7comm_szl_fragment_error,
+        { "Defragmentation error", "s7comm.szl.fragment.error", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "Defragmentation error due to illegal fragments", HFILL }},
+        { &hf_s7comm_szl_fragment_count,
+        { "Fragment count", "s7comm.szl.fragment.count", FT_UINT32, BASE_DEC, NULL, 0x0,
+          NULL, HFILL }},
+        { &hf_s7comm_szl_reassembled_in,
+        { "Reassembled in", "s7comm.szl.reassembled.in", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "SZL fragments are reassembled in the given packet", HFILL }},
+        { &hf_s7comm_szl_reassembled_length,
+        { "Reassembled SZL length", "s7comm.szl.reassembled.length", FT_UINT32, BASE_DEC, NULL, 0x0,
+          "The total length of the reassembled SZL data", HFILL }},
+        { &hf_s7comm_szl_fragment,
+        { "SZL Fragment", "s7comm.szl.fragment", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          NULL, HFILL }},
+        { &hf_s7comm_szl_fragments,
+        { "SZL Fragments", "s7comm.szl.fragments", FT_NONE, BASE_NONE, NULL, 0x0,
+          NULL, HFILL }},
     };
 
     /* Register Subtrees */
     static gint *ett[] = {
         &ett_s7comm_szl,
         &ett_s7comm_userdata_szl_id,
+        &ett_s7comm_szl_fragment,
+        &ett_s7comm_szl_fragments,
 
         &ett_s7comm_szl_0131_0002_funkt_0,
         &ett_s7comm_szl_0131_0002_funkt_1,
@@ -3918,6 +4004,189 @@ s7comm_register_szl_types(int proto)
     s7comm_szl_xy74_0000_register(proto);
 
     s7comm_szl_0424_0000_register(proto);
+
+    register_init_routine(s7comm_szl_defragment_init);
+}
+
+/*******************************************************************************************************
+ *
+ * SZL response: ID, index and the partial lists.
+ * Called with the data of a single PDU, or with the reassembled data of a fragmented response.
+ *
+ *******************************************************************************************************/
+static guint32
+s7comm_decode_szl_response_data(tvbuff_t *tvb,
+                                packet_info *pinfo,
+                                proto_tree *data_tree,
+                                guint32 len,                /* length of the SZL data */
+                                guint32 offset)
+{
+    guint16 id;
+    guint16 idx;
+    guint16 list_len;
+    guint16 list_count;
+    guint16 i;
+    guint16 tbytes = 0;
+    proto_item *szl_item = NULL;
+    proto_tree *szl_item_tree = NULL;
+    proto_item *szl_item_entry = NULL;
+    const gchar* szl_index_description;
+    gboolean szl_decoded = FALSE;
+
+    id = tvb_get_ntohs(tvb, offset);
+    proto_tree_add_bitmask(data_tree, tvb, offset, hf_s7comm_userdata_szl_id,
+        ett_s7comm_userdata_szl_id, s7comm_userdata_szl_id_fields, ENC_BIG_ENDIAN);
+    offset += 2;
+    idx = tvb_get_ntohs(tvb, offset);
+    szl_item_entry = proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_index, tvb, offset, 2, ENC_BIG_ENDIAN);
+    offset += 2;
+    szl_index_description = s7comm_get_szl_id_index_description_text(id, idx);
+    if (szl_index_description != NULL) {
+        proto_item_append_text(szl_item_entry, " [%s]", szl_index_description);
+    }
+    proto_item_append_text(data_tree, " (SZL-ID: 0x%04x, Index: 0x%04x)", id, idx);
+    col_append_fstr(pinfo->cinfo, COL_INFO, " ID=0x%04x Index=0x%04x" , id, idx);
+
+    /* SZL-Data, 4 Bytes header, 4 bytes id/index = 8 bytes */
+    list_len = tvb_get_ntohs(tvb, offset); /* Length of an list set in bytes */
+    proto_tree_add_uint(data_tree, hf_s7comm_userdata_szl_id_partlist_len, tvb, offset, 2, list_len);
+    offset += 2;
+    list_count = tvb_get_ntohs(tvb, offset); /* count of partlists */
+    proto_tree_add_uint(data_tree, hf_s7comm_userdata_szl_id_partlist_cnt, tvb, offset, 2, list_count);
+    /* Some SZL responses got more lists than fit one PDU (e.g. Diagnosepuffer) and must be read
+     * out in several telegrams, so we have to check here if the list_count is above limits
+     * of the length of data part. The remainding bytes will be print as raw bytes, because
+     * it's not possible to decode this and following telegrams without knowing the previous requests.
+     */
+    tbytes = 0;
+    if (list_len > 0) {
+        if ((list_count * list_len) > (len - 8)) {
+            list_count = (len - 8) / list_len;
+            /* remind the number of trailing bytes */
+            if (list_count > 0) {
+                tbytes = (len - 8) % list_len;
+            }
+        }
+    }
+    offset += 2;
+    /* Add a Data element for each partlist */
+    if (len > 8) {      /* minimum length of a correct szl data part is 8 bytes */
+        for (i = 1; i <= list_count; i++) {
+            /* Add a separate tree for the SZL data */
+            szl_item = proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_tree, tvb, offset, list_len, ENC_NA);
+            szl_item_tree = proto_item_add_subtree(szl_item, ett_s7comm_szl);
+            proto_item_append_text(szl_item, " (list count no. %d)", i);
+
+            szl_decoded = FALSE;
+            /* lets try to decode some known szl-id and indexes */
+            switch (id) {
+                case 0x0000:
+                    offset = s7comm_decode_szl_id_xy00(tvb, szl_item_tree, id, idx, offset);
+                    szl_decoded = TRUE;
+                    break;
+                case 0x0013:
+                    if (idx == 0x0000) {
+                        offset = s7comm_decode_szl_id_0013_idx_0000(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    }
+                    break;
+                case 0x0011:
+                case 0x0111:
+                    if ((idx == 0x0001) || (idx == 0x0000)) {
+                        offset = s7comm_decode_szl_id_0111_idx_0001(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    }
+                    break;
+                case 0x00a0:
+                case 0x01a0:
+                case 0x04a0:
+                case 0x05a0:
+                case 0x06a0:
+                case 0x07a0:
+                case 0x08a0:
+                case 0x09a0:
+                case 0x0aa0:
+                case 0x0ba0:
+                case 0x0ca0:
+                case 0x0da0:
+                case 0x0ea0:
+                    /* the data structure is the same as used when CPU is sending online such messages */
+                    offset = s7comm_decode_ud_cpu_diagnostic_message(tvb, pinfo, FALSE, szl_item_tree, offset);
+                    szl_decoded = TRUE;
+                    break;
+                case 0x0131:
+                    if (idx == 0x0001) {
+                        offset = s7comm_decode_szl_id_0131_idx_0001(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0002) {
+                        offset = s7comm_decode_szl_id_0131_idx_0002(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0003) {
+                        offset = s7comm_decode_szl_id_0131_idx_0003(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0004) {
+                        offset = s7comm_decode_szl_id_0131_idx_0004(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0006) {
+                        offset = s7comm_decode_szl_id_0131_idx_0006(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0010) {
+                        offset = s7comm_decode_szl_id_0131_idx_0010(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    }
+                    break;
+                case 0x0132:
+                    if (idx == 0x0001) {
+                        offset = s7comm_decode_szl_id_0132_idx_0001(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0002) {
+                        offset = s7comm_decode_szl_id_0132_idx_0002(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0004) {
+                        offset = s7comm_decode_szl_id_0132_idx_0004(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0005) {
+                        offset = s7comm_decode_szl_id_0132_idx_0005(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    } else if (idx == 0x0006) {
+                        offset = s7comm_decode_szl_id_0132_idx_0006(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    }
+                    break;
+                case 0x0019:
+                case 0x0119:
+                case 0x0074:
+                case 0x0174:
+                        offset = s7comm_decode_szl_id_xy74_idx_0000(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    break;
+                case 0x0124:
+                case 0x0424:
+                    if (idx == 0x0000) {
+                        offset = s7comm_decode_szl_id_0424_idx_0000(tvb, szl_item_tree, offset);
+                        szl_decoded = TRUE;
+                    }
+                    break;
+                default:
+                    szl_decoded = FALSE;
+                    break;
+            }
+            if (szl_decoded == FALSE) {
+                proto_tree_add_item(szl_item_tree, hf_s7comm_userdata_szl_partial_list, tvb, offset, list_len, ENC_NA);
+                offset += list_len;
+            }
+        } /* ...for */
+    }
+    /* add raw bytes of data part when SZL response doesn't fit one PDU */
+    if (tbytes > 0) {
+        /* Add a separate tree for the SZL data fragment */
+        szl_item = proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_tree, tvb, offset, tbytes, ENC_NA);
+        szl_item_tree = proto_item_add_subtree(szl_item, ett_s7comm_szl);
+        proto_item_append_text(szl_item, " [Fragment, complete response doesn't fit one PDU]");
+        proto_tree_add_item(szl_item_tree, hf_s7comm_userdata_szl_data, tvb, offset, tbytes, ENC_NA);
+        offset += tbytes;
+    }
+    return offset;
 }
 
 /*******************************************************************************************************
@@ -3939,17 +4208,15 @@ s7comm_decode_ud_cpu_szl_subfunc(tvbuff_t *tvb,
 {
     guint16 id;
     guint16 idx;
-    guint16 list_len;
-    guint16 list_count;
-    guint16 i;
-    guint16 tbytes = 0;
     proto_item *szl_item = NULL;
     proto_tree *szl_item_tree = NULL;
     proto_item *szl_item_entry = NULL;
     const gchar* szl_index_description;
+    fragment_head *fd_head;
+    tvbuff_t *new_tvb;
+    gboolean save_fragmented;
 
     gboolean know_data = FALSE;
-    gboolean szl_decoded = FALSE;
 
     if (type == S7COMM_UD_TYPE_REQ) {                   /*** Request ***/
         id = tvb_get_ntohs(tvb, offset);
@@ -3969,180 +4236,53 @@ s7comm_decode_ud_cpu_szl_subfunc(tvbuff_t *tvb,
     } else if (type == S7COMM_UD_TYPE_RES) {            /*** Response ***/
         /* When response OK, data follows */
         if (ret_val == S7COMM_ITEM_RETVAL_DATA_OK) {
-            /* A fragmented response has a data-unit-ref <> 0 with Last-data-unit == 1
-             * It's only possible to decode the first response of a fragment, because
-             * only the first PDU contains the ID/Index header. Will result in an display-error when a PDU goes over more than 2 PDUs, but ... eeeek ... no better way to realize this.
+            /* A response which doesn't fit one PDU is sent in several PDUs with the same data-unit-ref.
+             * Only the first PDU contains the ID/Index header, so the data parts are reassembled
+             * and decoded in the PDU with the last data unit.
              * last_data_unit == 0 when it's the last unit
              * last_data_unit == 1 when it's not the last unit
              */
-            if (data_unit_ref != 0 && last_data_unit == 0) {
-                szl_item = proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_tree, tvb, offset, len, ENC_NA);
-                szl_item_tree = proto_item_add_subtree(szl_item, ett_s7comm_szl);
-                proto_item_append_text(szl_item, " [Fragment, continuation of previous data]");
-
-                proto_tree_add_item(szl_item_tree, hf_s7comm_userdata_szl_data, tvb, offset, len, ENC_NA);
-                offset += len;
-                col_append_fstr(pinfo->cinfo, COL_INFO, " SZL data fragment");
-            } else {
-                id = tvb_get_ntohs(tvb, offset);
-                proto_tree_add_bitmask(data_tree, tvb, offset, hf_s7comm_userdata_szl_id,
-                    ett_s7comm_userdata_szl_id, s7comm_userdata_szl_id_fields, ENC_BIG_ENDIAN);
-                offset += 2;
-                idx = tvb_get_ntohs(tvb, offset);
-                szl_item_entry = proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_index, tvb, offset, 2, ENC_BIG_ENDIAN);
-                offset += 2;
-                szl_index_description = s7comm_get_szl_id_index_description_text(id, idx);
-                if (szl_index_description != NULL) {
-                    proto_item_append_text(szl_item_entry, " [%s]", szl_index_description);
-                }
-                proto_item_append_text(data_tree, " (SZL-ID: 0x%04x, Index: 0x%04x)", id, idx);
-                col_append_fstr(pinfo->cinfo, COL_INFO, " ID=0x%04x Index=0x%04x" , id, idx);
-
-                /* SZL-Data, 4 Bytes header, 4 bytes id/index = 8 bytes */
-                list_len = tvb_get_ntohs(tvb, offset); /* Length of an list set in bytes */
-                proto_tree_add_uint(data_tree, hf_s7comm_userdata_szl_id_partlist_len, tvb, offset, 2, list_len);
-                offset += 2;
-                list_count = tvb_get_ntohs(tvb, offset); /* count of partlists */
-                proto_tree_add_uint(data_tree, hf_s7comm_userdata_szl_id_partlist_cnt, tvb, offset, 2, list_count);
-                /* Some SZL responses got more lists than fit one PDU (e.g. Diagnosepuffer) and must be read
-                 * out in several telegrams, so we have to check here if the list_count is above limits
-                 * of the length of data part. The remainding bytes will be print as raw bytes, because
-                 * it's not possible to decode this and following telegrams without knowing the previous requests.
+            if (data_unit_ref != 0 || last_data_unit != 0) {
+                save_fragmented = pinfo->fragmented;
+                pinfo->fragmented = TRUE;
+                fd_head = fragment_add_seq_next(&s7comm_szl_reassembly_table,
+                                                 tvb, offset, pinfo,
+                                                 data_unit_ref,         /* ID for fragments belonging together */
+                                                 NULL,                  /* void *data */
+                                                 len,                   /* fragment length */
+                                                 (last_data_unit != 0)); /* More fragments? */
+                new_tvb = process_reassembled_data(tvb, offset, pinfo,
+                                                   "Reassembled SZL", fd_head, &s7comm_szl_frag_items,
+                                                   NULL, data_tree);
+                pinfo->fragmented = save_fragmented;
+                /* A last unit without any previous part (e.g. capture started in the middle of a
+                 * fragmented response) has no header, and can't be decoded.
                  */
-                tbytes = 0;
-                if (list_len > 0) {
-                    if ((list_count * list_len) > (len - 8)) {
-                        list_count = (len - 8) / list_len;
-                        /* remind the number of trailing bytes */
-                        if (list_count > 0) {
-                            tbytes = (len - 8) % list_count;
-                        }
-                    }
+                if (new_tvb != NULL && data_unit_ref != 0 && fd_head->next != NULL && fd_head->next->next == NULL) {
+                    new_tvb = NULL;
                 }
-                offset += 2;
-                /* Add a Data element for each partlist */
-                if (len > 8) {      /* minimum length of a correct szl data part is 8 bytes */
-                    for (i = 1; i <= list_count; i++) {
-                        /* Add a separate tree for the SZL data */
-                        szl_item = proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_tree, tvb, offset, list_len, ENC_NA);
-                        szl_item_tree = proto_item_add_subtree(szl_item, ett_s7comm_szl);
-                        proto_item_append_text(szl_item, " (list count no. %d)", i);
-
-                        szl_decoded = FALSE;
-                        /* lets try to decode some known szl-id and indexes */
-                        switch (id) {
-                            case 0x0000:
-                                offset = s7comm_decode_szl_id_xy00(tvb, szl_item_tree, id, idx, offset);
-                                szl_decoded = TRUE;
-                                break;
-                            case 0x0013:
-                                if (idx == 0x0000) {
-                                    offset = s7comm_decode_szl_id_0013_idx_0000(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                }
-                                break;
-                            case 0x0011:
-                            case 0x0111:
-                                if ((idx == 0x0001) || (idx == 0x0000)) {
-                                    offset = s7comm_decode_szl_id_0111_idx_0001(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                }
-                                break;
-                            case 0x00a0:
-                            case 0x01a0:
-                            case 0x04a0:
-                            case 0x05a0:
-                            case 0x06a0:
-                            case 0x07a0:
-                            case 0x08a0:
-                            case 0x09a0:
-                            case 0x0aa0:
-                            case 0x0ba0:
-                            case 0x0ca0:
-                            case 0x0da0:
-                            case 0x0ea0:
-                                /* the data structure is the same as used when CPU is sending online such messages */
-                                offset = s7comm_decode_ud_cpu_diagnostic_message(tvb, pinfo, FALSE, szl_item_tree, offset);
-                                szl_decoded = TRUE;
-                                break;
-                            case 0x0131:
-                                if (idx == 0x0001) {
-                                    offset = s7comm_decode_szl_id_0131_idx_0001(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0002) {
-                                    offset = s7comm_decode_szl_id_0131_idx_0002(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0003) {
-                                    offset = s7comm_decode_szl_id_0131_idx_0003(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0004) {
-                                    offset = s7comm_decode_szl_id_0131_idx_0004(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0006) {
-                                    offset = s7comm_decode_szl_id_0131_idx_0006(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0010) {
-                                    offset = s7comm_decode_szl_id_0131_idx_0010(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                }
-                                break;
-                            case 0x0132:
-                                if (idx == 0x0001) {
-                                    offset = s7comm_decode_szl_id_0132_idx_0001(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0002) {
-                                    offset = s7comm_decode_szl_id_0132_idx_0002(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0004) {
-                                    offset = s7comm_decode_szl_id_0132_idx_0004(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0005) {
-                                    offset = s7comm_decode_szl_id_0132_idx_0005(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                } else if (idx == 0x0006) {
-                                    offset = s7comm_decode_szl_id_0132_idx_0006(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                }
-                                break;
-                            case 0x0019:
-                            case 0x0119:
-                            case 0x0074:
-                            case 0x0174:
-                                    offset = s7comm_decode_szl_id_xy74_idx_0000(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                break;
-                            case 0x0124:
-                            case 0x0424:
-                                if (idx == 0x0000) {
-                                    offset = s7comm_decode_szl_id_0424_idx_0000(tvb, szl_item_tree, offset);
-                                    szl_decoded = TRUE;
-                                }
-                                break;
-                            default:
-                                szl_decoded = FALSE;
-                                break;
-                        }
-                        if (szl_decoded == FALSE) {
-                            proto_tree_add_item(szl_item_tree, hf_s7comm_userdata_szl_partial_list, tvb, offset, list_len, ENC_NA);
-                            offset += list_len;
-                        }
-                    } /* ...for */
+                if (new_tvb != NULL) {
+                    s7comm_decode_szl_response_data(new_tvb, pinfo, data_tree, tvb_reported_length(new_tvb), 0);
+                } else {
+                    szl_item = proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_tree, tvb, offset, len, ENC_NA);
+                    szl_item_tree = proto_item_add_subtree(szl_item, ett_s7comm_szl);
+                    if (last_data_unit != 0) {
+                        proto_item_append_text(szl_item, " [Fragment]");
+                    } else {
+                        proto_item_append_text(szl_item, " [Fragment, continuation of previous data]");
+                    }
+                    proto_tree_add_item(szl_item_tree, hf_s7comm_userdata_szl_data, tvb, offset, len, ENC_NA);
+                    col_append_fstr(pinfo->cinfo, COL_INFO, " SZL data fragment");
                 }
+                offset += len;
+            } else {
+                offset = s7comm_decode_szl_response_data(tvb, pinfo, data_tree, len, offset);
             }
         } else {
             col_append_fstr(pinfo->cinfo, COL_INFO, " Return value:[%s]", val_to_str(ret_val, s7comm_item_return_valuenames, "Unknown return value:0x%02x"));
         }
         know_data = TRUE;
     }
-    /* add raw bytes of data part when SZL response doesn't fit one PDU */
-    if (know_data == TRUE && tbytes > 0) {
-        /* Add a separate tree for the SZL data fragment */
-        szl_item = proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_tree, tvb, offset, tbytes, ENC_NA);
-        szl_item_tree = proto_item_add_subtree(szl_item, ett_s7comm_szl);
-        proto_item_append_text(szl_item, " [Fragment, complete response doesn't fit one PDU]");
-        proto_tree_add_item(szl_item_tree, hf_s7comm_userdata_szl_data, tvb, offset, tbytes, ENC_NA);
-        offset += tbytes;
-    }
     if (know_data == FALSE && dlength > 4) {
         proto_tree_add_item(data_tree, hf_s7comm_userdata_szl_data, tvb, offset, dlength - 4, ENC_NA);
         offset += dlength;
@@ -41,9 +41,20 @@
 #include <epan/conversation.h>
 #include <epan/proto_data.h>
 #include <epan/expert.h>
+#include <epan/tap.h>
+#include <epan/stats_tree.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/srt_table.h>
+#include <epan/addr_resolv.h>
+#include <wsutil/report_message.h>
+#include <wsutil/file_util.h>
+#include <wsutil/wslog.h>
+#include <errno.h>
 #include <wsutil/utf8_entities.h>
 #include <epan/dissectors/packet-tls-utils.h>
 
+#include "packet-s7comm_plus.h"
+
 #ifdef HAVE_ZLIB
 #include <zlib.h>
 #endif
@@ -52,12 +63,8 @@ void proto_reg_handoff_s7commp(void);
 void proto_register_s7commp(void);
 
 static uint32_t s7commp_decode_id_value_list(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, uint32_t offset, uint32_t relid, bool recursive, bool disable_vlq);
-static uint32_t s7commp_decode_attrib_subscriptionreflist(tvbuff_t *tvb, proto_tree *tree, uint32_t offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                          ,
-                                          packet_info *pinfo
-#endif
-    );
+static uint32_t s7commp_decode_attrib_subscriptionreflist(tvbuff_t *tvb, proto_tree *tree, uint32_t offset, packet_info *pinfo);
+static void s7commp_decode_attrib_subscriptioncreditlimit(tvbuff_t *tvb, uint32_t offset, struct s7commp_subscription_s *sub);
 
 /* Setting ENABLE_PROTO_TREE_ADD_TEXT to 1 enables the proto_tree_add_text
  * function which is convenient for quick development.
@@ -84,6 +91,8 @@ static uint32_t s7commp_decode_attrib_subscriptionreflist(tvbuff_t *tvb, proto_t
 
 /* Wireshark ID of the S7COMM_PLUS protocol */
 static int proto_s7commp = -1;
+static int s7commp_tap = -1;
+static int s7commp_value_tap = -1;
 
 /* Forward declaration */
 static int dissect_s7commp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data);
@@ -2630,6 +2639,56 @@ static const value_string explore_class_lib_names[] = {
     { 0,                                        NULL }
 };
 
+/* Ranges of dynamic IDs, which are not in id_number_names.
+ * With xindex = bits 16..23 and section = bits 0..15 of the ID, the name is formatted as:
+ */
+typedef enum {
+    S7COMMP_IDRANGE_SECTION,            /* <prefix><section> */
+    S7COMMP_IDRANGE_XINDEX_SECTION,     /* <prefix><xindex>.<section> */
+    S7COMMP_IDRANGE_SECTION_XINDEX,     /* <prefix><section>.<xindex> */
+    S7COMMP_IDRANGE_IQMCT,              /* TI_<explore_class_iqmct_names>.<section> */
+    S7COMMP_IDRANGE_LIB                 /* TI_LIB.<explore_class_lib_names>.<section> */
+} s7commp_idrange_format_t;
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+    const char *prefix;
+    s7commp_idrange_format_t format;
+} s7commp_idrange_t;
+
+/* Sorted by the ID, the ranges must not overlap (searched with a binary search) */
+static const s7commp_idrange_t s7commp_idranges[] = {
+    { 0x02000000, 0x0209ffff, NULL,                     S7COMMP_IDRANGE_LIB },              /* Explore Bereich LIB */
+    { 0x020a0000, 0x020affff, "TI_STRING_",             S7COMMP_IDRANGE_SECTION },          /* String with length e.g. String[10] -> TI_STRING_10, used in alarm associated values */
+    { 0x020b0000, 0x020bffff, "TI_WSTRING_",            S7COMMP_IDRANGE_SECTION },          /* WString with length e.g. WString[10] -> TI_WSTRING_10, used in alarm associated values */
+    { 0x020c0000, 0x02ffffff, NULL,                     S7COMMP_IDRANGE_LIB },              /* Explore Bereich LIB */
+    { 0x10000000, 0x1fffffff, "DynObjX1.",              S7COMMP_IDRANGE_XINDEX_SECTION },   /* Fuer variable Aufgaben wie zyklische Lesedienste, aber 1200 mit FW <=2  */
+    { 0x70000000, 0x7fffffff, "DynObjX7.",              S7COMMP_IDRANGE_XINDEX_SECTION },   /* Fuer variable Aufgaben wie zyklische Lesedienste */
+    { 0x89fd0000, 0x89fdffff, "UDT.",                   S7COMMP_IDRANGE_SECTION },
+    { 0x8a0e0000, 0x8a0effff, "DB.",                    S7COMMP_IDRANGE_SECTION },          /* Datenbaustein mit Nummer, 8a0e.... wird aber auch als AlarmID verwendet */
+    { 0x8a110000, 0x8a11ffff, "UserConstants.",         S7COMMP_IDRANGE_SECTION },
+    { 0x8a120000, 0x8a12ffff, "FB.",                    S7COMMP_IDRANGE_SECTION },
+    { 0x8a130000, 0x8a13ffff, "FC.",                    S7COMMP_IDRANGE_SECTION },
+    { 0x8a200000, 0x8a20ffff, "S_FB.",                  S7COMMP_IDRANGE_SECTION },
+    { 0x8a210000, 0x8a21ffff, "S_FC.",                  S7COMMP_IDRANGE_SECTION },
+    { 0x8a240000, 0x8a24ffff, "S_UDT.",                 S7COMMP_IDRANGE_SECTION },
+    { 0x8a320000, 0x8a32ffff, "OB.",                    S7COMMP_IDRANGE_SECTION },
+    { 0x8a360000, 0x8a36ffff, "AlarmTextList.",         S7COMMP_IDRANGE_SECTION },
+    { 0x8a370000, 0x8a37ffff, "TextList.",              S7COMMP_IDRANGE_SECTION },
+    { 0x8a380000, 0x8a38ffff, "TextContainer.",         S7COMMP_IDRANGE_SECTION },
+    { 0x8a7e0000, 0x8a7effff, "ASAlarms.",              S7COMMP_IDRANGE_SECTION },          /* AS Alarms */
+    { 0x90000000, 0x90ffffff, NULL,                     S7COMMP_IDRANGE_IQMCT },            /* TypeInfo Bereich IQMCT, wofuer hier section steht ist nicht bekannt, bisher immer 0 gesehen. */
+    { 0x91000000, 0x91ffffff, "TI_UDT.",                S7COMMP_IDRANGE_SECTION_XINDEX },   /* TypeInfo Bereich im UDT */
+    { 0x92000000, 0x92ffffff, "TI_DB.",                 S7COMMP_IDRANGE_SECTION_XINDEX },   /* TypeInfo Bereich im DB */
+    { 0x93000000, 0x93ffffff, "TI_FB.",                 S7COMMP_IDRANGE_SECTION_XINDEX },   /* TypeInfo Bereich im FB */
+    { 0x94000000, 0x94ffffff, "TI_FC.",                 S7COMMP_IDRANGE_SECTION_XINDEX },   /* TypeInfo Bereich im FC */
+    { 0x95000000, 0x95ffffff, "TI_OB.",                 S7COMMP_IDRANGE_SECTION_XINDEX },   /* TypeInfo Bereich im OB */
+    { 0x96000000, 0x96ffffff, "TI_FBT.",                S7COMMP_IDRANGE_SECTION_XINDEX },   /* TypeInfo Bereich im FBT */
+    { 0x9a000000, 0x9affffff, "TI_StructArrayDB.",      S7COMMP_IDRANGE_SECTION_XINDEX },   /* Struct-Array in einem DB */
+    { 0x9eae0000, 0x9eaeffff, "?UnknownAlarms?.",       S7COMMP_IDRANGE_SECTION }           /* Haengt auch mit dem Alarmsystem zusammen??? TODO */
+};
+
 static const value_string no_yes_names[] = {
     { 0,                                        "No" },
     { 1,                                        "Yes" },
@@ -4780,6 +4839,41 @@ static const char s7commp_dict_CompilerSettings_90000001[] = {
     0x6f, 0x6d, 0x61, 0x74, 0x69, 0x63, 0x61, 0x6c, 0x6c, 0x79
 };
 
+#ifdef HAVE_ZLIB
+/* Registry of the blob decompression dictionaries, the key of the lookup table is the
+ * dictionary id (adler32 of the dictionary) which the zlib stream requests.
+ */
+typedef struct {
+    uint32_t id;
+    const char *dict;
+    uint32_t size;
+} blob_dict_t;
+
+static const blob_dict_t s7commp_blob_dicts[] = {
+    { S7COMMP_DICTID_BodyDesc_90000001, s7commp_dict_BodyDesc_90000001, sizeof(s7commp_dict_BodyDesc_90000001) },
+    { S7COMMP_DICTID_NWC_90000001, s7commp_dict_NWC_90000001, sizeof(s7commp_dict_NWC_90000001) },
+    { S7COMMP_DICTID_NWC_98000001, s7commp_dict_NWC_98000001, sizeof(s7commp_dict_NWC_98000001) },
+    { S7COMMP_DICTID_NWT_90000001, s7commp_dict_NWT_90000001, sizeof(s7commp_dict_NWT_90000001) },
+    { S7COMMP_DICTID_NWT_98000001, s7commp_dict_NWT_98000001, sizeof(s7commp_dict_NWT_98000001) },
+    { S7COMMP_DICTID_DebugInfo_90000001, s7commp_dict_DebugInfo_90000001, sizeof(s7commp_dict_DebugInfo_90000001) },
+    { S7COMMP_DICTID_ExtRefData_90000001, s7commp_dict_ExtRefData_90000001, sizeof(s7commp_dict_ExtRefData_90000001) },
+    { S7COMMP_DICTID_IntRefData_90000001, s7commp_dict_IntRefData_90000001, sizeof(s7commp_dict_IntRefData_90000001) },
+    { S7COMMP_DICTID_IntRefData_98000001, s7commp_dict_IntRefData_98000001, sizeof(s7commp_dict_IntRefData_98000001) },
+    { S7COMMP_DICTID_IntfDescTag_90000001, s7commp_dict_IntfDescTag_90000001, sizeof(s7commp_dict_IntfDescTag_90000001) },
+    { S7COMMP_DICTID_IntfDesc_90000001, s7commp_dict_IntfDesc_90000001, sizeof(s7commp_dict_IntfDesc_90000001) },
+    { S7COMMP_DICTID_DebugInfo_IntfDesc_98000001, s7commp_dict_DebugInfo_IntfDesc_98000001, sizeof(s7commp_dict_DebugInfo_IntfDesc_98000001) },
+    { S7COMMP_DICTID_TagLineComm_90000001, s7commp_dict_TagLineComm_90000001, sizeof(s7commp_dict_TagLineComm_90000001) },
+    { S7COMMP_DICTID_LineComm_90000001, s7commp_dict_LineComm_90000001, sizeof(s7commp_dict_LineComm_90000001) },
+    { S7COMMP_DICTID_LineComm_98000001, s7commp_dict_LineComm_98000001, sizeof(s7commp_dict_LineComm_98000001) },
+    { S7COMMP_DICTID_IdentES_90000001, s7commp_dict_IdentES_90000001, sizeof(s7commp_dict_IdentES_90000001) },
+    { S7COMMP_DICTID_IdentES_90000002, s7commp_dict_IdentES_90000002, sizeof(s7commp_dict_IdentES_90000002) },
+    { S7COMMP_DICTID_IdentES_98000001, s7commp_dict_IdentES_98000001, sizeof(s7commp_dict_IdentES_98000001) },
+    { S7COMMP_DICTID_CompilerSettings_90000001, s7commp_dict_CompilerSettings_90000001, sizeof(s7commp_dict_CompilerSettings_90000001) },
+};
+
+static GHashTable *s7commp_blob_dict_table;
+#endif
+
 /* Header Block */
 static int hf_s7commp_header = -1;
 static int hf_s7commp_header_protid = -1;             	/* Header Byte  0 */
@@ -4807,6 +4901,9 @@ static int hf_s7commp_data_transportflags_bit7 = -1;
 static int hf_s7commp_data_function = -1;
 static int hf_s7commp_data_sessionid = -1;
 static int hf_s7commp_data_seqnum = -1;
+static int hf_s7commp_data_response_in = -1;
+static int hf_s7commp_data_response_to = -1;
+static int hf_s7commp_data_response_time = -1;
 static int hf_s7commp_objectqualifier = -1;
 
 static int ett_s7commp_data_transportflags = -1;
@@ -4915,6 +5012,8 @@ static int hf_s7commp_itemaddr_area_sub = -1;
 static int hf_s7commp_itemaddr_lid_value = -1;
 static int hf_s7commp_itemaddr_idcount = -1;
 static int hf_s7commp_itemaddr_filter_sequence = -1;
+static int hf_s7commp_itemaddr_symbol = -1;
+static int hf_s7commp_itemaddr_symbol_softdatatype = -1;
 static int hf_s7commp_itemaddr_lid_accessaid = -1;
 static int hf_s7commp_itemaddr_blob_startoffset = -1;
 static int hf_s7commp_itemaddr_blob_bytecount = -1;
@@ -5193,6 +5292,8 @@ static int hf_s7commp_setvarsubstr_req_unknown1 = -1;
 /* Notification */
 static int hf_s7commp_notification_vl_retval = -1;
 static int hf_s7commp_notification_vl_refnumber = -1;
+static int hf_s7commp_notification_vl_address = -1;
+static int hf_s7commp_notification_vl_subscribed_in = -1;
 static int hf_s7commp_notification_vl_unknown0x9c = -1;
 
 static int hf_s7commp_notification_subscrobjectid = -1;
@@ -5207,6 +5308,9 @@ static int hf_s7commp_notification_seqnum_vlq = -1;
 static int hf_s7commp_notification_seqnum_uint8 = -1;
 static int hf_s7commp_notification_subscrccnt = -1;
 static int hf_s7commp_notification_subscrccnt2 = -1;
+static int hf_s7commp_notification_prev_frame = -1;
+static int hf_s7commp_notification_delta_time = -1;
+static int hf_s7commp_notification_missing = -1;
 static int hf_s7commp_notification_p2_subscrobjectid = -1;
 static int hf_s7commp_notification_p2_unknown1 = -1;
 static int hf_s7commp_notification_timestamp = -1;
@@ -5388,12 +5492,18 @@ static int ett_s7commp_fragments = -1;
 static expert_field ei_s7commp_blobdecompression_failed = EI_INIT;
 static expert_field ei_s7commp_blobdecompression_nodictionary = EI_INIT;
 static expert_field ei_s7commp_blobdecompression_xmlsubdissector_failed = EI_INIT;
+static expert_field ei_s7commp_blobdecompression_truncated = EI_INIT;
 static expert_field ei_s7commp_integrity_digestlen_error = EI_INIT;
 static expert_field ei_s7commp_value_unknown_type = EI_INIT;
 static expert_field ei_s7commp_notification_returnvalue_unknown = EI_INIT;
+static expert_field ei_s7commp_notification_seqnum_missing = EI_INIT;
+static expert_field ei_s7commp_notification_seqnum_duplicate = EI_INIT;
+static expert_field ei_s7commp_notification_credit_limit = EI_INIT;
 static expert_field ei_s7commp_data_opcode_unknown = EI_INIT;
+static expert_field ei_s7commp_decode_limit = EI_INIT;
 
 static dissector_handle_t xml_handle;
+static int proto_xml = -1;
 static dissector_handle_t tls_handle;
 static dissector_handle_t s7commp_handle;
 
@@ -5470,24 +5580,709 @@ typedef struct {
     int remaining_len;
 } ssl_conv_state_t;
 
+/* Request/response matching:
+ * A response carries the sequence number of its request. The transactions of a connection are
+ * kept in a tree with the sequence number as key, the result of the first pass is stored in the frame.
+ */
+#define S7COMMP_PROTO_DATA_TRANS(layer) (0x40000000 | (layer))
+#define S7COMMP_PROTO_DATA_NOTIF(layer) (0x50000000 | (layer))
+
+/* Limits for the decoding of values and objects:
+ * Structs and objects can be nested without limit, and a sparsearray has no size field. The nesting depth
+ * of the current PDU and the number of values of the packet are counted, the decoding stops with an
+ * expert info when S7COMMP_DECODE_MAX_DEPTH or the preference max_values is exceeded.
+ * The counters are kept in the packet pool, they are needed only during the dissection.
+ */
+#define S7COMMP_PROTO_DATA_BUDGET       0x60000000
+#define S7COMMP_DECODE_MAX_DEPTH        64
+
+typedef struct {
+    uint32_t depth;
+    uint32_t values;
+} s7commp_decode_budget_t;
+
+/* Subscriptions:
+ * A subscription is created with a CreateObject request which contains the SubscriptionReferenceList
+ * (attribute 1048), the object id of the subscription is returned in the response. The list is modified
+ * with SetMultiVariables on the subscription object. Every subscribed item has a reference number, which
+ * the notifications use for the values of the item.
+ * As a reference number may be used again for another item after it was unsubscribed, every item
+ * keeps the frames in which it is valid.
+ */
+#define S7COMMP_ITEMADDR_SEQ_LEN        256
+typedef struct s7commp_subscr_item_s {
+    uint32_t first_frame;               /* Frame which subscribed the item */
+    uint32_t last_frame;                /* Frame which unsubscribed the item, 0 if still subscribed */
+    const char *address;                /* Item address sequence */
+    struct s7commp_subscr_item_s *prev; /* Item which used the reference number before */
+} s7commp_subscr_item_t;
+
+/* Notifications of a subscription are numbered, either by the sequence number or, if a credit limit
+ * was set on the subscription, by the credit tick. The PLC stops sending when the credit tick reaches
+ * the credit limit, until the client increments the credit.
+ * The state of the last notification is tracked in the first pass, the result for each notification
+ * is kept in s7commp_notif_info_t.
+ */
+typedef struct s7commp_subscription_s {
+    wmem_tree_t *items;                 /* s7commp_subscr_item_t, key is the reference number */
+    int32_t credit_limit;               /* Attribute SubscriptionCreditLimit, 0 if unknown, -1 if unlimited */
+    uint32_t last_notif_frame;          /* 0 if there was no notification yet */
+    nstime_t last_notif_time;
+    uint32_t last_seqnum;
+    uint8_t last_credit_tick;
+} s7commp_subscription_t;
+
+typedef struct {
+    uint32_t prev_frame;                /* Previous notification of the subscription, 0 if none */
+    nstime_t delta_time;                /* Time since the previous notification, if prev_frame */
+    uint32_t missing;                   /* Number of sequence numbers skipped */
+    bool duplicate;                     /* Same sequence number as the previous notification */
+    bool credit_limit_reached;
+    int32_t credit_limit;
+} s7commp_notif_info_t;
+
+typedef struct {
+    uint32_t req_frame;
+    uint32_t rep_frame;
+    nstime_t req_time;
+    uint16_t functioncode;
+    s7commp_subscription_t *subscription;   /* Subscription created or modified by the request */
+} s7commp_transaction_t;
+
+/* Symbols:
+ * The type information objects in Explore responses describe the variables of a DB, UDT, or area
+ * with LID, name, softdatatype and array bounds. These are kept per connection with the relation id
+ * of the type information object and the LID as key, to show the symbolic name of item addresses.
+ */
+typedef struct {
+    uint32_t lid;
+    const char *name;
+    uint32_t softdatatype;
+    uint32_t struct_relid;              /* Type information of a struct or FB instance, 0 if none */
+    const char *array_bounds;           /* e.g. "[0..9]", NULL if not an array */
+} s7commp_symbol_t;
+
+typedef struct {
+    wmem_tree_t *transactions;          /* s7commp_transaction_t, key is the sequence number */
+    wmem_tree_t *subscriptions;         /* s7commp_subscription_t, key is the subscription object id */
+    wmem_tree_t *symbols;               /* s7commp_symbol_t, key is the relation id and the LID */
+    wmem_map_t *item_addresses;         /* Item address sequences of the open requests, only collected for the
+                                         * "s7comm-plus.value" tap. wmem_array_t of strings, index is item number - 1,
+                                         * key is the s7commp_transaction_t. Freed after the response.
+                                         */
+} s7commp_conv_info_t;
+
 /* Options */
 static bool s7commp_opt_reassemble = true;
+static unsigned s7commp_opt_array_max_elements = 100;
+static unsigned s7commp_opt_max_values = 1000000;
 #ifdef HAVE_ZLIB
 static bool s7commp_opt_decompress_blobs = true;
+static unsigned s7commp_opt_blob_cache_size = 32768;        /* KiB */
+static unsigned s7commp_opt_blob_max_size = 65536;          /* KiB */
+static bool s7commp_opt_decompress_blobs_lazy = true;
 #else
 static bool s7commp_opt_decompress_blobs = false;
 #endif
 
+#ifdef HAVE_ZLIB
+/* Cache of decompressed blobs.
+ * Without it every blob is inflated again on every dissection of its frame (second pass of tshark,
+ * refiltering, selecting the packet in the GUI). The entries are kept in LRU order, the memory used
+ * is limited by the preference blob_cache_size.
+ * The tvb which is handed to the XML dissector uses the data of the entry directly. An entry which
+ * is evicted while such a tvb still exists, is freed when the last tvb is freed.
+ */
+/* The offset alone is not unique: a reassembled tvb starts at raw offset 0, so blobs of two
+ * reassembled PDUs in one frame may have the same offset and length, and with the same dictionary
+ * they also start with the same bytes. The layer number and a checksum of the data tell them apart.
+ */
+typedef struct {
+    uint32_t frame;
+    uint32_t layer;                 /* pinfo->curr_layer_num of the PDU */
+    uint32_t offset;                /* offset of the compressed data from the beginning of the (reassembled) data */
+    uint32_t length;                /* length of the compressed data */
+    uint32_t crc;                   /* crc32 of the compressed data */
+} blob_cache_key_t;
+
+typedef struct {
+    blob_cache_key_t key;
+    GList *lru_link;                /* link in s7commp_blob_cache_lru, NULL if not in the cache */
+    unsigned refcount;              /* number of tvbs using the data */
+    int retcode;                    /* zlib return code of the decompression */
+    uint32_t dict_id;               /* dictionary id (adler32) the stream requested, 0 if none */
+    bool dict_unknown;              /* the dictionary id is not known */
+    bool truncated;                 /* decompression stopped at the preference blob_max_size */
+    uint32_t length;                /* length of the decompressed data, without the terminating 0 */
+    uint8_t data[];                 /* decompressed data, 0 terminated */
+} blob_cache_entry_t;
+
+static GHashTable *s7commp_blob_cache;
+static GQueue s7commp_blob_cache_lru = G_QUEUE_INIT;
+static size_t s7commp_blob_cache_used;
+
+/* zlib stream reused for all blobs */
+static z_stream s7commp_zstream;
+static bool s7commp_zstream_initialized;
+
+static unsigned
+s7commp_blob_cache_hash(const void *k)
+{
+    const blob_cache_key_t *key = (const blob_cache_key_t *)k;
+    return (key->frame * 2654435761U) ^ (key->layer << 24) ^ key->offset ^ (key->length << 16) ^ key->crc;
+}
+
+static gboolean
+s7commp_blob_cache_equal(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(blob_cache_key_t)) == 0;
+}
+
+static void
+s7commp_blob_cache_entry_release(blob_cache_entry_t *entry)
+{
+    if (entry->lru_link == NULL && entry->refcount == 0) {
+        g_free(entry);
+    }
+}
+
+static void
+s7commp_blob_cache_evict(blob_cache_entry_t *entry)
+{
+    g_hash_table_remove(s7commp_blob_cache, &entry->key);
+    g_queue_delete_link(&s7commp_blob_cache_lru, entry->lru_link);
+    entry->lru_link = NULL;
+    s7commp_blob_cache_used -= sizeof(blob_cache_entry_t) + entry->length + 1;
+    s7commp_blob_cache_entry_release(entry);
+}
+
+/* Called when a tvb using the data of an entry is freed */
+static void
+s7commp_blob_tvb_free_cb(void *data)
+{
+    blob_cache_entry_t *entry = (blob_cache_entry_t *)((uint8_t *)data - offsetof(blob_cache_entry_t, data));
+
+    entry->refcount--;
+    s7commp_blob_cache_entry_release(entry);
+}
+
+static blob_cache_entry_t *
+s7commp_blob_cache_lookup(const blob_cache_key_t *key)
+{
+    blob_cache_entry_t *entry;
+
+    if (s7commp_blob_cache == NULL) {
+        return NULL;
+    }
+    entry = (blob_cache_entry_t *)g_hash_table_lookup(s7commp_blob_cache, key);
+    if (entry != NULL) {
+        /* most recently used to the front */
+        g_queue_unlink(&s7commp_blob_cache_lru, entry->lru_link);
+        g_queue_push_head_link(&s7commp_blob_cache_lru, entry->lru_link);
+    }
+    return entry;
+}
+
+/* Insert a new entry. If it doesn't fit into the cache, it's not inserted and released
+ * as soon as it's not used any more.
+ */
+static void
+s7commp_blob_cache_insert(blob_cache_entry_t *entry)
+{
+    size_t size = sizeof(blob_cache_entry_t) + entry->length + 1;
+    size_t max_size = (size_t)s7commp_opt_blob_cache_size * 1024;
+
+    entry->lru_link = NULL;
+    if (s7commp_blob_cache == NULL || size > max_size) {
+        return;
+    }
+    while (s7commp_blob_cache_used + size > max_size && s7commp_blob_cache_lru.tail != NULL) {
+        s7commp_blob_cache_evict((blob_cache_entry_t *)s7commp_blob_cache_lru.tail->data);
+    }
+    g_queue_push_head(&s7commp_blob_cache_lru, entry);
+    entry->lru_link = s7commp_blob_cache_lru.head;
+    g_hash_table_insert(s7commp_blob_cache, &entry->key, entry);
+    s7commp_blob_cache_used += size;
+}
+
+static void
+s7commp_blob_cache_cleanup(void)
+{
+    while (s7commp_blob_cache_lru.tail != NULL) {
+        s7commp_blob_cache_evict((blob_cache_entry_t *)s7commp_blob_cache_lru.tail->data);
+    }
+    if (s7commp_blob_cache != NULL) {
+        g_hash_table_destroy(s7commp_blob_cache);
+        s7commp_blob_cache = NULL;
+    }
+}
+
+/* Build the dictionary lookup table, once at registration */
+static void
+s7commp_blob_dict_init(void)
+{
+    unsigned i;
+
+    s7commp_blob_dict_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (i = 0; i < array_length(s7commp_blob_dicts); i++) {
+        g_hash_table_insert(s7commp_blob_dict_table, GUINT_TO_POINTER(s7commp_blob_dicts[i].id), (void *)&s7commp_blob_dicts[i]);
+    }
+}
+
+static void
+s7commp_inflate_cleanup(void)
+{
+    if (s7commp_zstream_initialized) {
+        inflateEnd(&s7commp_zstream);
+        s7commp_zstream_initialized = false;
+    }
+}
+
+static void
+s7commp_blob_cache_init(void)
+{
+    s7commp_blob_cache_cleanup();
+    s7commp_blob_cache = g_hash_table_new(s7commp_blob_cache_hash, s7commp_blob_cache_equal);
+    s7commp_blob_cache_used = 0;
+}
+#endif
+
 /* Reassembly of S7COMMP */
 static reassembly_table s7commp_reassembly_table;
 
+/* Memory accounting of the reassembly state in the file scope, logged when the file is closed */
+static struct {
+    uint32_t pdus;                      /* PDUs checked for fragmentation */
+    uint32_t frame_states;              /* frame_state_t, only for fragments */
+    uint32_t conv_states;               /* conv_state_t, one per connection and direction */
+} s7commp_reasm_memory;
+
 static void
 s7commp_defragment_init(void)
 {
     reassembly_table_init(&s7commp_reassembly_table,
                           &addresses_reassembly_table_functions);
+    memset(&s7commp_reasm_memory, 0, sizeof(s7commp_reasm_memory));
+}
+
+static void
+s7commp_defragment_cleanup(void)
+{
+    if (s7commp_reasm_memory.pdus > 0) {
+        ws_info("S7COMM-PLUS reassembly state: %u PDUs, %u fragment frame states (%zu bytes), %u conversation states (%zu bytes)",
+                s7commp_reasm_memory.pdus,
+                s7commp_reasm_memory.frame_states, s7commp_reasm_memory.frame_states * sizeof(frame_state_t),
+                s7commp_reasm_memory.conv_states, s7commp_reasm_memory.conv_states * sizeof(conv_state_t));
+    }
+}
+
+/*******************************************************************************************************
+ *
+ * Statistics: Service response time, "-z srt,s7comm-plus"
+ * One row per function code of the request. The known function codes are all in the range below,
+ * so the code is used as row index. Codes without a name are shown as hex number.
+ *
+ *******************************************************************************************************/
+#define S7COMMP_SRT_FIRST_FUNCTIONCODE          0x04b0
+#define S7COMMP_SRT_FUNCTIONCODES               0x0110      /* 0x04b0 - 0x05bf */
+#define S7COMMP_SRT_ROW_OTHER                   S7COMMP_SRT_FUNCTIONCODES
+
+static void
+s7commp_srt_init(struct register_srt *srt _U_, GArray *srt_array)
+{
+    srt_stat_table *srt_table;
+    const char *str;
+    char name[16];
+    int i;
+
+    /* No filter string, as the row index is not the function code itself */
+    srt_table = init_srt_table("S7COMM-PLUS Functions", NULL, srt_array, S7COMMP_SRT_FUNCTIONCODES + 1,
+        "Function", NULL, NULL);
+    for (i = 0; i < S7COMMP_SRT_FUNCTIONCODES; i++) {
+        str = try_val_to_str(S7COMMP_SRT_FIRST_FUNCTIONCODE + i, data_functioncode_names);
+        if (str == NULL) {
+            snprintf(name, sizeof(name), "0x%04x", S7COMMP_SRT_FIRST_FUNCTIONCODE + i);
+            str = name;
+        }
+        init_srt_table_row(srt_table, i, str);
+    }
+    init_srt_table_row(srt_table, S7COMMP_SRT_ROW_OTHER, "Other function codes");
+}
+
+static tap_packet_status
+s7commp_srt_packet(void *pss,
+                   packet_info *pinfo,
+                   epan_dissect_t *edt _U_,
+                   const void *prv,
+                   tap_flags_t flags _U_)
+{
+    srt_data_t *data = (srt_data_t *)pss;
+    const s7commp_tap_info_t *tap_info = (const s7commp_tap_info_t *)prv;
+    srt_stat_table *srt_table;
+    nstime_t req_time;
+    int row;
+
+    if (!tap_info->is_response) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    srt_table = g_array_index(data->srt_array, srt_stat_table *, 0);
+    if (tap_info->functioncode >= S7COMMP_SRT_FIRST_FUNCTIONCODE &&
+        tap_info->functioncode < S7COMMP_SRT_FIRST_FUNCTIONCODE + S7COMMP_SRT_FUNCTIONCODES) {
+        row = tap_info->functioncode - S7COMMP_SRT_FIRST_FUNCTIONCODE;
+    } else {
+        row = S7COMMP_SRT_ROW_OTHER;
+    }
+    /* The table calculates the response time from the time of the request */
+    nstime_delta(&req_time, &pinfo->abs_ts, &tap_info->resp_time);
+    add_srt_table_data(srt_table, row, &req_time, pinfo);
+    return TAP_PACKET_REDRAW;
+}
+
+/*******************************************************************************************************
+ *
+ * Statistics: Notifications, "-z s7comm-plus,notifications"
+ * The count and rate of notifications per subscription, the ratio of empty notifications, the
+ * sequence errors, and the distribution of the time between two notifications of a subscription.
+ * The percentiles of the inter-arrival time are given by "-z s7comm-plus,interarrival".
+ *
+ *******************************************************************************************************/
+static const char *st_str_s7commp_notif = "Notifications";
+static const char *st_str_s7commp_notif_content = "Notification content";
+static const char *st_str_s7commp_notif_seqerr = "Sequence errors";
+static const char *st_str_s7commp_notif_delta = "Inter-arrival time [ms]";
+static const char *st_str_s7commp_notif_delta_hist = "Inter-arrival Time Histogram [ms]";
+static int st_node_s7commp_notif = -1;
+static int st_node_s7commp_notif_content = -1;
+static int st_node_s7commp_notif_seqerr = -1;
+static int st_node_s7commp_notif_delta = -1;
+
+static void
+s7commp_notif_stats_tree_init(stats_tree *st)
+{
+    st_node_s7commp_notif = stats_tree_create_node(st, st_str_s7commp_notif, 0, STAT_DT_INT, true);
+    st_node_s7commp_notif_content = stats_tree_create_pivot(st, st_str_s7commp_notif_content, 0);
+    st_node_s7commp_notif_seqerr = stats_tree_create_node(st, st_str_s7commp_notif_seqerr, 0, STAT_DT_INT, true);
+    st_node_s7commp_notif_delta = stats_tree_create_node(st, st_str_s7commp_notif_delta, 0, STAT_DT_INT, true);
+    stats_tree_create_range_node(st, st_str_s7commp_notif_delta_hist, 0,
+        "0-10", "11-50", "51-100", "101-200", "201-500", "501-1000", "1001-2000", "2001-5000", "5001-10000", "10001-", NULL);
+}
+
+static tap_packet_status
+s7commp_notif_stats_tree_packet(stats_tree *st,
+                                packet_info *pinfo _U_,
+                                epan_dissect_t *edt _U_,
+                                const void *p,
+                                tap_flags_t flags _U_)
+{
+    const s7commp_tap_info_t *tap_info = (const s7commp_tap_info_t *)p;
+    char str[32];
+    int64_t msec;
+
+    if (tap_info->opcode != S7COMMP_OPCODE_NOTIFICATION) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    tick_stat_node(st, st_str_s7commp_notif, 0, true);
+    g_snprintf(str, sizeof(str), "Subscription 0x%08x", tap_info->subscr_object_id);
+    tick_stat_node(st, str, st_node_s7commp_notif, false);
+
+    stats_tree_tick_pivot(st, st_node_s7commp_notif_content, tap_info->notif_has_values ? "With values" : "Empty");
+
+    if (tap_info->notif_missing > 0) {
+        increase_stat_node(st, st_str_s7commp_notif_seqerr, 0, true, tap_info->notif_missing);
+        increase_stat_node(st, "Missing notifications", st_node_s7commp_notif_seqerr, false, tap_info->notif_missing);
+    }
+    if (tap_info->notif_duplicate) {
+        tick_stat_node(st, st_str_s7commp_notif_seqerr, 0, true);
+        tick_stat_node(st, "Duplicate notifications", st_node_s7commp_notif_seqerr, false);
+    }
+    if (tap_info->notif_credit_limit_reached) {
+        tick_stat_node(st, st_str_s7commp_notif_seqerr, 0, true);
+        tick_stat_node(st, "Credit limit reached", st_node_s7commp_notif_seqerr, false);
+    }
+
+    /* A negative time comes from timestamps out of order */
+    if (tap_info->notif_has_delta && tap_info->notif_delta_time.secs >= 0 && tap_info->notif_delta_time.nsecs >= 0) {
+        msec = (int64_t)tap_info->notif_delta_time.secs * 1000 + tap_info->notif_delta_time.nsecs / 1000000;
+        if (msec > G_MAXINT) {
+            msec = G_MAXINT;
+        }
+        avg_stat_node_add_value_int(st, st_str_s7commp_notif_delta, 0, true, (int)msec);
+        avg_stat_node_add_value_int(st, str, st_node_s7commp_notif_delta, false, (int)msec);
+        stats_tree_tick_range(st, st_str_s7commp_notif_delta_hist, 0, (int)msec);
+    }
+    return TAP_PACKET_REDRAW;
+}
+
+/*******************************************************************************************************
+ *
+ * Export of values, "-z s7comm-plus,values[,filename]"
+ * Writes a CSV row for every value of a GetMultiVariables, SetMultiVariables or notification,
+ * directly when the packet is dissected. Nothing is kept in memory, and the protocol tree is not
+ * needed (e.g. tshark -q -z s7comm-plus,values,values.csv). Without a filename the rows go to stdout.
+ * Columns: frame, time (seconds since epoch), plc (address of the PLC), session (conversation index),
+ * function, item (address sequence, or #number if the address is unknown), datatype, value.
+ * Array values are as displayed, limited to the first elements.
+ *
+ *******************************************************************************************************/
+typedef struct {
+    FILE *fh;
+} s7commp_values_export_t;
+
+static void
+s7commp_values_export_string(FILE *fh,
+                             const char *str)
+{
+    /* CSV quoting, a quote is doubled */
+    fputc('"', fh);
+    for (; *str != '\0'; str++) {
+        if (*str == '"') {
+            fputc('"', fh);
+        }
+        fputc(*str, fh);
+    }
+    fputc('"', fh);
+}
+
+static tap_packet_status
+s7commp_values_export_packet(void *tapdata,
+                             packet_info *pinfo,
+                             epan_dissect_t *edt _U_,
+                             const void *p,
+                             tap_flags_t flags _U_)
+{
+    s7commp_values_export_t *exp = (s7commp_values_export_t *)tapdata;
+    const s7commp_value_tap_info_t *value_info = (const s7commp_value_tap_info_t *)p;
+
+    fprintf(exp->fh, "%u,%ld.%06ld,%s,%u,",
+        pinfo->num, (long)pinfo->abs_ts.secs, (long)(pinfo->abs_ts.nsecs / 1000),
+        address_to_str(pinfo->pool, value_info->from_plc ? &pinfo->src : &pinfo->dst),
+        value_info->session);
+    if (value_info->is_notification) {
+        fprintf(exp->fh, "Notification 0x%08x,", value_info->subscr_object_id);
+    } else {
+        fprintf(exp->fh, "%s %s,", val_to_str_const(value_info->functioncode, data_functioncode_names, "Unknown"),
+            value_info->from_plc ? "Response" : "Request");
+    }
+    if (value_info->address != NULL) {
+        s7commp_values_export_string(exp->fh, value_info->address);
+    } else {
+        fprintf(exp->fh, "#%u", value_info->item_number);
+    }
+    fprintf(exp->fh, ",%s%s,", val_to_str_const(value_info->datatype, item_datatype_names, "Unknown"),
+        (value_info->datatype_flags & (S7COMMP_DATATYPE_FLAG_ARRAY | S7COMMP_DATATYPE_FLAG_ADDRESS_ARRAY | S7COMMP_DATATYPE_FLAG_SPARSEARRAY)) ? "[]" : "");
+    s7commp_values_export_string(exp->fh, value_info->value);
+    fputc('\n', exp->fh);
+    return TAP_PACKET_DONT_REDRAW;
+}
+
+static void
+s7commp_values_export_finish(void *tapdata)
+{
+    s7commp_values_export_t *exp = (s7commp_values_export_t *)tapdata;
+
+    if (exp->fh != stdout) {
+        fclose(exp->fh);
+    } else {
+        fflush(exp->fh);
+    }
+    g_free(exp);
+}
+
+static void
+s7commp_values_export_init(const char *opt_arg,
+                           void *userdata _U_)
+{
+    s7commp_values_export_t *exp;
+    GString *error_string;
+    const char *filename = NULL;
+
+    if (strncmp(opt_arg, "s7comm-plus,values,", 19) == 0 && opt_arg[19] != '\0') {
+        filename = opt_arg + 19;
+    }
+    exp = g_new0(s7commp_values_export_t, 1);
+    if (filename != NULL) {
+        exp->fh = ws_fopen(filename, "w");
+        if (exp->fh == NULL) {
+            report_open_failure(filename, errno, true);
+            g_free(exp);
+            return;
+        }
+    } else {
+        exp->fh = stdout;
+    }
+    fputs("frame,time,plc,session,function,item,datatype,value\n", exp->fh);
+
+    error_string = register_tap_listener("s7comm-plus.value", exp, NULL, TL_REQUIRES_NOTHING, NULL,
+        s7commp_values_export_packet, NULL, s7commp_values_export_finish);
+    if (error_string) {
+        report_failure("Couldn't register s7comm-plus,values tap: %s", error_string->str);
+        g_string_free(error_string, TRUE);
+        s7commp_values_export_finish(exp);
+    }
+}
+
+static stat_tap_ui s7commp_values_export_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "s7comm-plus,values",
+    s7commp_values_export_init,
+    0,
+    NULL
+};
+
+/*******************************************************************************************************
+ *
+ * Statistics: Inter-arrival time of notifications, "-z s7comm-plus,interarrival[,filter]"
+ * The stats tree has no percentiles, so the times between two notifications of a subscription are
+ * collected, and sorted when drawn. Printed per subscription: count, min, p50, p90, p99 and max in ms.
+ *
+ *******************************************************************************************************/
+typedef struct {
+    GHashTable *subscriptions;          /* GArray of the times in us (uint64_t), key is the subscription object id */
+} s7commp_interarrival_t;
+
+static void
+s7commp_interarrival_free_times(void *data)
+{
+    g_array_free((GArray *)data, true);
+}
+
+static int
+s7commp_interarrival_compare(const void *a,
+                             const void *b)
+{
+    uint64_t ua = *(const uint64_t *)a;
+    uint64_t ub = *(const uint64_t *)b;
+
+    return (ua > ub) - (ua < ub);
+}
+
+static int
+s7commp_interarrival_compare_id(const void *a,
+                                const void *b)
+{
+    unsigned ua = GPOINTER_TO_UINT(a);
+    unsigned ub = GPOINTER_TO_UINT(b);
+
+    return (ua > ub) - (ua < ub);
+}
+
+/* Nearest rank percentile of the sorted times, in ms */
+static double
+s7commp_interarrival_percentile(const GArray *times,
+                                unsigned percent)
+{
+    unsigned rank;
+
+    rank = (times->len * percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    return g_array_index(times, uint64_t, rank - 1) / 1000.0;
+}
+
+static tap_packet_status
+s7commp_interarrival_packet(void *tapdata,
+                            packet_info *pinfo _U_,
+                            epan_dissect_t *edt _U_,
+                            const void *p,
+                            tap_flags_t flags _U_)
+{
+    s7commp_interarrival_t *ia = (s7commp_interarrival_t *)tapdata;
+    const s7commp_tap_info_t *tap_info = (const s7commp_tap_info_t *)p;
+    GArray *times;
+    uint64_t usec;
+
+    /* A negative time comes from timestamps out of order */
+    if (tap_info->opcode != S7COMMP_OPCODE_NOTIFICATION || !tap_info->notif_has_delta ||
+        tap_info->notif_delta_time.secs < 0 || tap_info->notif_delta_time.nsecs < 0) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    times = (GArray *)g_hash_table_lookup(ia->subscriptions, GUINT_TO_POINTER(tap_info->subscr_object_id));
+    if (times == NULL) {
+        times = g_array_new(false, false, sizeof(uint64_t));
+        g_hash_table_insert(ia->subscriptions, GUINT_TO_POINTER(tap_info->subscr_object_id), times);
+    }
+    usec = (uint64_t)tap_info->notif_delta_time.secs * 1000000 + (uint64_t)tap_info->notif_delta_time.nsecs / 1000;
+    g_array_append_val(times, usec);
+    return TAP_PACKET_REDRAW;
+}
+
+static void
+s7commp_interarrival_draw(void *tapdata)
+{
+    s7commp_interarrival_t *ia = (s7commp_interarrival_t *)tapdata;
+    GList *subscriptions;
+    GList *entry;
+    GArray *times;
+
+    printf("\n=================================================================================\n");
+    printf("S7COMM-PLUS Notification inter-arrival time [ms]\n");
+    printf("%-12s %10s %10s %10s %10s %10s %10s\n", "Subscription", "Count", "Min", "p50", "p90", "p99", "Max");
+    subscriptions = g_list_sort(g_hash_table_get_keys(ia->subscriptions), s7commp_interarrival_compare_id);
+    for (entry = subscriptions; entry != NULL; entry = entry->next) {
+        times = (GArray *)g_hash_table_lookup(ia->subscriptions, entry->data);
+        g_array_sort(times, s7commp_interarrival_compare);
+        printf("0x%08x   %10u %10.3f %10.3f %10.3f %10.3f %10.3f\n", GPOINTER_TO_UINT(entry->data), times->len,
+            g_array_index(times, uint64_t, 0) / 1000.0,
+            s7commp_interarrival_percentile(times, 50),
+            s7commp_interarrival_percentile(times, 90),
+            s7commp_interarrival_percentile(times, 99),
+            g_array_index(times, uint64_t, times->len - 1) / 1000.0);
+    }
+    g_list_free(subscriptions);
+    printf("=================================================================================\n");
+}
+
+static void
+s7commp_interarrival_reset(void *tapdata)
+{
+    s7commp_interarrival_t *ia = (s7commp_interarrival_t *)tapdata;
+
+    g_hash_table_remove_all(ia->subscriptions);
+}
+
+static void
+s7commp_interarrival_finish(void *tapdata)
+{
+    s7commp_interarrival_t *ia = (s7commp_interarrival_t *)tapdata;
+
+    g_hash_table_destroy(ia->subscriptions);
+    g_free(ia);
+}
+
+static void
+s7commp_interarrival_init(const char *opt_arg,
+                          void *userdata _U_)
+{
+    s7commp_interarrival_t *ia;
+    GString *error_string;
+    const char *filter = NULL;
+
+    if (strncmp(opt_arg, "s7comm-plus,interarrival,", 25) == 0 && opt_arg[25] != '\0') {
+        filter = opt_arg + 25;
+    }
+    ia = g_new0(s7commp_interarrival_t, 1);
+    ia->subscriptions = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, s7commp_interarrival_free_times);
+
+    error_string = register_tap_listener("s7comm-plus", ia, filter, TL_REQUIRES_NOTHING, s7commp_interarrival_reset,
+        s7commp_interarrival_packet, s7commp_interarrival_draw, s7commp_interarrival_finish);
+    if (error_string) {
+        report_failure("Couldn't register s7comm-plus,interarrival tap: %s", error_string->str);
+        g_string_free(error_string, TRUE);
+        s7commp_interarrival_finish(ia);
+    }
 }
 
+static stat_tap_ui s7commp_interarrival_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "s7comm-plus,interarrival",
+    s7commp_interarrival_init,
+    0,
+    NULL
+};
+
 /* Register this protocol */
 void
 proto_reg_handoff_s7commp(void)
@@ -5495,101 +6290,398 @@ proto_reg_handoff_s7commp(void)
     static bool initialized = false;
     if (!initialized) {
         xml_handle = find_dissector_add_dependency("xml", proto_s7commp);
+        proto_xml = proto_get_id_by_filter_name("xml");
         tls_handle = find_dissector_add_dependency("tls", proto_s7commp);
         heur_dissector_add("cotp", dissect_s7commp_ssl, "S7 Communication Plus over COTP", "s7comm_plus_cotp", proto_s7commp, HEURISTIC_ENABLE);
+        stats_tree_register_plugin("s7comm-plus", "s7comm-plus,notifications", "S7COMM-PLUS/Notifications", 0,
+            s7commp_notif_stats_tree_packet, s7commp_notif_stats_tree_init, NULL);
         initialized = true;
     }
 }
 /*******************************************************************************************************
-* Callback function for id-name decoding
-* In der globalen ID-Liste sind nur die statischen Werte vorhanden.
-* Dynamische Werte sind z.B. DB-Nummern, Bibliotheksbaustein-Nummern, usw.
-* Diese Funktion kann als BASE_CUSTOM in den header-fields verwendet werden.
-* val_to_str() darf in der Callback function nicht verwendet werden, da es intern fuer die
-* Strings Speicher aus dem Scope wmem_packet_scope verwendet, und dieser zum Zeitpunkt
-* des Aufrufs ueber die Callback Funktion nicht gueltig ist.
-*******************************************************************************************************/
-static void
-s7commp_idname_fmt(char *result, uint32_t id_number)
+ *
+ * Get the data of the connection, create it if not available yet
+ *
+ *******************************************************************************************************/
+static s7commp_conv_info_t *
+s7commp_get_conv_info(packet_info *pinfo)
 {
-    const uint8_t *str;
+    conversation_t *conversation;
+    s7commp_conv_info_t *conv_info;
+
+    conversation = find_or_create_conversation(pinfo);
+    conv_info = (s7commp_conv_info_t *)conversation_get_proto_data(conversation, proto_s7commp);
+    if (conv_info == NULL) {
+        conv_info = wmem_new0(wmem_file_scope(), s7commp_conv_info_t);
+        conv_info->transactions = wmem_tree_new(wmem_file_scope());
+        conv_info->subscriptions = wmem_tree_new(wmem_file_scope());
+        conv_info->symbols = wmem_tree_new(wmem_file_scope());
+        conv_info->item_addresses = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+        conversation_add_proto_data(conversation, proto_s7commp, conv_info);
+    }
+    return conv_info;
+}
+/*******************************************************************************************************
+ *
+ * Get the transaction of the current request or response, NULL if there is none
+ *
+ *******************************************************************************************************/
+static s7commp_transaction_t *
+s7commp_get_transaction(packet_info *pinfo)
+{
+    return (s7commp_transaction_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_s7commp, S7COMMP_PROTO_DATA_TRANS(pinfo->curr_layer_num));
+}
+/*******************************************************************************************************
+ *
+ * Get the subscription with the object id, create it if not available yet
+ *
+ *******************************************************************************************************/
+static s7commp_subscription_t *
+s7commp_get_subscription(packet_info *pinfo,
+                         uint32_t subscr_object_id)
+{
+    s7commp_conv_info_t *conv_info;
+    s7commp_subscription_t *sub;
+
+    conv_info = s7commp_get_conv_info(pinfo);
+    sub = (s7commp_subscription_t *)wmem_tree_lookup32(conv_info->subscriptions, subscr_object_id);
+    if (sub == NULL) {
+        sub = wmem_new0(wmem_file_scope(), s7commp_subscription_t);
+        sub->items = wmem_tree_new(wmem_file_scope());
+        wmem_tree_insert32(conv_info->subscriptions, subscr_object_id, (void *)sub);
+    }
+    return sub;
+}
+/*******************************************************************************************************
+ *
+ * Remember the address of the next item of the current request, to export the values of
+ * the request and its response together with the address.
+ * Only done in the first pass and when the "s7comm-plus.value" tap has a listener. The addresses
+ * are freed after the response was dissected, so they are available in this pass only.
+ *
+ *******************************************************************************************************/
+static void
+s7commp_add_trans_item_address(packet_info *pinfo,
+                               const char *addr_seq)
+{
+    s7commp_transaction_t *trans;
+    s7commp_conv_info_t *conv_info;
+    wmem_array_t *addresses;
+    const char *address;
+
+    if (pinfo->fd->visited || !have_tap_listener(s7commp_value_tap) ||
+        (trans = s7commp_get_transaction(pinfo)) == NULL || trans->req_frame != pinfo->num) {
+        return;
+    }
+    conv_info = s7commp_get_conv_info(pinfo);
+    addresses = (wmem_array_t *)wmem_map_lookup(conv_info->item_addresses, trans);
+    if (addresses == NULL) {
+        addresses = wmem_array_new(wmem_file_scope(), sizeof(const char *));
+        wmem_map_insert(conv_info->item_addresses, trans, addresses);
+    }
+    address = wmem_strdup(wmem_file_scope(), addr_seq);
+    wmem_array_append_one(addresses, address);
+}
+/*******************************************************************************************************
+ *
+ * Free the item addresses of a transaction, when the packet with its response is done
+ *
+ *******************************************************************************************************/
+typedef struct {
+    s7commp_conv_info_t *conv_info;
+    s7commp_transaction_t *trans;
+} s7commp_item_addresses_ref_t;
+
+static bool
+s7commp_free_trans_item_addresses(wmem_allocator_t *allocator _U_,
+                                  wmem_cb_event_t event _U_,
+                                  void *user_data)
+{
+    s7commp_item_addresses_ref_t *ref = (s7commp_item_addresses_ref_t *)user_data;
+    wmem_array_t *addresses;
+    unsigned i;
+
+    addresses = (wmem_array_t *)wmem_map_remove(ref->conv_info->item_addresses, ref->trans);
+    if (addresses != NULL) {
+        for (i = 0; i < wmem_array_get_count(addresses); i++) {
+            wmem_free(wmem_file_scope(), *(char **)wmem_array_index(addresses, i));
+        }
+        wmem_destroy_array(addresses);
+    }
+    /* only called once */
+    return false;
+}
+
+static void
+s7commp_release_trans_item_addresses(packet_info *pinfo,
+                                     s7commp_conv_info_t *conv_info,
+                                     s7commp_transaction_t *trans)
+{
+    s7commp_item_addresses_ref_t *ref;
+
+    if (wmem_map_lookup(conv_info->item_addresses, trans) == NULL) {
+        return;
+    }
+    ref = wmem_new(pinfo->pool, s7commp_item_addresses_ref_t);
+    ref->conv_info = conv_info;
+    ref->trans = trans;
+    wmem_register_callback(pinfo->pool, s7commp_free_trans_item_addresses, ref);
+}
+/*******************************************************************************************************
+ *
+ * Get the address of the item number in the request of the current transaction, NULL if unknown
+ *
+ *******************************************************************************************************/
+static const char *
+s7commp_get_trans_item_address(packet_info *pinfo,
+                               uint32_t item_number)
+{
+    s7commp_transaction_t *trans;
+    wmem_array_t *addresses;
+
+    if ((trans = s7commp_get_transaction(pinfo)) == NULL) {
+        return NULL;
+    }
+    addresses = (wmem_array_t *)wmem_map_lookup(s7commp_get_conv_info(pinfo)->item_addresses, trans);
+    if (addresses == NULL || item_number == 0 || item_number > wmem_array_get_count(addresses)) {
+        return NULL;
+    }
+    return *(const char **)wmem_array_index(addresses, item_number - 1);
+}
+/*******************************************************************************************************
+ *
+ * Get the subscription which is created or modified by the current request, NULL if it is not a
+ * request or not the first pass. On CreateObject the subscription gets its object id with the response.
+ *
+ *******************************************************************************************************/
+static s7commp_subscription_t *
+s7commp_get_trans_subscription(packet_info *pinfo)
+{
+    s7commp_transaction_t *trans;
+
+    if (pinfo->fd->visited || (trans = s7commp_get_transaction(pinfo)) == NULL || trans->req_frame != pinfo->num) {
+        return NULL;
+    }
+    if (trans->subscription == NULL) {
+        trans->subscription = wmem_new0(wmem_file_scope(), s7commp_subscription_t);
+        trans->subscription->items = wmem_tree_new(wmem_file_scope());
+    }
+    return trans->subscription;
+}
+/*******************************************************************************************************
+ *
+ * Get the item which was subscribed with the reference number at the time of the current frame
+ *
+ *******************************************************************************************************/
+static const s7commp_subscr_item_t *
+s7commp_lookup_subscr_item(packet_info *pinfo,
+                           uint32_t subscr_object_id,
+                           uint32_t refnumber)
+{
+    s7commp_subscription_t *sub;
+    s7commp_subscr_item_t *item;
+
+    sub = (s7commp_subscription_t *)wmem_tree_lookup32(s7commp_get_conv_info(pinfo)->subscriptions, subscr_object_id);
+    if (sub == NULL) {
+        return NULL;
+    }
+    for (item = (s7commp_subscr_item_t *)wmem_tree_lookup32(sub->items, refnumber); item != NULL; item = item->prev) {
+        if (item->first_frame <= pinfo->num && (item->last_frame == 0 || pinfo->num < item->last_frame)) {
+            return item;
+        }
+    }
+    return NULL;
+}
+/*******************************************************************************************************
+ *
+ * Symbol table: add a symbol of the type information object relid
+ *
+ *******************************************************************************************************/
+static void
+s7commp_add_symbol(packet_info *pinfo,
+                   uint32_t relid,
+                   const s7commp_symbol_t *symbol,
+                   const char *name)
+{
+    s7commp_symbol_t *sym;
+    wmem_tree_key_t key[3];
+    uint32_t lid = symbol->lid;
+
+    sym = wmem_new(wmem_file_scope(), s7commp_symbol_t);
+    sym->lid = symbol->lid;
+    sym->name = wmem_strdup(wmem_file_scope(), name);
+    sym->softdatatype = symbol->softdatatype;
+    sym->struct_relid = symbol->struct_relid;
+    sym->array_bounds = symbol->array_bounds ? wmem_strdup(wmem_file_scope(), symbol->array_bounds) : NULL;
+
+    key[0].length = 1;
+    key[0].key = &relid;
+    key[1].length = 1;
+    key[1].key = &lid;
+    key[2].length = 0;
+    key[2].key = NULL;
+    wmem_tree_insert32_array(s7commp_get_conv_info(pinfo)->symbols, key, sym);
+}
+/*******************************************************************************************************
+ *
+ * Symbol table: get the symbol with the LID in the type information object relid, NULL if unknown
+ *
+ *******************************************************************************************************/
+static const s7commp_symbol_t *
+s7commp_lookup_symbol(packet_info *pinfo,
+                      uint32_t relid,
+                      uint32_t lid)
+{
+    wmem_tree_key_t key[3];
+
+    key[0].length = 1;
+    key[0].key = &relid;
+    key[1].length = 1;
+    key[1].key = &lid;
+    key[2].length = 0;
+    key[2].key = NULL;
+    return (const s7commp_symbol_t *)wmem_tree_lookup32_array(s7commp_get_conv_info(pinfo)->symbols, key);
+}
+/*******************************************************************************************************
+ *
+ * Symbol table: add the symbols of a VartypeList and a VarnameList, which describe the variables
+ * in the same order.
+ *
+ *******************************************************************************************************/
+static void
+s7commp_add_symbol_lists(packet_info *pinfo,
+                         uint32_t relid,
+                         wmem_array_t *types,
+                         wmem_array_t *names)
+{
+    unsigned count;
+    unsigned i;
+
+    count = MIN(wmem_array_get_count(types), wmem_array_get_count(names));
+    for (i = 0; i < count; i++) {
+        s7commp_add_symbol(pinfo, relid, (const s7commp_symbol_t *)wmem_array_index(types, i),
+                           *(const char **)wmem_array_index(names, i));
+    }
+}
+/*******************************************************************************************************
+ *
+ * Symbol table: relation id of the type information object of an access area,
+ * 0 if there is none (then there are no symbols)
+ *
+ *******************************************************************************************************/
+static uint32_t
+s7commp_get_area_typeinfo_relid(uint32_t id_value)
+{
+    if ((id_value >= 0x8a0e0000) && (id_value <= 0x8a0effff)) {
+        return 0x92000000 | (id_value & 0xffff);      /* TI_DB.<number>.0 */
+    }
+    switch (id_value) {
+        case 80:
+            return 0x90000000 | (S7COMMP_EXPLORE_CLASS_IQMCT_INPUT << 16);
+        case 81:
+            return 0x90000000 | (S7COMMP_EXPLORE_CLASS_IQMCT_OUTPUT << 16);
+        case 82:
+            return 0x90000000 | (S7COMMP_EXPLORE_CLASS_IQMCT_BITMEM << 16);
+        case 83:
+            return 0x90000000 | (S7COMMP_EXPLORE_CLASS_IQMCT_COUNTER << 16);
+        case 84:
+            return 0x90000000 | (S7COMMP_EXPLORE_CLASS_IQMCT_TIMER << 16);
+    }
+    return 0;
+}
+/* Cache of the names of dynamic IDs.
+ * An explore response contains the same DB, FB and type info IDs many times. The names are only
+ * derived from the ID, so the entries never become invalid. Direct mapped, an entry is simply replaced.
+ */
+#define S7COMMP_IDNAME_CACHE_BITS       8
+
+typedef struct {
+    uint32_t id_number;
+    char name[48];                      /* Empty if the entry is not used */
+} s7commp_idname_cache_entry_t;
+
+static s7commp_idname_cache_entry_t s7commp_idname_cache[1 << S7COMMP_IDNAME_CACHE_BITS];
+/*******************************************************************************************************
+* Callback function for id-name decoding
+* In der globalen ID-Liste sind nur die statischen Werte vorhanden.
+* Dynamische Werte sind z.B. DB-Nummern, Bibliotheksbaustein-Nummern, usw.
+* Diese Funktion kann als BASE_CUSTOM in den header-fields verwendet werden.
+* val_to_str() darf in der Callback function nicht verwendet werden, da es intern fuer die
+* Strings Speicher aus dem Scope wmem_packet_scope verwendet, und dieser zum Zeitpunkt
+* des Aufrufs ueber die Callback Funktion nicht gueltig ist.
+*******************************************************************************************************/
+static void
+s7commp_idname_fmt(char *result, uint32_t id_number)
+{
+    const uint8_t *str;
+    const s7commp_idrange_t *range = NULL;
+    s7commp_idname_cache_entry_t *entry;
     uint32_t section;
     uint32_t xindex;
+    size_t lo, hi, mid;
 
     if ((str = try_val_to_str_ext(id_number, &id_number_names_ext))) {
         g_snprintf(result, ITEM_LABEL_LENGTH, "%s", str);
+        return;
+    }
+    entry = &s7commp_idname_cache[(id_number * 2654435761U) >> (32 - S7COMMP_IDNAME_CACHE_BITS)];
+    if (entry->name[0] != '\0' && entry->id_number == id_number) {
+        g_strlcpy(result, entry->name, ITEM_LABEL_LENGTH);
+        return;
+    }
+
+    lo = 0;
+    hi = G_N_ELEMENTS(s7commp_idranges);
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (id_number < s7commp_idranges[mid].first) {
+            hi = mid;
+        } else if (id_number > s7commp_idranges[mid].last) {
+            lo = mid + 1;
+        } else {
+            range = &s7commp_idranges[mid];
+            break;
+        }
+    }
+
+    xindex = ((id_number & 0x00ff0000) >> 16);
+    section = (id_number & 0xffff);
+    if (range == NULL) {                                                    /* Komplett unbekannt */
+        g_snprintf(result, ITEM_LABEL_LENGTH, "Unknown (%u)", id_number);
     } else {
-        xindex = ((id_number & 0x00ff0000) >> 16);
-        section = (id_number & 0xffff);
-
-        if (id_number >= 0x70000000 && id_number <= 0x7fffffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "DynObjX7.%u.%u", xindex, section);  /* Fuer variable Aufgaben wie zyklische Lesedienste */
-        } else if (id_number >= 0x10000000 && id_number <= 0x1fffffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "DynObjX1.%u.%u", xindex, section);  /* Fuer variable Aufgaben wie zyklische Lesedienste, aber 1200 mit FW <=2  */
-        } else if (id_number >= 0x89fd0000 && id_number <= 0x89fdffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "UDT.%u", section);
-        } else if (id_number >= 0x8a0e0000 && id_number <= 0x8a0effff) {    /* Datenbaustein mit Nummer, 8a0e.... wird aber auch als AlarmID verwendet */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "DB.%u", section);
-        } else if (id_number >= 0x8a110000 && id_number <= 0x8a11ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "UserConstants.%u", section);
-        } else if (id_number >= 0x8a120000 && id_number <= 0x8a12ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "FB.%u", section);
-        } else if (id_number >= 0x8a130000 && id_number <= 0x8a13ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "FC.%u", section);
-        } else if (id_number >= 0x8a200000 && id_number <= 0x8a20ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "S_FB.%u", section);
-        } else if (id_number >= 0x8a210000 && id_number <= 0x8a21ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "S_FC.%u", section);
-        } else if (id_number >= 0x8a240000 && id_number <= 0x8a24ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "S_UDT.%u", section);
-        } else if (id_number >= 0x8a320000 && id_number <= 0x8a32ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "OB.%u", section);
-        } else if (id_number >= 0x8a360000 && id_number <= 0x8a36ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "AlarmTextList.%u", section);
-        } else if (id_number >= 0x8a370000 && id_number <= 0x8a37ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TextList.%u", section);
-        } else if (id_number >= 0x8a380000 && id_number <= 0x8a38ffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TextContainer.%u", section);
-        } else if (id_number >= 0x8a7e0000 && id_number <= 0x8a7effff) {    /* AS Alarms */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "ASAlarms.%u", section);
-        } else if (id_number >= 0x90000000 && id_number <= 0x90ffffff) {    /* TypeInfo Bereich IQMCT, wofuer hier section steht ist nicht bekannt, bisher immer 0 gesehen. */
-            str = try_val_to_str(xindex, explore_class_iqmct_names);
-            if (str) {
-                g_snprintf(result, ITEM_LABEL_LENGTH, "TI_%s.%u", str, section);
-            } else {
-                g_snprintf(result, ITEM_LABEL_LENGTH, "TI_IQMCT.unknown.%u.%u", xindex, section);
-            }
-        } else if (id_number >= 0x91000000 && id_number <= 0x91ffffff) {    /* TypeInfo Bereich im UDT */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_UDT.%u.%u", section, xindex);
-        } else if (id_number >= 0x92000000 && id_number <= 0x92ffffff) {    /* TypeInfo Bereich im DB */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_DB.%u.%u", section, xindex);
-        } else if (id_number >= 0x93000000 && id_number <= 0x93ffffff) {    /* TypeInfo Bereich im FB */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_FB.%u.%u", section, xindex);
-        } else if (id_number >= 0x94000000 && id_number <= 0x94ffffff) {    /* TypeInfo Bereich im FC */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_FC.%u.%u", section, xindex);
-        } else if (id_number >= 0x95000000 && id_number <= 0x95ffffff) {    /* TypeInfo Bereich im OB */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_OB.%u.%u", section, xindex);
-        } else if (id_number >= 0x96000000 && id_number <= 0x96ffffff) {    /* TypeInfo Bereich im FBT */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_FBT.%u.%u", section, xindex);
-        } else if (id_number >= 0x9a000000 && id_number <= 0x9affffff) {    /* Struct-Array in einem DB */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_StructArrayDB.%u.%u", section, xindex);
-        } else if (id_number >= 0x9eae0000 && id_number <= 0x9eaeffff) {    /* Haengt auch mit dem Alarmsystem zusammen??? TODO */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "?UnknownAlarms?.%u", section);
-        } else if (id_number >= 0x020a0000 && id_number <= 0x020affff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_STRING_%u", section);  /* String with length e.g. String[10] -> TI_STRING_10, used in alarm associated values */
-        } else if (id_number >= 0x020b0000 && id_number <= 0x020bffff) {
-            g_snprintf(result, ITEM_LABEL_LENGTH, "TI_WSTRING_%u", section); /* WString with length e.g. WString[10] -> TI_WSTRING_10, used in alarm associated values */
-        } else if (id_number >= 0x02000000 && id_number <= 0x02ffffff) {     /* Explore Bereich LIB */
-            str = try_val_to_str(xindex, explore_class_lib_names);
-            if (str) {
-                g_snprintf(result, ITEM_LABEL_LENGTH, "TI_LIB.%s.%u", str, section);
-            } else {
-                g_snprintf(result, ITEM_LABEL_LENGTH, "TI_Unknown.%u.%u", xindex, section);
-            }
-        } else {                                                            /* Komplett unbekannt */
-            g_snprintf(result, ITEM_LABEL_LENGTH, "Unknown (%u)", id_number);
+        switch (range->format) {
+            case S7COMMP_IDRANGE_SECTION:
+                g_snprintf(result, ITEM_LABEL_LENGTH, "%s%u", range->prefix, section);
+                break;
+            case S7COMMP_IDRANGE_XINDEX_SECTION:
+                g_snprintf(result, ITEM_LABEL_LENGTH, "%s%u.%u", range->prefix, xindex, section);
+                break;
+            case S7COMMP_IDRANGE_SECTION_XINDEX:
+                g_snprintf(result, ITEM_LABEL_LENGTH, "%s%u.%u", range->prefix, section, xindex);
+                break;
+            case S7COMMP_IDRANGE_IQMCT:
+                str = try_val_to_str(xindex, explore_class_iqmct_names);
+                if (str) {
+                    g_snprintf(result, ITEM_LABEL_LENGTH, "TI_%s.%u", str, section);
+                } else {
+                    g_snprintf(result, ITEM_LABEL_LENGTH, "TI_IQMCT.unknown.%u.%u", xindex, section);
+                }
+                break;
+            case S7COMMP_IDRANGE_LIB:
+                str = try_val_to_str(xindex, explore_class_lib_names);
+                if (str) {
+                    g_snprintf(result, ITEM_LABEL_LENGTH, "TI_LIB.%s.%u", str, section);
+                } else {
+                    g_snprintf(result, ITEM_LABEL_LENGTH, "TI_Unknown.%u.%u", xindex, section);
+                }
+                break;
         }
     }
+    if (g_strlcpy(entry->name, result, sizeof(entry->name)) < sizeof(entry->name)) {
+        entry->id_number = id_number;
+    } else {
+        entry->name[0] = '\0';
+    }
 }
 /*******************************************************************************************************/
 void
@@ -5661,6 +6753,15 @@ proto_register_s7commp (void)
         { &hf_s7commp_data_seqnum,
           { "Sequence number", "s7comm-plus.data.seqnum", FT_UINT16, BASE_DEC, NULL, 0x0,
             "Sequence number (for reference)", HFILL }},
+        { &hf_s7commp_data_response_in,
+          { "Response In", "s7comm-plus.data.response_in", FT_FRAMENUM, BASE_NONE, FRAMENUM_TYPE(FT_FRAMENUM_RESPONSE), 0x0,
+            "The response to this request is in this frame", HFILL }},
+        { &hf_s7commp_data_response_to,
+          { "Response To", "s7comm-plus.data.response_to", FT_FRAMENUM, BASE_NONE, FRAMENUM_TYPE(FT_FRAMENUM_REQUEST), 0x0,
+            "This is a response to the request in this frame", HFILL }},
+        { &hf_s7commp_data_response_time,
+          { "Response Time", "s7comm-plus.data.response_time", FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+            "The time between the request and the response", HFILL }},
         { &hf_s7commp_data_transportflags,
           { "Transport flags", "s7comm-plus.data.transportflags", FT_UINT8, BASE_HEX, NULL, 0x0,
             NULL, HFILL }},
@@ -5756,6 +6857,12 @@ proto_register_s7commp (void)
         { &hf_s7commp_itemaddr_filter_sequence,
           { "Item address sequence", "s7comm-plus.item.addr.address_filter_sequence", FT_STRING, BASE_NONE, NULL, 0x0,
             "Combined string of all access relevant parts. Can be used as a filter", HFILL }},
+        { &hf_s7commp_itemaddr_symbol,
+          { "Symbol", "s7comm-plus.item.addr.symbol", FT_STRING, BASE_NONE, NULL, 0x0,
+            "Symbolic name of the LIDs, from the type information of a previous Explore", HFILL }},
+        { &hf_s7commp_itemaddr_symbol_softdatatype,
+          { "Symbol SoftDataType", "s7comm-plus.item.addr.symbol_softdatatype", FT_UINT32, BASE_DEC | BASE_EXT_STRING, &tagdescr_softdatatype_names_ext, 0x0,
+            "SoftDataType of the symbol, from the type information of a previous Explore", HFILL }},
         { &hf_s7commp_itemaddr_lid_accessaid,
           { "LID-access Aid", "s7comm-plus.item.addr.lid_accessaid", FT_UINT32, BASE_DEC, VALS(lid_access_aid_names), 0x0,
             NULL, HFILL }},
@@ -6455,6 +7562,12 @@ proto_register_s7commp (void)
         { &hf_s7commp_notification_vl_unknown0x9c,
           { "Unknown value after value 0x9c", "s7comm-plus.notification.vl.refnumber", FT_UINT32, BASE_HEX, NULL, 0x0,
             NULL, HFILL }},
+        { &hf_s7commp_notification_vl_address,
+          { "Subscribed item address", "s7comm-plus.notification.vl.address", FT_STRING, BASE_NONE, NULL, 0x0,
+            "Item address sequence of the item subscribed with this reference number", HFILL }},
+        { &hf_s7commp_notification_vl_subscribed_in,
+          { "Subscribed in", "s7comm-plus.notification.vl.subscribed_in", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+            "The item was subscribed in this frame", HFILL }},
         { &hf_s7commp_notification_subscrobjectid,
           { "Subscription Object Id", "s7comm-plus.notification.subscrobjectid", FT_UINT32, BASE_HEX, NULL, 0x0,
             NULL, HFILL }},
@@ -6491,6 +7604,15 @@ proto_register_s7commp (void)
         { &hf_s7commp_notification_subscrccnt2,
           { "Add-1 Notification subscription change counter", "s7comm-plus.notification.subscriptionchangecnt2", FT_UINT8, BASE_DEC, NULL, 0x0,
             NULL, HFILL }},
+        { &hf_s7commp_notification_prev_frame,
+          { "Previous notification in frame", "s7comm-plus.notification.prev_frame", FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+            "The previous notification of this subscription is in this frame", HFILL }},
+        { &hf_s7commp_notification_delta_time,
+          { "Time since previous notification", "s7comm-plus.notification.delta_time", FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+            "The time since the previous notification of this subscription", HFILL }},
+        { &hf_s7commp_notification_missing,
+          { "Missing notifications", "s7comm-plus.notification.missing", FT_UINT32, BASE_DEC, NULL, 0x0,
+            "Number of notifications missing before this one, from the sequence number", HFILL }},
         { &hf_s7commp_notification_timestamp,
           { "Add-1 Notification timestamp", "s7comm-plus.notification.timestamp", FT_ABSOLUTE_TIME, ABSOLUTE_TIME_UTC, NULL, 0x0,
             NULL, HFILL }},
@@ -6796,14 +7918,24 @@ proto_register_s7commp (void)
           { "s7comm-plus.blobdecompression.xmlsubdissector.failed", PI_UNDECODED, PI_WARN, "Blob decompression XML subdissector failed", EXPFILL }},
         { &ei_s7commp_blobdecompression_failed,
           { "s7comm-plus.blobdecompression.failed", PI_UNDECODED, PI_WARN, "Blob decompression failed", EXPFILL }},
+        { &ei_s7commp_blobdecompression_truncated,
+          { "s7comm-plus.blobdecompression.truncated", PI_UNDECODED, PI_NOTE, "Blob decompression truncated", EXPFILL }},
         { &ei_s7commp_integrity_digestlen_error,
           { "s7comm-plus.integrity.digestlen.error", PI_PROTOCOL, PI_WARN, "Integrity digest length not 32", EXPFILL }},
         { &ei_s7commp_value_unknown_type,
           { "s7comm-plus.item.val.unknowntype_error", PI_UNDECODED, PI_WARN, "Unknown value datatype", EXPFILL }},
         { &ei_s7commp_notification_returnvalue_unknown,
           { "s7comm-plus.notification.vl.retval.unknown_error", PI_UNDECODED, PI_WARN, "Notification unknown return value", EXPFILL }},
+        { &ei_s7commp_notification_seqnum_missing,
+          { "s7comm-plus.notification.seqnum.missing", PI_SEQUENCE, PI_WARN, "Notifications missing", EXPFILL }},
+        { &ei_s7commp_notification_seqnum_duplicate,
+          { "s7comm-plus.notification.seqnum.duplicate", PI_SEQUENCE, PI_WARN, "Duplicate notification", EXPFILL }},
+        { &ei_s7commp_notification_credit_limit,
+          { "s7comm-plus.notification.credit_limit", PI_SEQUENCE, PI_NOTE, "Notification credit limit reached", EXPFILL }},
         { &ei_s7commp_data_opcode_unknown,
-          { "s7comm-plus.data.opcode.unknown_error", PI_UNDECODED, PI_WARN, "Unknown Opcode", EXPFILL }}
+          { "s7comm-plus.data.opcode.unknown_error", PI_UNDECODED, PI_WARN, "Unknown Opcode", EXPFILL }},
+        { &ei_s7commp_decode_limit,
+          { "s7comm-plus.decode_limit", PI_MALFORMED, PI_ERROR, "Decoding limit exceeded", EXPFILL }}
     };
 
     static int *ett[] = {
@@ -6864,6 +7996,12 @@ proto_register_s7commp (void)
     expert_s7commp = expert_register_protocol(proto_s7commp);
     expert_register_field_array(expert_s7commp, ei, array_length(ei));
 
+    s7commp_tap = register_tap("s7comm-plus");
+    s7commp_value_tap = register_tap("s7comm-plus.value");
+    register_srt_table(proto_s7commp, NULL, 1, s7commp_srt_packet, s7commp_srt_init, NULL);
+    register_stat_tap_ui(&s7commp_values_export_ui, NULL);
+    register_stat_tap_ui(&s7commp_interarrival_ui, NULL);
+
     s7commp_module = prefs_register_protocol(proto_s7commp, NULL);
 
     prefs_register_bool_preference(s7commp_module, "reassemble",
@@ -6872,13 +8010,48 @@ proto_register_s7commp (void)
                                    "reassembled.",
                                    &s7commp_opt_reassemble);
 
+    prefs_register_uint_preference(s7commp_module, "array_max_elements",
+                                   "Maximum number of array elements in the tree",
+                                   "Array elements after this number are skipped and not added to the tree, "
+                                   "so they can't be used in filters. 0 shows all elements.",
+                                   10, &s7commp_opt_array_max_elements);
+    prefs_register_uint_preference(s7commp_module, "max_values",
+                                   "Maximum number of values per packet",
+                                   "The decoding of a packet stops with an error when it contains more values than this. "
+                                   "Protects against malformed packets which take a long time to decode. 0 means no limit.",
+                                   10, &s7commp_opt_max_values);
     prefs_register_bool_preference(s7commp_module, "decompress_blobs",
                                    "Uncompress S7COMM-PLUS blobs",
                                    "Whether to uncompress S7COMM-PLUS blobs ",
                                    &s7commp_opt_decompress_blobs);
+#ifdef HAVE_ZLIB
+    prefs_register_uint_preference(s7commp_module, "blob_cache_size",
+                                   "Memory for decompressed blobs (KiB)",
+                                   "Decompressed blobs are kept in memory up to this size, so that they "
+                                   "are not decompressed again on every dissection of the packet. "
+                                   "0 disables the cache.",
+                                   10, &s7commp_opt_blob_cache_size);
+    prefs_register_uint_preference(s7commp_module, "blob_max_size",
+                                   "Maximum size of a decompressed blob (KiB)",
+                                   "Decompression of a blob stops when the decompressed data reaches this size, "
+                                   "the rest of the blob is not shown. 0 means no limit.",
+                                   10, &s7commp_opt_blob_max_size);
+    prefs_register_bool_preference(s7commp_module, "decompress_blobs_lazy",
+                                   "Uncompress S7COMM-PLUS blobs only when displayed",
+                                   "Whether blobs are only uncompressed when the packet details are built, "
+                                   "or a filter uses XML fields. Otherwise all blobs are uncompressed in the first pass.",
+                                   &s7commp_opt_decompress_blobs_lazy);
+#endif
 
     /* Register the init routine. */
     register_init_routine(s7commp_defragment_init);
+    register_cleanup_routine(s7commp_defragment_cleanup);
+#ifdef HAVE_ZLIB
+    register_init_routine(s7commp_blob_cache_init);
+    register_cleanup_routine(s7commp_blob_cache_cleanup);
+    register_cleanup_routine(s7commp_inflate_cleanup);
+    s7commp_blob_dict_init();
+#endif
 }
 
 
@@ -6916,17 +8089,8 @@ proto_tree_add_text(proto_tree *tree, tvbuff_t *tvb, int start, int length, cons
 static void
 s7commp_proto_item_append_idname(proto_tree *tree, uint32_t id_number, char *str_prefix)
 {
-    char *result;
+    char result[ITEM_LABEL_LENGTH];
 
-    result = (char *)wmem_alloc(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-        WMEM_ALLOCATOR_SIMPLE
-#else
-        wmem_packet_scope()
-#endif
-        , ITEM_LABEL_LENGTH);
     s7commp_idname_fmt(result, id_number);
     if (str_prefix) {
         proto_item_append_text(tree, "%s%s", str_prefix, result);
@@ -6942,17 +8106,8 @@ s7commp_proto_item_append_idname(proto_tree *tree, uint32_t id_number, char *str
 static void
 s7commp_pinfo_append_idname(packet_info *pinfo, uint32_t id_number, char *str_prefix)
 {
-    char *result;
+    char result[ITEM_LABEL_LENGTH];
 
-    result = (char *)wmem_alloc(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-        WMEM_ALLOCATOR_SIMPLE
-#else
-        wmem_packet_scope()
-#endif
-        , ITEM_LABEL_LENGTH);
     s7commp_idname_fmt(result, id_number);
     if (str_prefix) {
         col_append_fstr(pinfo->cinfo, COL_INFO, "%s%s", str_prefix, result);
@@ -6964,115 +8119,226 @@ s7commp_pinfo_append_idname(packet_info *pinfo, uint32_t id_number, char *str_pr
  * Variable length quantity decode funtcions
  * (http://en.wikipedia.org/wiki/Variable-length_quantity)
  *
+ * The tvb_get_varxxx functions get a pointer to the data once, and decode from there. A VLQ which
+ * is truncated throws the same exception as reading it byte by byte with tvb_get_uint8().
+ *
  * TODO: Can this be replaced with tvb_get_varint() from proto.c?
  *******************************************************************************************************/
+#define S7COMMP_VLQ32_MAX_LEN       5
+#define S7COMMP_VLQ64_MAX_LEN       9
+
+/* Gets a pointer to at most max_len bytes at offset, returns the number of bytes available */
+static int
+s7commp_vlq_get_ptr(tvbuff_t *tvb, uint32_t offset, int max_len, const uint8_t **ptr)
+{
+    int len;
+
+    len = tvb_captured_length_remaining(tvb, offset);
+    if (len <= 0) {
+        tvb_get_uint8(tvb, offset);     /* throws */
+        len = 0;
+    }
+    if (len > max_len) {
+        len = max_len;
+    }
+    *ptr = tvb_get_ptr(tvb, offset, len);
+    return len;
+}
+/*******************************************************************************************************/
+/* Decodes a VLQ of max. 32 bits from the len bytes at ptr.
+ * Returns the number of octets, or 0 if the VLQ doesn't end within len.
+ * As before, 5 octets with the continuation bit set give a count of 6.
+ */
+static inline int
+s7commp_vlq_decode32(const uint8_t *ptr, int len, bool is_signed, uint32_t *value)
+{
+    uint32_t val;
+    int i;
+
+    if (len <= 0) {
+        return 0;
+    }
+    if (is_signed && (ptr[0] & 0x40)) {     /* check sign */
+        val = 0xffffffc0 | (ptr[0] & 0x3f); /* pre-load with one complement, excluding first 6 bits */
+    } else {
+        val = ptr[0] & 0x7f;
+    }
+    for (i = 1; (ptr[i - 1] & 0x80) && i < len; i++) {
+        val = (val << 7) | (ptr[i] & 0x7f);
+    }
+    *value = val;
+    if ((ptr[i - 1] & 0x80) == 0) {
+        return i;
+    }
+    return (i == S7COMMP_VLQ32_MAX_LEN) ? S7COMMP_VLQ32_MAX_LEN + 1 : 0;
+}
+/*******************************************************************************************************/
+/* Decodes a VLQ of max. 64 bits from the len bytes at ptr.
+ * Returns the number of octets, or 0 if the VLQ doesn't end within len.
+ * 8*7 bit + 8 bit = 64 bit -> all 8 bits of the 9th octet are used.
+ */
+static inline int
+s7commp_vlq_decode64(const uint8_t *ptr, int len, bool is_signed, uint64_t *value)
+{
+    uint64_t val;
+    int i;
+
+    if (len <= 0) {
+        return 0;
+    }
+    if (is_signed && (ptr[0] & 0x40)) {     /* check sign */
+        val = 0xffffffffffffffc0 | (ptr[0] & 0x3f);
+    } else {
+        val = ptr[0] & 0x7f;
+    }
+    for (i = 1; (ptr[i - 1] & 0x80) && i < len && i < 8; i++) {
+        val = (val << 7) | (ptr[i] & 0x7f);
+    }
+    if ((ptr[i - 1] & 0x80) == 0) {
+        *value = val;
+        return i;
+    }
+    if (i == 8 && len == S7COMMP_VLQ64_MAX_LEN) {
+        *value = (val << 8) | ptr[8];
+        return S7COMMP_VLQ64_MAX_LEN;
+    }
+    return 0;
+}
+/*******************************************************************************************************/
 static uint32_t
 tvb_get_varint32(tvbuff_t *tvb, uint8_t *octet_count, uint32_t offset)
 {
-    int counter;
-    int32_t val = 0;
-    uint8_t octet;
-    uint8_t cont;
+    const uint8_t *ptr;
+    int len;
+    uint32_t val = 0;
 
-    for (counter = 1; counter <= 4+1; counter++) {
-        octet = tvb_get_uint8(tvb, offset);
-        offset += 1;
-        if ((counter == 1) && (octet & 0x40)) {     /* check sign */
-            octet &= 0xbf;
-            val = 0xffffffc0;                       /* pre-load with one complement, excluding first 6 bits */
-        } else {
-            val <<= 7;
-        }
-        cont = (octet & 0x80);
-        octet &= 0x7f;
-        val += octet;
-        if (cont == 0) {
-            break;
-        }
+    len = s7commp_vlq_get_ptr(tvb, offset, S7COMMP_VLQ32_MAX_LEN, &ptr);
+    *octet_count = (uint8_t)s7commp_vlq_decode32(ptr, len, true, &val);
+    if (*octet_count == 0) {
+        tvb_get_uint8(tvb, offset + len);   /* truncated, throws */
     }
-    *octet_count = counter;
     return val;
 }
 /*******************************************************************************************************/
 static uint32_t
 tvb_get_varuint32(tvbuff_t *tvb, uint8_t *octet_count, uint32_t offset)
 {
-    int counter;
+    const uint8_t *ptr;
+    int len;
     uint32_t val = 0;
-    uint8_t octet;
-    uint8_t cont;
-    for (counter = 1; counter <= 4+1; counter++) {
-        octet = tvb_get_uint8(tvb, offset);
-        offset += 1;
-        val <<= 7;
-        cont = (octet & 0x80);
-        octet &= 0x7f;
-        val += octet;
-        if (cont == 0) {
-            break;
-        }
+
+    len = s7commp_vlq_get_ptr(tvb, offset, S7COMMP_VLQ32_MAX_LEN, &ptr);
+    *octet_count = (uint8_t)s7commp_vlq_decode32(ptr, len, false, &val);
+    if (*octet_count == 0) {
+        tvb_get_uint8(tvb, offset + len);   /* truncated, throws */
     }
-    *octet_count = counter;
-    return  val;
+    return val;
 }
 /*******************************************************************************************************/
 static uint64_t
 tvb_get_varuint64(tvbuff_t *tvb, uint8_t *octet_count, uint32_t offset)
 {
-    int counter;
+    const uint8_t *ptr;
+    int len;
     uint64_t val = 0;
-    uint8_t octet;
-    uint8_t cont;
-    for (counter = 1; counter <= 8; counter++) {
-        octet = tvb_get_uint8(tvb, offset);
-        offset += 1;
-        val <<= 7;
-        cont = (octet & 0x80);
-        octet &= 0x7f;
-        val += octet;
-        if (cont == 0) {
-            break;
-        }
-    }
-    *octet_count = counter;
-    if (cont) {        /* 8*7 bit + 8 bit = 64 bit -> Sonderfall im letzten Octett! */
-        octet = tvb_get_uint8(tvb, offset);
-        val <<= 8;
-        val += octet;
+
+    len = s7commp_vlq_get_ptr(tvb, offset, S7COMMP_VLQ64_MAX_LEN, &ptr);
+    *octet_count = (uint8_t)s7commp_vlq_decode64(ptr, len, false, &val);
+    if (*octet_count == 0) {
+        tvb_get_uint8(tvb, offset + len);   /* truncated, throws */
     }
-    return  val;
+    return val;
 }
 /*******************************************************************************************************/
 static int64_t
 tvb_get_varint64(tvbuff_t *tvb, uint8_t *octet_count, uint32_t offset)
 {
-    int counter;
-    int64_t val = 0;
-    uint8_t octet;
-    uint8_t cont;
-    for (counter = 1; counter <= 8; counter++) {
-        octet = tvb_get_uint8(tvb, offset);
-        offset += 1;
-        if ((counter == 1) && (octet & 0x40)) {   /* check sign */
-            octet &= 0xbf;
-            val = 0xffffffffffffffc0;             /* pre-load with one complement, excluding first 6 bits */
-        } else {
-            val <<= 7;
-        }
-        cont = (octet & 0x80);
-        octet &= 0x7f;
-        val += octet;
-        if (cont == 0) {
+    const uint8_t *ptr;
+    int len;
+    uint64_t val = 0;
+
+    len = s7commp_vlq_get_ptr(tvb, offset, S7COMMP_VLQ64_MAX_LEN, &ptr);
+    *octet_count = (uint8_t)s7commp_vlq_decode64(ptr, len, true, &val);
+    if (*octet_count == 0) {
+        tvb_get_uint8(tvb, offset + len);   /* truncated, throws */
+    }
+    return (int64_t)val;
+}
+/*******************************************************************************************************/
+/* Decodes up to count consecutive VLQs of max. 32 bits from the len bytes at ptr.
+ * Returns the number of VLQs decoded, less than count if the bytes end before.
+ * *length is set to the number of octets of the decoded VLQs.
+ */
+static uint32_t
+s7commp_vlq_decode32_array(const uint8_t *ptr, int len, uint32_t count, bool is_signed, uint32_t *values, uint8_t *octet_counts, int *length)
+{
+    int pos = 0;
+    int n;
+    uint32_t i;
+
+    for (i = 0; i < count && pos < len; i++) {
+        n = s7commp_vlq_decode32(ptr + pos, MIN(len - pos, S7COMMP_VLQ32_MAX_LEN), is_signed, &values[i]);
+        if (n == 0) {
             break;
         }
+        octet_counts[i] = (uint8_t)n;
+        pos += n;
     }
-    *octet_count = counter;
-    if (cont) {        /* 8*7 bit + 8 bit = 64 bit -> Sonderfall im letzten Octett! */
-        octet = tvb_get_uint8(tvb, offset);
-        val <<= 8;
-        val += octet;
+    *length = pos;
+    return i;
+}
+/*******************************************************************************************************/
+/* Decodes count consecutive unsigned VLQs at offset. The values and their lengths are returned
+ * in arrays allocated from scope. Returns the offset after the last VLQ.
+ */
+static uint32_t
+tvb_get_varuint32_array(tvbuff_t *tvb, uint32_t offset, uint32_t count, wmem_allocator_t *scope, uint32_t **values, uint8_t **octet_counts)
+{
+    const uint8_t *ptr;
+    int len;
+    int pos = 0;
+
+    *values = NULL;
+    *octet_counts = NULL;
+    if (count == 0) {
+        return offset;
+    }
+    /* Each VLQ has at least one octet, so the count is checked before anything is allocated */
+    len = tvb_captured_length_remaining(tvb, offset);
+    if (len <= 0 || count > (uint32_t)len) {
+        tvb_get_uint8(tvb, offset + MAX(len, 0));   /* throws */
+    }
+    *values = wmem_alloc_array(scope, uint32_t, count);
+    *octet_counts = wmem_alloc_array(scope, uint8_t, count);
+    ptr = tvb_get_ptr(tvb, offset, len);
+    if (s7commp_vlq_decode32_array(ptr, len, count, false, *values, *octet_counts, &pos) < count) {
+        tvb_get_uint8(tvb, offset + MIN(len, pos + S7COMMP_VLQ32_MAX_LEN));    /* truncated, throws */
+    }
+    return offset + pos;
+}
+/*******************************************************************************************************/
+/* Decodes the elements of an UDInt or DInt array value in one pass, the values of DInt elements are
+ * returned as uint32_t. Other than tvb_get_varuint32_array this doesn't throw: it returns the number
+ * of elements available, and the caller decodes the remaining elements one by one, so that a
+ * truncated array is shown up to the same element as before.
+ */
+static uint32_t
+tvb_get_varint32_array_avail(tvbuff_t *tvb, uint32_t offset, uint32_t count, bool is_signed, wmem_allocator_t *scope, uint32_t **values, uint8_t **octet_counts)
+{
+    int len;
+    int pos;
+
+    *values = NULL;
+    *octet_counts = NULL;
+    len = tvb_captured_length_remaining(tvb, offset);
+    if (count == 0 || len <= 0) {
+        return 0;
     }
-    return  val;
+    /* Each VLQ has at least one octet, no more elements can be in the tvb */
+    count = MIN(count, (uint32_t)len);
+    *values = wmem_alloc_array(scope, uint32_t, count);
+    *octet_counts = wmem_alloc_array(scope, uint8_t, count);
+    return s7commp_vlq_decode32_array(tvb_get_ptr(tvb, offset, len), len, count, is_signed, *values, *octet_counts, &pos);
 }
 /*******************************************************************************************************
  * Functions for adding a variable-length-quantifier (VLQ) value to the tree.
@@ -7676,6 +8942,179 @@ s7commp_decode_attrib_symbolics(tvbuff_t *tvb,
     }
     return offset;
 }
+#ifdef HAVE_ZLIB
+/*******************************************************************************************************
+ *
+ * Inflate a zlib compressed blob, using a dictionary when the stream requests one.
+ * Returns a new cache entry with the decompressed data, and the result for the display.
+ *
+ *******************************************************************************************************/
+static blob_cache_entry_t *
+s7commp_inflate_blob(tvbuff_t *tvb,
+                     uint32_t offset,
+                     uint32_t length_comp_blob)
+{
+    int retcode;
+    z_streamp streamp;
+    uint32_t uncomp_length;
+    const char *dict = NULL;
+    uint32_t dict_size = 0;
+    const uint8_t *blobptr;
+    uint32_t dict_id = 0;
+    bool dict_unknown = false;
+    bool truncated = false;
+    const blob_dict_t *dict_entry;
+    blob_cache_entry_t *entry;
+    uint32_t max_length;
+
+    if (s7commp_opt_blob_max_size == 0 || s7commp_opt_blob_max_size > G_MAXUINT32 / 1024) {
+        max_length = G_MAXUINT32;
+    } else {
+        max_length = s7commp_opt_blob_max_size * 1024;
+    }
+    /* The output is inflated directly into the data of the cache entry, so every byte is written
+     * once. When the buffer is full, its size is doubled. g_realloc may then move the data produced
+     * so far (large blocks are usually remapped by the allocator instead), the doubling keeps the
+     * moved data below the final size. At the end the buffer is shrunk to the output length.
+     * The first size assumes that XML compresses to about an eighth.
+     */
+    uncomp_length = (uint32_t)MIN(MAX(BLOB_DECOMPRESS_BUFSIZE, (uint64_t)length_comp_blob * 8), max_length);
+    blobptr = tvb_get_ptr(tvb, offset, length_comp_blob);
+    entry = (blob_cache_entry_t *)g_malloc(sizeof(blob_cache_entry_t) + uncomp_length + 1);
+
+    /* The stream is initialized once and only reset for every further blob */
+    streamp = &s7commp_zstream;
+    if (s7commp_zstream_initialized) {
+        inflateReset(streamp);
+    } else {
+        memset(streamp, 0, sizeof(z_stream));
+        if (inflateInit(streamp) != Z_OK) {
+            g_free(entry);
+            entry = (blob_cache_entry_t *)g_malloc0(sizeof(blob_cache_entry_t) + 1);
+            entry->retcode = Z_MEM_ERROR;
+            return entry;
+        }
+        s7commp_zstream_initialized = true;
+    }
+    streamp->avail_in = length_comp_blob;
+#ifdef z_const
+    streamp->next_in = (z_const Bytef *)blobptr;
+#else
+DIAG_OFF(cast-qual)
+    streamp->next_in = (Bytef *)blobptr;
+DIAG_ON(cast-qual)
+#endif
+    streamp->next_out = entry->data;
+    streamp->avail_out = uncomp_length;
+
+    retcode = inflate(streamp, Z_FINISH);
+
+    if (retcode == Z_NEED_DICT) {
+        /* explicit cast to allow build with clang compiler: */
+        dict_id = (uint32_t) streamp->adler;
+        dict_entry = (const blob_dict_t *)g_hash_table_lookup(s7commp_blob_dict_table, GUINT_TO_POINTER(dict_id));
+        if (dict_entry != NULL) {
+            dict = dict_entry->dict;
+            dict_size = dict_entry->size;
+        } else {
+            dict_unknown = true;
+        }
+        if (dict) {
+            retcode = inflateSetDictionary(streamp, dict, dict_size);
+            if (retcode == Z_OK) {
+                retcode = inflate(streamp, Z_FINISH);
+                /* retcode is Z_OK or Z_STREAM_END */
+            }
+        }
+    }
+    while ((retcode == Z_OK) || (retcode == Z_BUF_ERROR)) {
+        /* Z_OK -> made progress, but did not finish
+         * Z_BUF_ERROR -> output buffer full
+         */
+        if (streamp->avail_out == 0) {
+            if (uncomp_length >= max_length) {
+                truncated = true;
+                break;
+            }
+            /* need more memory, double the buffer */
+            streamp->avail_out = MIN(uncomp_length, max_length - uncomp_length);
+            entry = (blob_cache_entry_t *)g_realloc(entry, sizeof(blob_cache_entry_t) + uncomp_length + streamp->avail_out + 1);
+            streamp->next_out = entry->data + uncomp_length;
+            uncomp_length += streamp->avail_out;
+        } else {
+            /* incomplete input, abort */
+            break;
+        }
+        retcode = inflate(streamp, Z_FINISH);
+    }
+    if (streamp->avail_out > 0) {
+        uncomp_length = uncomp_length - streamp->avail_out;
+        entry = (blob_cache_entry_t *)g_realloc(entry, sizeof(blob_cache_entry_t) + uncomp_length + 1);
+    }
+    entry->lru_link = NULL;
+    entry->refcount = 0;
+    entry->retcode = retcode;
+    entry->dict_id = dict_id;
+    entry->dict_unknown = dict_unknown;
+    entry->truncated = truncated;
+    entry->length = uncomp_length;
+    entry->data[uncomp_length] = '\0';
+    return entry;
+}
+/*******************************************************************************************************
+ *
+ * Check if a blob has to be decompressed in this pass. In lazy mode only when the details are
+ * displayed, or a filter references fields of the XML dissector.
+ *
+ *******************************************************************************************************/
+static bool
+s7commp_blob_decompression_needed(proto_tree *tree)
+{
+    if (!s7commp_opt_decompress_blobs_lazy) {
+        return true;
+    }
+    if (tree == NULL) {
+        return false;
+    }
+    if (proto_xml < 0) {
+        return PTREE_DATA(tree)->visible;
+    }
+    return proto_field_is_referenced(tree, proto_xml);
+}
+/*******************************************************************************************************
+ *
+ * Show the dictionary id from the zlib header, without decompressing the blob
+ *
+ *******************************************************************************************************/
+static void
+s7commp_blob_show_dictionary_id(tvbuff_t *tvb,
+                                packet_info *pinfo,
+                                proto_tree *tree,
+                                uint32_t offset,
+                                uint32_t length_comp_blob)
+{
+    uint8_t cmf;
+    uint8_t flg;
+    uint32_t dict_id;
+    proto_item *pi;
+
+    if (length_comp_blob < 6) {
+        return;
+    }
+    cmf = tvb_get_uint8(tvb, offset);
+    flg = tvb_get_uint8(tvb, offset + 1);
+    /* zlib header: check bits over CMF and FLG, FDICT set if a preset dictionary follows */
+    if ((cmf & 0x0f) != Z_DEFLATED || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20) == 0) {
+        return;
+    }
+    dict_id = tvb_get_ntohl(tvb, offset + 2);
+    pi = proto_tree_add_uint(tree, hf_s7commp_compressedblob_dictionary_id, tvb, offset + 2, 4, dict_id);
+    PROTO_ITEM_SET_GENERATED(pi);
+    if (g_hash_table_lookup(s7commp_blob_dict_table, GUINT_TO_POINTER(dict_id)) == NULL) {
+        expert_add_info_format(pinfo, tree, &ei_s7commp_blobdecompression_nodictionary, "Unknown dictionary 0x%08x", dict_id);
+    }
+}
+#endif
 /*******************************************************************************************************
  *
  * Decompress a zlib compressed blob with dictionary
@@ -7695,17 +9134,12 @@ s7commp_decompress_blob(tvbuff_t *tvb,
     proto_tree *subtree = NULL;
 
 #ifdef HAVE_ZLIB
-    int retcode;
-    z_streamp streamp;
-    uint32_t uncomp_length;
-    const char *dict = NULL;
-    uint32_t dict_size = 0;
-    uint8_t *uncomp_blob;
-    const uint8_t *blobptr;
+    blob_cache_key_t key;
+    blob_cache_entry_t *entry;
     tvbuff_t *next_tvb;
     bool dissected;
-    uint32_t length_comp_blob;
 #endif
+    uint32_t length_comp_blob;
 
     if (datatype != S7COMMP_ITEM_DATATYPE_BLOB || length_of_value < 10) {
         return offset;
@@ -7736,157 +9170,35 @@ s7commp_decompress_blob(tvbuff_t *tvb,
 
     if (s7commp_opt_decompress_blobs) {
 #ifdef HAVE_ZLIB
-        uncomp_length = BLOB_DECOMPRESS_BUFSIZE;
-        uncomp_blob = (uint8_t *)wmem_alloc(pinfo->pool, BLOB_DECOMPRESS_BUFSIZE);
-        blobptr = tvb_get_ptr(tvb, offset, length_comp_blob);
-
-        streamp = wmem_new0(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-        WMEM_ALLOCATOR_SIMPLE
-#else
-        wmem_packet_scope()
-#endif
-        , z_stream);
-        inflateInit(streamp);
-        streamp->avail_in = length_comp_blob;
-#ifdef z_const
-        streamp->next_in = (z_const Bytef *)blobptr;
-#else
-DIAG_OFF(cast-qual)
-        streamp->next_in = (Bytef *)blobptr;
-DIAG_ON(cast-qual)
-#endif
-        streamp->next_out = uncomp_blob;
-        streamp->avail_out = BLOB_DECOMPRESS_BUFSIZE;
-
-        retcode = inflate(streamp, Z_FINISH);
-
-        if (retcode == Z_NEED_DICT) {
-            pi = proto_tree_add_uint(subtree, hf_s7commp_compressedblob_dictionary_id, tvb, offset + 2, 4,
-                                     /* explicit cast to allow build with clang compiler: */
-                                     (uint32_t) streamp->adler);
-            PROTO_ITEM_SET_GENERATED(pi);
-            switch (streamp->adler) {
-                case S7COMMP_DICTID_BodyDesc_90000001:
-                    dict = s7commp_dict_BodyDesc_90000001;
-                    dict_size = sizeof(s7commp_dict_BodyDesc_90000001);
-                    break;
-                case S7COMMP_DICTID_NWC_90000001:
-                    dict = s7commp_dict_NWC_90000001;
-                    dict_size = sizeof(s7commp_dict_NWC_90000001);
-                    break;
-                case S7COMMP_DICTID_NWC_98000001:
-                    dict = s7commp_dict_NWC_98000001;
-                    dict_size = sizeof(s7commp_dict_NWC_98000001);
-                    break;
-                case S7COMMP_DICTID_NWT_90000001:
-                    dict = s7commp_dict_NWT_90000001;
-                    dict_size = sizeof(s7commp_dict_NWT_90000001);
-                    break;
-                case S7COMMP_DICTID_NWT_98000001:
-                    dict = s7commp_dict_NWT_98000001;
-                    dict_size = sizeof(s7commp_dict_NWT_98000001);
-                    break;
-                case S7COMMP_DICTID_DebugInfo_90000001:
-                    dict = s7commp_dict_DebugInfo_90000001;
-                    dict_size = sizeof(s7commp_dict_DebugInfo_90000001);
-                    break;
-                case S7COMMP_DICTID_ExtRefData_90000001:
-                    dict = s7commp_dict_ExtRefData_90000001;
-                    dict_size = sizeof(s7commp_dict_ExtRefData_90000001);
-                    break;
-                case S7COMMP_DICTID_IntRefData_90000001:
-                    dict = s7commp_dict_IntRefData_90000001;
-                    dict_size = sizeof(s7commp_dict_IntRefData_90000001);
-                    break;
-                case S7COMMP_DICTID_IntRefData_98000001:
-                    dict = s7commp_dict_IntRefData_98000001;
-                    dict_size = sizeof(s7commp_dict_IntRefData_98000001);
-                    break;
-                case S7COMMP_DICTID_IntfDescTag_90000001:
-                    dict = s7commp_dict_IntfDescTag_90000001;
-                    dict_size = sizeof(s7commp_dict_IntfDescTag_90000001);
-                    break;
-                case S7COMMP_DICTID_IntfDesc_90000001:
-                    dict = s7commp_dict_IntfDesc_90000001;
-                    dict_size = sizeof(s7commp_dict_IntfDesc_90000001);
-                    break;
-                case S7COMMP_DICTID_DebugInfo_IntfDesc_98000001:
-                    dict = s7commp_dict_DebugInfo_IntfDesc_98000001;
-                    dict_size = sizeof(s7commp_dict_DebugInfo_IntfDesc_98000001);
-                    break;
-                case S7COMMP_DICTID_TagLineComm_90000001:
-                    dict = s7commp_dict_TagLineComm_90000001;
-                    dict_size = sizeof(s7commp_dict_TagLineComm_90000001);
-                    break;
-                case S7COMMP_DICTID_LineComm_90000001:
-                    dict = s7commp_dict_LineComm_90000001;
-                    dict_size = sizeof(s7commp_dict_LineComm_90000001);
-                    break;
-                case S7COMMP_DICTID_LineComm_98000001:
-                    dict = s7commp_dict_LineComm_98000001;
-                    dict_size = sizeof(s7commp_dict_LineComm_98000001);
-                    break;
-                case S7COMMP_DICTID_IdentES_90000001:
-                    dict = s7commp_dict_IdentES_90000001;
-                    dict_size = sizeof(s7commp_dict_IdentES_90000001);
-                    break;
-                case S7COMMP_DICTID_IdentES_90000002:
-                    dict = s7commp_dict_IdentES_90000002;
-                    dict_size = sizeof(s7commp_dict_IdentES_90000002);
-                    break;
-                case S7COMMP_DICTID_IdentES_98000001:
-                    dict = s7commp_dict_IdentES_98000001;
-                    dict_size = sizeof(s7commp_dict_IdentES_98000001);
-                    break;
-                case S7COMMP_DICTID_CompilerSettings_90000001:
-                    dict = s7commp_dict_CompilerSettings_90000001;
-                    dict_size = sizeof(s7commp_dict_CompilerSettings_90000001);
-                    break;
-                default:
-                    expert_add_info_format(pinfo, subtree, &ei_s7commp_blobdecompression_nodictionary, "Unknown dictionary 0x%08lx", streamp->adler);
-                    break;
-            }
-            if (dict) {
-                retcode = inflateSetDictionary(streamp, dict, dict_size);
-                if (retcode == Z_OK) {
-                    retcode = inflate(streamp, Z_FINISH);
-                    /* retcode is Z_OK or Z_STREAM_END */
-                }
-            }
-        }
-        while ((retcode == Z_OK) || (retcode == Z_BUF_ERROR)) {
-            /* Z_OK -> made progress, but did not finish
-             * Z_BUF_ERROR -> output buffer full
-             */
-            if (streamp->avail_out == 0) {
-                /* need more memory */
-                uncomp_blob = (uint8_t *)wmem_realloc(pinfo->pool, uncomp_blob, uncomp_length + BLOB_DECOMPRESS_BUFSIZE);
-                streamp->next_out = uncomp_blob + uncomp_length;
-                streamp->avail_out = BLOB_DECOMPRESS_BUFSIZE;
-                uncomp_length += BLOB_DECOMPRESS_BUFSIZE;
-            } else {
-                /* incomplete input, abort */
-                break;
+        if (!s7commp_blob_decompression_needed(tree)) {
+            s7commp_blob_show_dictionary_id(tvb, pinfo, subtree, offset, length_comp_blob);
+        } else {
+            key.frame = pinfo->num;
+            key.layer = pinfo->curr_layer_num;
+            key.offset = (uint32_t)(tvb_raw_offset(tvb) + offset);
+            key.length = length_comp_blob;
+            key.crc = (uint32_t)crc32(0L, tvb_get_ptr(tvb, offset, length_comp_blob), length_comp_blob);
+            entry = s7commp_blob_cache_lookup(&key);
+            if (entry == NULL) {
+                entry = s7commp_inflate_blob(tvb, offset, length_comp_blob);
+                entry->key = key;
+                s7commp_blob_cache_insert(entry);
             }
-            retcode = inflate(streamp, Z_FINISH);
-        }
-        if (uncomp_length != streamp->avail_out) { /* produced some output, show it */
-            uncomp_length = uncomp_length - streamp->avail_out;
 
-            if (uncomp_length > 0) {
-                if (streamp->avail_out == 0) {
-                    /* need one more byte for string null terminator */
-                    uncomp_blob = (uint8_t *)wmem_realloc(pinfo->pool, uncomp_blob, uncomp_length + 1);
+            if (entry->dict_id != 0) {
+                pi = proto_tree_add_uint(subtree, hf_s7commp_compressedblob_dictionary_id, tvb, offset + 2, 4, entry->dict_id);
+                PROTO_ITEM_SET_GENERATED(pi);
+                if (entry->dict_unknown) {
+                    expert_add_info_format(pinfo, subtree, &ei_s7commp_blobdecompression_nodictionary, "Unknown dictionary 0x%08x", entry->dict_id);
                 }
-
-                next_tvb = tvb_new_child_real_data(tvb, uncomp_blob, uncomp_length, uncomp_length);
+            }
+            if (entry->length > 0) { /* produced some output, show it */
+                next_tvb = tvb_new_child_real_data(tvb, entry->data, entry->length, entry->length);
+                entry->refcount++;
+                tvb_set_free_cb(next_tvb, s7commp_blob_tvb_free_cb);
                 add_new_data_source(pinfo, next_tvb, "Decompressed Data");
 
-                uncomp_blob[uncomp_length] = '\0';
-                /* make new tvb and call xml subdissector, as all compressed data are (so far) xml */
+                /* call xml subdissector, as all compressed data are (so far) xml */
                 if (xml_handle != NULL) {
                     dissected = call_dissector_only(xml_handle, next_tvb, pinfo, subtree, NULL);
                     if (!dissected) {
@@ -7894,11 +9206,15 @@ DIAG_ON(cast-qual)
                     }
                 }
             }
+            if (entry->truncated) {
+                expert_add_info_format(pinfo, subtree, &ei_s7commp_blobdecompression_truncated,
+                                       "Blob decompression stopped after %u bytes (preference blob_max_size)", entry->length);
+            } else if (entry->retcode != Z_STREAM_END) {
+                expert_add_info_format(pinfo, subtree, &ei_s7commp_blobdecompression_failed, "Blob decompression failed, retcode = %d", entry->retcode);
+            }
+            /* not inserted into the cache and not used by a tvb */
+            s7commp_blob_cache_entry_release(entry);
         }
-        if (retcode != Z_STREAM_END) {
-            expert_add_info_format(pinfo, subtree, &ei_s7commp_blobdecompression_failed, "Blob decompression failed, retcode = %d", retcode);
-        }
-        inflateEnd(streamp);
 #endif
     }
     offset += length_comp_blob;
@@ -8081,7 +9397,165 @@ s7commp_decode_value_extended(tvbuff_t *tvb,
             break;
 
     }
-    return offset;
+    return offset;
+}
+/*******************************************************************************************************
+ *
+ * Decoding limits of the packet
+ *
+ *******************************************************************************************************/
+static s7commp_decode_budget_t *
+s7commp_get_decode_budget(packet_info *pinfo)
+{
+    s7commp_decode_budget_t *budget;
+
+    budget = (s7commp_decode_budget_t *)p_get_proto_data(pinfo->pool, pinfo, proto_s7commp, S7COMMP_PROTO_DATA_BUDGET);
+    if (budget == NULL) {
+        budget = wmem_new0(pinfo->pool, s7commp_decode_budget_t);
+        p_add_proto_data(pinfo->pool, pinfo, proto_s7commp, S7COMMP_PROTO_DATA_BUDGET, budget);
+    }
+    return budget;
+}
+
+static void
+s7commp_decode_budget_enter(s7commp_decode_budget_t *budget,
+                            tvbuff_t *tvb,
+                            packet_info *pinfo,
+                            proto_tree *tree,
+                            uint32_t offset)
+{
+    budget->depth++;
+    if (budget->depth > S7COMMP_DECODE_MAX_DEPTH) {
+        proto_tree_add_expert_format(tree, pinfo, &ei_s7commp_decode_limit, tvb, offset, 0,
+            "Values or objects nested deeper than %u levels, decoding stopped", S7COMMP_DECODE_MAX_DEPTH);
+        THROW(ReportedBoundsError);
+    }
+}
+
+static void
+s7commp_decode_budget_leave(s7commp_decode_budget_t *budget)
+{
+    budget->depth--;
+}
+
+static void
+s7commp_decode_budget_count(s7commp_decode_budget_t *budget,
+                            tvbuff_t *tvb,
+                            packet_info *pinfo,
+                            proto_tree *tree,
+                            uint32_t offset)
+{
+    budget->values++;
+    if (s7commp_opt_max_values > 0 && budget->values > s7commp_opt_max_values) {
+        proto_tree_add_expert_format(tree, pinfo, &ei_s7commp_decode_limit, tvb, offset, 0,
+            "More than %u values in the packet, decoding stopped", s7commp_opt_max_values);
+        THROW(ReportedBoundsError);
+    }
+}
+/*******************************************************************************************************
+ *
+ * Skips a number of array elements without decoding them.
+ * Returns the offset after the elements, or 0 if the datatype can't be skipped, because the
+ * length of its elements is only known after decoding them.
+ *
+ *******************************************************************************************************/
+static uint32_t
+s7commp_skip_array_values(tvbuff_t *tvb,
+                          uint32_t offset,
+                          uint8_t datatype,
+                          uint32_t count,
+                          bool disable_vlq)
+{
+    uint32_t width = 0;
+    uint64_t length;
+    int remaining;
+    uint32_t i;
+    uint32_t length_of_value;
+    uint8_t octet_count = 0;
+
+    switch (datatype) {
+        case S7COMMP_ITEM_DATATYPE_BOOL:
+        case S7COMMP_ITEM_DATATYPE_USINT:
+        case S7COMMP_ITEM_DATATYPE_SINT:
+        case S7COMMP_ITEM_DATATYPE_BYTE:
+            width = 1;
+            break;
+        case S7COMMP_ITEM_DATATYPE_UINT:
+        case S7COMMP_ITEM_DATATYPE_INT:
+        case S7COMMP_ITEM_DATATYPE_WORD:
+            width = 2;
+            break;
+        case S7COMMP_ITEM_DATATYPE_DWORD:
+        case S7COMMP_ITEM_DATATYPE_REAL:
+        case S7COMMP_ITEM_DATATYPE_RID:
+            width = 4;
+            break;
+        case S7COMMP_ITEM_DATATYPE_LWORD:
+        case S7COMMP_ITEM_DATATYPE_LREAL:
+        case S7COMMP_ITEM_DATATYPE_TIMESTAMP:
+            width = 8;
+            break;
+        case S7COMMP_ITEM_DATATYPE_UDINT:
+        case S7COMMP_ITEM_DATATYPE_DINT:
+            if (disable_vlq) {
+                width = 4;
+            } else {
+                for (i = 0; i < count; i++) {
+                    tvb_get_varuint32(tvb, &octet_count, offset);
+                    offset += octet_count;
+                }
+                return offset;
+            }
+            break;
+        case S7COMMP_ITEM_DATATYPE_ULINT:
+        case S7COMMP_ITEM_DATATYPE_LINT:
+            if (disable_vlq) {
+                width = 8;
+            } else {
+                for (i = 0; i < count; i++) {
+                    tvb_get_varuint64(tvb, &octet_count, offset);
+                    offset += octet_count;
+                }
+                return offset;
+            }
+            break;
+        case S7COMMP_ITEM_DATATYPE_TIMESPAN:
+            for (i = 0; i < count; i++) {
+                tvb_get_varuint64(tvb, &octet_count, offset);
+                offset += octet_count;
+            }
+            return offset;
+        case S7COMMP_ITEM_DATATYPE_AID:
+            for (i = 0; i < count; i++) {
+                tvb_get_varuint32(tvb, &octet_count, offset);
+                offset += octet_count;
+            }
+            return offset;
+        case S7COMMP_ITEM_DATATYPE_WSTRING:
+            for (i = 0; i < count; i++) {
+                length_of_value = tvb_get_varuint32(tvb, &octet_count, offset);
+                offset += octet_count;
+                tvb_ensure_bytes_exist(tvb, offset, length_of_value);
+                offset += length_of_value;
+            }
+            return offset;
+        default:
+            /* Struct, Blob, Variant and unknown types */
+            return 0;
+    }
+    /* Fixed width: check that the data exists, so that a short frame throws the
+     * same exception as the decoding of the single elements.
+     */
+    length = (uint64_t)count * width;
+    remaining = tvb_reported_length_remaining(tvb, offset);
+    if (remaining < 0) {
+        remaining = 0;
+    }
+    if (length > (uint64_t)remaining) {
+        length = (uint64_t)remaining + 1;
+    }
+    tvb_ensure_bytes_exist(tvb, offset, (int)length);
+    return offset + (uint32_t)length;
 }
 /*******************************************************************************************************
  *
@@ -8096,7 +9570,8 @@ s7commp_decode_value(tvbuff_t *tvb,
                      int* struct_level,
                      uint32_t id_number,
                      uint32_t relid,
-                     bool disable_vlq)
+                     bool disable_vlq,
+                     s7commp_value_tap_info_t *value_info)
 {
     uint8_t octet_count = 0;
     uint8_t datatype;
@@ -8109,12 +9584,14 @@ s7commp_decode_value(tvbuff_t *tvb,
     bool is_struct_addressarray;
     uint32_t array_size = 1;     /* use 1 as default, so non-arrays can be dissected in the same way as arrays */
     uint32_t array_index = 0;
+    uint32_t array_skip_index = 0;
+    uint32_t array_skipped = 0;
+    uint32_t skip_offset;
     uint32_t blobtype = 0;
 
     proto_item *array_item = NULL;
     proto_tree *array_item_tree = NULL;
     proto_tree *current_tree = NULL;
-    proto_item *pi = NULL;
 
     uint64_t uint64val = 0;
     uint32_t uint32val = 0;
@@ -8125,37 +9602,27 @@ s7commp_decode_value(tvbuff_t *tvb,
     int64_t int64val = 0;
     int8_t int8val = 0;
     nstime_t tmptime;
-    char *str_val = NULL;           /* Value of one single item */
-    char *str_arrval = NULL;        /* Value of array values */
+    char str_val[S7COMMP_ITEMVAL_STR_VAL_MAX];          /* Value of one single item */
+    char str_arrval[S7COMMP_ITEMVAL_STR_ARRVAL_MAX];    /* Value of array values */
     uint32_t sparsearray_key = 0;
     const char *str_arr_prefix = "Unknown";
-    char *struct_resultstring;
+    char struct_resultstring[ITEM_LABEL_LENGTH];
 
     uint32_t start_offset = 0;
     uint32_t length_of_value = 0;
     uint32_t value_start_offset = 0;
 
     uint32_t struct_value = 0;
+    s7commp_decode_budget_t *budget = s7commp_get_decode_budget(pinfo);
 
-    str_val = (char *)wmem_alloc(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-        WMEM_ALLOCATOR_SIMPLE
-#else
-        wmem_packet_scope()
-#endif
-        , S7COMMP_ITEMVAL_STR_VAL_MAX);
+    uint32_t *vlq_values = NULL;                        /* Elements of an UDInt or DInt array, decoded at once */
+    uint8_t *vlq_octet_counts = NULL;
+    uint32_t vlq_count = 0;
+
+    /* The value strings are on the stack, this runs for every single value.
+     * Temporary strings of the value functions are taken from the packet pool.
+     */
     str_val[0] = '\0';
-    str_arrval = (char *)wmem_alloc(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-        WMEM_ALLOCATOR_SIMPLE
-#else
-        wmem_packet_scope()
-#endif
-        , S7COMMP_ITEMVAL_STR_ARRVAL_MAX);
     str_arrval[0] = '\0';
 
     if (disable_vlq) {
@@ -8221,12 +9688,41 @@ s7commp_decode_value(tvbuff_t *tvb,
             str_arr_prefix = "Sparsearray";
         }
         current_tree = array_item_tree;
+        /* Large arrays: Only the first values go into the summary string. The elements after them are
+         * skipped without decoding, if there is no tree, or if the tree should not show all elements.
+         * The extended decoding depends on the ID, so this is only done for values without one.
+         */
+        if ((is_array || is_address_array) && id_number == 0) {
+            if (data_item_tree == NULL) {
+                array_skip_index = S7COMMP_ITEMVAL_ARR_MAX_DISPLAY + 1;
+            } else if (s7commp_opt_array_max_elements > 0) {
+                array_skip_index = MAX(s7commp_opt_array_max_elements, S7COMMP_ITEMVAL_ARR_MAX_DISPLAY) + 1;
+            }
+        }
+        /* The elements of an UDInt or DInt array are consecutive VLQs, decode the ones which are shown at once */
+        if ((is_array || is_address_array) && !disable_vlq &&
+            (datatype == S7COMMP_ITEM_DATATYPE_UDINT || datatype == S7COMMP_ITEM_DATATYPE_DINT)) {
+            vlq_count = tvb_get_varint32_array_avail(tvb, offset,
+                (array_skip_index > 0) ? MIN(array_size, array_skip_index - 1) : array_size,
+                (datatype == S7COMMP_ITEM_DATATYPE_DINT), pinfo->pool, &vlq_values, &vlq_octet_counts);
+        }
     } else {
         current_tree = data_item_tree;
     }
 
     /* Use array loop also for non-arrays */
     for (array_index = 1; array_index <= array_size; array_index++) {
+        if (array_skip_index > 0 && array_index >= array_skip_index) {
+            skip_offset = s7commp_skip_array_values(tvb, offset, datatype, array_size - array_index + 1, disable_vlq);
+            if (skip_offset > 0) {
+                array_skipped = array_size - array_index + 1;
+                offset = skip_offset;
+                break;
+            }
+            /* Not skippable, decode all elements */
+            array_skip_index = 0;
+        }
+        s7commp_decode_budget_count(budget, tvb, pinfo, current_tree, offset);
         if (is_sparsearray) {
             if (disable_vlq) {
                 sparsearray_key = tvb_get_ntohl(tvb, offset);
@@ -8292,7 +9788,10 @@ s7commp_decode_value(tvbuff_t *tvb,
                 break;
             case S7COMMP_ITEM_DATATYPE_UDINT:
                 value_start_offset = offset;
-                if (disable_vlq) {
+                if (array_index <= vlq_count) {
+                    uint32val = vlq_values[array_index - 1];
+                    octet_count = vlq_octet_counts[array_index - 1];
+                } else if (disable_vlq) {
                     uint32val = tvb_get_ntohl(tvb, offset);
                     octet_count = 4;
                 } else {
@@ -8349,7 +9848,10 @@ s7commp_decode_value(tvbuff_t *tvb,
                 break;
             case S7COMMP_ITEM_DATATYPE_DINT:
                 value_start_offset = offset;
-                if (disable_vlq) {
+                if (array_index <= vlq_count) {
+                    int32val = (int32_t)vlq_values[array_index - 1];
+                    octet_count = vlq_octet_counts[array_index - 1];
+                } else if (disable_vlq) {
                     int32val = tvb_get_ntohl(tvb, offset);
                     octet_count = 4;
                 } else {
@@ -8379,15 +9881,6 @@ s7commp_decode_value(tvbuff_t *tvb,
                 length_of_value = 4;
                 value_start_offset = offset;
                 struct_value = tvb_get_ntohl(tvb, offset);
-                struct_resultstring = (char *)wmem_alloc(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-                    WMEM_ALLOCATOR_SIMPLE
-#else
-                    wmem_packet_scope()
-#endif
-                    , ITEM_LABEL_LENGTH);
                 s7commp_idname_fmt(struct_resultstring, struct_value);
                 g_snprintf(str_val, S7COMMP_ITEMVAL_STR_VAL_MAX, "%u (%s)", struct_value, struct_resultstring);
                 proto_tree_add_uint(current_tree, hf_s7commp_itemval_struct, tvb, offset, length_of_value, struct_value);
@@ -8427,16 +9920,9 @@ s7commp_decode_value(tvbuff_t *tvb,
                 uint64val = tvb_get_ntoh64(tvb, offset);
                 tmptime.secs = (time_t)(uint64val / 1000000000);
                 tmptime.nsecs = uint64val % 1000000000;
-                pi = proto_tree_add_time(current_tree, hf_s7commp_itemval_timestamp, tvb, offset, length_of_value, &tmptime);
-                g_snprintf(str_val, S7COMMP_ITEMVAL_STR_VAL_MAX, "%s", proto_item_get_display_repr(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-                               WMEM_ALLOCATOR_SIMPLE
-#else
-                               wmem_packet_scope()
-#endif
-                               , pi));
+                proto_tree_add_time(current_tree, hf_s7commp_itemval_timestamp, tvb, offset, length_of_value, &tmptime);
+                /* Formatted from the value, as the item doesn't exist without a tree */
+                g_snprintf(str_val, S7COMMP_ITEMVAL_STR_VAL_MAX, "%s", abs_time_to_str(pinfo->pool, &tmptime, ABSOLUTE_TIME_UTC, false));
                 offset += 8;
                 break;
             case S7COMMP_ITEM_DATATYPE_TIMESPAN:
@@ -8469,15 +9955,7 @@ s7commp_decode_value(tvbuff_t *tvb,
                 offset += octet_count;
                 value_start_offset = offset;
                 g_snprintf(str_val, S7COMMP_ITEMVAL_STR_VAL_MAX, "%s",
-                       tvb_get_string_enc(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-                           WMEM_ALLOCATOR_SIMPLE
-#else
-                           wmem_packet_scope()
-#endif
-                           , tvb, offset, length_of_value, ENC_UTF_8|ENC_NA));
+                       tvb_get_string_enc(pinfo->pool, tvb, offset, length_of_value, ENC_UTF_8|ENC_NA));
                 proto_tree_add_item(current_tree, hf_s7commp_itemval_wstring, tvb, offset, length_of_value, ENC_UTF_8|ENC_NA);
                 offset += length_of_value;
                 break;
@@ -8513,15 +9991,7 @@ s7commp_decode_value(tvbuff_t *tvb,
                         value_start_offset = offset;
                         if (length_of_value > 0) {
                             g_snprintf(str_val, S7COMMP_ITEMVAL_STR_VAL_MAX, "0x%s",
-                                       tvb_bytes_to_str(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-                                           WMEM_ALLOCATOR_SIMPLE
-#else
-                                           wmem_packet_scope()
-#endif
-                                           , tvb, offset, length_of_value));
+                                       tvb_bytes_to_str(pinfo->pool, tvb, offset, length_of_value));
                             proto_tree_add_item(current_tree, hf_s7commp_itemval_blob, tvb, offset, length_of_value, ENC_NA);
                         } else {
                             g_strlcpy(str_val, "<Empty>", S7COMMP_ITEMVAL_STR_VAL_MAX);
@@ -8539,15 +10009,7 @@ s7commp_decode_value(tvbuff_t *tvb,
                     value_start_offset = offset;
                     if (length_of_value > 0) {
                         g_snprintf(str_val, S7COMMP_ITEMVAL_STR_VAL_MAX, "0x%s",
-                                   tvb_bytes_to_str(
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-                                       WMEM_ALLOCATOR_SIMPLE
-#else
-                                       wmem_packet_scope()
-#endif
-                                       , tvb, offset, length_of_value));
+                                   tvb_bytes_to_str(pinfo->pool, tvb, offset, length_of_value));
                         proto_tree_add_item(current_tree, hf_s7commp_itemval_blob, tvb, offset, length_of_value, ENC_NA);
                     } else {
                         g_strlcpy(str_val, "<Empty>", S7COMMP_ITEMVAL_STR_VAL_MAX);
@@ -8599,6 +10061,9 @@ s7commp_decode_value(tvbuff_t *tvb,
     }
     if (is_array || is_address_array) {
         proto_item_append_text(array_item_tree, " %s[%u] = %s", str_arr_prefix, array_size, str_arrval);
+        if (array_skipped > 0) {
+            proto_item_append_text(array_item_tree, " (%u elements not shown)", array_skipped);
+        }
         proto_item_set_len(array_item_tree, offset - start_offset);
         proto_item_append_text(data_item_tree, " (%s) %s[%u] = %s",
                                val_to_str(
@@ -8653,6 +10118,12 @@ s7commp_decode_value(tvbuff_t *tvb,
 #endif
                                    datatype, item_datatype_names, "Unknown datatype: 0x%02x"), str_val);
     }
+    /* Value for the export, a struct has its values in the following elements */
+    if (value_info != NULL && datatype != S7COMMP_ITEM_DATATYPE_STRUCT) {
+        value_info->datatype = datatype;
+        value_info->datatype_flags = datatype_flags;
+        value_info->value = wmem_strdup(pinfo->pool, (is_array || is_address_array || is_sparsearray) ? str_arrval : str_val);
+    }
     /* Special handling of datatype struct and some specific ID ranges:
      * Some struct elements aren't transmitted as single elements. Instead they are packed (e.g. DTL-Struct).
      * The ID number range where this is used is only guessed (Type Info).
@@ -8666,10 +10137,18 @@ s7commp_decode_value(tvbuff_t *tvb,
     }
     return offset;
 }
+/* A list of an ID/value list decoding, a struct contains a new list */
+typedef struct {
+    proto_tree *tree;                   /* Tree of the list */
+    proto_tree *struct_tree;            /* Item of the struct which contains the list */
+    uint32_t struct_start_offset;
+    bool recursive;
+} s7commp_id_value_level_t;
 /*******************************************************************************************************
  *
  * Decodes a list of item-id and a value recursive sub-structs.
  * Builds a tree which represents the data structure.
+ * The sub-structs are decoded in the same loop, the enclosing lists are kept on an explicit stack.
  *
  *******************************************************************************************************/
 static uint32_t
@@ -8687,8 +10166,16 @@ s7commp_decode_id_value_list(tvbuff_t *tvb,
     uint32_t start_offset;
     uint8_t octet_count = 0;
     int struct_level;
-
-    do {
+    s7commp_decode_budget_t *budget = s7commp_get_decode_budget(pinfo);
+    s7commp_id_value_level_t *levels = NULL;
+    s7commp_id_value_level_t *level;
+    s7commp_id_value_level_t top_level = { tree, NULL, 0, recursive };
+    int depth = 0;
+    bool list_end;
+
+    s7commp_decode_budget_enter(budget, tvb, pinfo, tree, offset);
+    level = &top_level;
+    for (;;) {
         if (disable_vlq) {
             id_number = tvb_get_ntohl(tvb, offset);
             octet_count = 4;
@@ -8696,40 +10183,57 @@ s7commp_decode_id_value_list(tvbuff_t *tvb,
             id_number = tvb_get_varuint32(tvb, &octet_count, offset);
         }
         if (id_number == 0) {
-            proto_tree_add_item(tree, hf_s7commp_listitem_terminator, tvb, offset, octet_count, ENC_NA);
+            proto_tree_add_item(level->tree, hf_s7commp_listitem_terminator, tvb, offset, octet_count, ENC_NA);
             offset += octet_count;
-            return offset;
+            list_end = true;
         } else {
             start_offset = offset;
-            data_item = proto_tree_add_item(tree, hf_s7commp_data_item_value, tvb, offset, -1, ENC_NA);
+            data_item = proto_tree_add_item(level->tree, hf_s7commp_data_item_value, tvb, offset, -1, ENC_NA);
             data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_data_item);
             proto_tree_add_uint(data_item_tree, hf_s7commp_data_id_number, tvb, offset, octet_count, id_number);
             s7commp_proto_item_append_idname(data_item_tree, id_number, ": ID=");
             offset += octet_count;
             struct_level = 0;
-            offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, id_number, relid, disable_vlq);
+            offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, id_number, relid, disable_vlq, NULL);
             /* Extended decoding */
             switch (id_number) {
                 case 1048:  /* 1048 = SubscriptionReferenceList. Done at this location because it's an array of integers. */
-                    s7commp_decode_attrib_subscriptionreflist(tvb, tree, start_offset + octet_count
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                                              ,
-                                                              pinfo
-#endif
-                        );
+                    s7commp_decode_attrib_subscriptionreflist(tvb, level->tree, start_offset + octet_count, pinfo);
+                    break;
+                case 1053:  /* 1053 = SubscriptionCreditLimit, needed for the notification sequence analysis */
+                    if (!disable_vlq) {
+                        s7commp_decode_attrib_subscriptioncreditlimit(tvb, start_offset + octet_count, s7commp_get_trans_subscription(pinfo));
+                    }
                     break;
             }
 
-            if (struct_level > 0) { /* A new struct was entered, use recursive struct traversal */
-                offset = s7commp_decode_id_value_list(tvb, pinfo, data_item_tree, offset, relid, true, disable_vlq);
+            if (struct_level > 0) { /* A new struct was entered, the following values are its elements */
+                s7commp_decode_budget_enter(budget, tvb, pinfo, data_item_tree, offset);
+                if (levels == NULL) {
+                    levels = wmem_alloc_array(pinfo->pool, s7commp_id_value_level_t, S7COMMP_DECODE_MAX_DEPTH);
+                }
+                level = &levels[depth++];
+                level->tree = data_item_tree;
+                level->struct_tree = data_item_tree;
+                level->struct_start_offset = start_offset;
+                level->recursive = true;
+                continue;
             }
             proto_item_set_len(data_item_tree, offset - start_offset);
-            if (struct_level < 0) {
+            list_end = (struct_level < 0) || !level->recursive;
+        }
+        /* Back to the enclosing lists, which end with the struct */
+        while (list_end) {
+            s7commp_decode_budget_leave(budget);
+            if (depth == 0) {
                 return offset;
             }
+            proto_item_set_len(level->struct_tree, offset - level->struct_start_offset);
+            depth--;
+            level = (depth > 0) ? &levels[depth - 1] : &top_level;
+            list_end = !level->recursive;
         }
-    } while (recursive);
-    return offset;
+    }
 }
 /*******************************************************************************************************
  *
@@ -8753,6 +10257,42 @@ s7commp_decode_id_value_list_in_new_tree(tvbuff_t *tvb,
     proto_item_set_len(list_item_tree, offset - list_start_offset);
     return offset;
 }
+/*******************************************************************************************************
+ *
+ * Info for the "s7comm-plus.value" tap, NULL if nobody listens.
+ * The value itself is set by s7commp_decode_value.
+ *
+ *******************************************************************************************************/
+static s7commp_value_tap_info_t *
+s7commp_new_value_tap_info(packet_info *pinfo,
+                           bool is_notification,
+                           uint32_t subscr_object_id,
+                           uint32_t item_number)
+{
+    s7commp_value_tap_info_t *value_info;
+    s7commp_transaction_t *trans;
+    const s7commp_subscr_item_t *sub_item;
+
+    if (!have_tap_listener(s7commp_value_tap)) {
+        return NULL;
+    }
+    value_info = wmem_new0(pinfo->pool, s7commp_value_tap_info_t);
+    value_info->session = find_or_create_conversation(pinfo)->conv_index;
+    value_info->item_number = item_number;
+    if (is_notification) {
+        value_info->is_notification = true;
+        value_info->from_plc = true;
+        value_info->subscr_object_id = subscr_object_id;
+        if ((sub_item = s7commp_lookup_subscr_item(pinfo, subscr_object_id, item_number)) != NULL) {
+            value_info->address = sub_item->address;
+        }
+    } else if ((trans = s7commp_get_transaction(pinfo)) != NULL) {
+        value_info->from_plc = (trans->req_frame != pinfo->num);
+        value_info->functioncode = trans->functioncode;
+        value_info->address = s7commp_get_trans_item_address(pinfo, item_number);
+    }
+    return value_info;
+}
 /*******************************************************************************************************
  *
  * Decodes a list of item-number and value. Subvalues (struct members) are decoded as IDs.
@@ -8772,6 +10312,7 @@ s7commp_decode_itemnumber_value_list(tvbuff_t *tvb,
     uint32_t start_offset;
     uint8_t octet_count = 0;
     int struct_level;
+    s7commp_value_tap_info_t *value_info;
 
     do {
         itemnumber = tvb_get_varuint32(tvb, &octet_count, offset);
@@ -8787,7 +10328,11 @@ s7commp_decode_itemnumber_value_list(tvbuff_t *tvb,
             proto_item_append_text(data_item_tree, " [%u]:", itemnumber);
             offset += octet_count;
             struct_level = 0;
-            offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, relid, false);
+            value_info = s7commp_new_value_tap_info(pinfo, false, 0, itemnumber);
+            offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, relid, false, value_info);
+            if (value_info != NULL && value_info->value != NULL) {
+                tap_queue_packet(s7commp_value_tap, pinfo, value_info);
+            }
             if (struct_level > 0) {
                 offset = s7commp_decode_id_value_list(tvb, pinfo, data_item_tree, offset, relid, true, false);
             }
@@ -8871,7 +10416,9 @@ s7commp_decode_itemnumber_errorvalue_list(tvbuff_t *tvb,
 static uint32_t
 s7commp_decode_tagdescription(tvbuff_t *tvb,
                               proto_tree *tree,
-                              uint32_t offset)
+                              uint32_t offset,
+                              packet_info *pinfo,
+                              uint32_t relid)
 {
     uint32_t length_of_value;
     uint32_t vlq_value;
@@ -8888,6 +10435,11 @@ s7commp_decode_tagdescription(tvbuff_t *tvb,
     const uint8_t *str_type;
     int32_t mdarray_lowerbounds[6];
     int32_t mdarray_elementcount[6];
+    s7commp_symbol_t symbol;
+    wmem_strbuf_t *array_bounds;
+
+    symbol.struct_relid = 0;
+    symbol.array_bounds = NULL;
 
     offsetinfotype = tvb_get_uint8(tvb, offset);
     proto_tree_add_uint(tree, hf_s7commp_tagdescr_offsetinfotype, tvb, offset, 1, offsetinfotype);
@@ -8897,14 +10449,7 @@ s7commp_decode_tagdescription(tvbuff_t *tvb,
     offset += octet_count;
 
     proto_tree_add_item_ret_string(tree, hf_s7commp_tagdescr_name, tvb, offset, length_of_value, ENC_UTF_8|ENC_NA,
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-                                   WMEM_ALLOCATOR_SIMPLE
-#else
-                                   wmem_packet_scope()
-#endif
-                                   , &str_name);
+                                   pinfo->pool, &str_name);
     proto_item_append_text(tree, ": Name=%s", str_name);
     offset += length_of_value;
 
@@ -8921,13 +10466,14 @@ s7commp_decode_tagdescription(tvbuff_t *tvb,
     } else {
         proto_item_append_text(tree, " Type=Unknown softdatatype 0x%04x", vlq_value);
     }
+    symbol.softdatatype = vlq_value;
     offset += octet_count;
 
     proto_tree_add_bitmask(tree, tvb, offset, hf_s7commp_tagdescr_attributeflags,
         ett_s7commp_tagdescr_attributeflags, s7commp_tagdescr_attributeflags_fields, ENC_BIG_ENDIAN);
     offset += 4;
 
-    proto_tree_add_varuint32(tree, hf_s7commp_tagdescr_lid, tvb, offset, &octet_count);
+    proto_tree_add_ret_varuint32(tree, hf_s7commp_tagdescr_lid, tvb, offset, &octet_count, &symbol.lid);
     offset += octet_count;
 
     length_of_value = tvb_get_varuint32(tvb, &octet_count, offset);
@@ -8938,6 +10484,7 @@ s7commp_decode_tagdescription(tvbuff_t *tvb,
     if (datatype == S7COMMP_ITEM_DATATYPE_S7STRING) {
         proto_tree_add_uint(tree, hf_s7commp_tagdescr_s7stringlength, tvb, offset, octet_count, length_of_value);
     } else if (datatype == S7COMMP_ITEM_DATATYPE_STRUCT) {
+        symbol.struct_relid = length_of_value;
         proto_tree_add_uint(tree, hf_s7commp_tagdescr_structrelid, tvb, offset, octet_count, length_of_value);
     } else {
         proto_tree_add_uint(tree, hf_s7commp_tagdescr_lenunknown, tvb, offset, octet_count, length_of_value);
@@ -8974,7 +10521,8 @@ s7commp_decode_tagdescription(tvbuff_t *tvb,
             offset += octet_count;
             proto_tree_add_ret_varuint32(offsetinfo_tree, hf_s7commp_tagdescr_arrayelementcount, tvb, offset, &octet_count, &vlq_value);
             offset += octet_count;
-            proto_item_append_text(tree, "-Array[%d..%d]", svlq_value, svlq_value + (int32_t)(vlq_value - 1));
+            symbol.array_bounds = wmem_strdup_printf(pinfo->pool, "[%d..%d]", svlq_value, svlq_value + (int32_t)(vlq_value - 1));
+            proto_item_append_text(tree, "-Array%s", symbol.array_bounds);
             proto_tree_add_varuint32(offsetinfo_tree, hf_s7commp_tagdescr_paddingtype1, tvb, offset, &octet_count);
             offset += octet_count;
             proto_tree_add_varuint32(offsetinfo_tree, hf_s7commp_tagdescr_paddingtype2, tvb, offset, &octet_count);
@@ -9007,12 +10555,14 @@ s7commp_decode_tagdescription(tvbuff_t *tvb,
             if (number_of_array_dimensions > 6) {
                 number_of_array_dimensions = 6;
             }
-            proto_item_append_text(tree, "-Array[");
+            array_bounds = wmem_strbuf_new(pinfo->pool, "[");
             for (array_dimension = (number_of_array_dimensions - 1); array_dimension >= 0; array_dimension--) {
-                proto_item_append_text(tree, "%d..%d%s", mdarray_lowerbounds[array_dimension],
+                wmem_strbuf_append_printf(array_bounds, "%d..%d%s", mdarray_lowerbounds[array_dimension],
                     mdarray_lowerbounds[array_dimension] + (mdarray_elementcount[array_dimension] - 1),
                     (array_dimension > 0) ? ", " : "]");
             }
+            symbol.array_bounds = wmem_strbuf_get_str(array_bounds);
+            proto_item_append_text(tree, "-Array%s", symbol.array_bounds);
             break;
     }
     /* This doesn't fit in the scheme above, unknown what the two values are for */
@@ -9024,6 +10574,9 @@ s7commp_decode_tagdescription(tvbuff_t *tvb,
         offset += octet_count;
     }
     proto_item_set_len(offsetinfo_tree, offset - start_offset);
+    if (!PINFO_FD_VISITED(pinfo) && relid != 0) {
+        s7commp_add_symbol(pinfo, relid, &symbol, (const char *)str_name);
+    }
     return offset;
 }
 /*******************************************************************************************************
@@ -9034,7 +10587,9 @@ s7commp_decode_tagdescription(tvbuff_t *tvb,
 static uint32_t
 s7commp_decode_vartypelist(tvbuff_t *tvb,
                            proto_tree *tree,
-                           uint32_t offset)
+                           uint32_t offset,
+                           packet_info *pinfo,
+                           wmem_array_t *symbols)
 {
     uint32_t tag_start_offset;
     uint32_t max_offset;
@@ -9051,6 +10606,8 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
     int mdarray_actdimensions;
     int d;
     uint8_t offsetinfotype;
+    s7commp_symbol_t symbol;
+    wmem_strbuf_t *array_bounds = NULL;
 
     /* The variable typelist is a list of information-blocks, where a length of 0 indicates the end of the list.
      * Only the first block contains an additional 4-Byte ID (or flags?).
@@ -9071,6 +10628,9 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
             item = proto_tree_add_item(tree, hf_s7commp_element_tagdescription, tvb, offset, -1, ENC_NA);
             tag_tree = proto_item_add_subtree(item, ett_s7commp_element_tagdescription);
 
+            symbol.lid = tvb_get_letohl(tvb, offset);
+            symbol.struct_relid = 0;
+            symbol.array_bounds = NULL;
             proto_tree_add_item(tag_tree, hf_s7commp_tagdescr_lid, tvb, offset, 4, ENC_LITTLE_ENDIAN);
             offset += 4;
 
@@ -9086,6 +10646,7 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
             softdatatype = tvb_get_uint8(tvb, offset);
             proto_tree_add_uint(tag_tree, hf_s7commp_tagdescr_softdatatype, tvb, offset, 1, softdatatype);
             offset += 1;
+            symbol.softdatatype = softdatatype;
 
             if ((str_type = try_val_to_str_ext(softdatatype, &tagdescr_softdatatype_names_ext))) {
                 proto_item_append_text(tag_tree, "[%d]: Type=%s", i, str_type);
@@ -9181,6 +10742,7 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
             switch (offsetinfotype) {
                 case S7COMMP_TAGDESCR_OFFSETINFOTYPE2_FB_ARRAY:
                 case S7COMMP_TAGDESCR_OFFSETINFOTYPE2_FBSFB:
+                    symbol.struct_relid = tvb_get_letohl(tvb, offset);
                     proto_tree_add_item(tag_tree, hf_s7commp_tagdescr_fb_sfb_relid, tvb, offset, 4, ENC_LITTLE_ENDIAN);
                     offset += 4;
                     proto_tree_add_item(tag_tree, hf_s7commp_tagdescr_fb_sfb_info4, tvb, offset, 4, ENC_LITTLE_ENDIAN);
@@ -9211,6 +10773,9 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
                     proto_tree_add_item(tag_tree, hf_s7commp_tagdescr_arrayelementcount, tvb, offset, 4, ENC_LITTLE_ENDIAN);
                     offset += 4;
                     proto_item_append_text(tag_tree, "-Array[%d..%d]", array_lowerbounds, array_lowerbounds + (array_elementcount - 1));
+                    if (symbols != NULL) {
+                        symbol.array_bounds = wmem_strdup_printf(pinfo->pool, "[%d..%d]", array_lowerbounds, array_lowerbounds + (array_elementcount - 1));
+                    }
                     break;
                 case S7COMMP_TAGDESCR_OFFSETINFOTYPE2_ARRAYMDIM:
                 case S7COMMP_TAGDESCR_OFFSETINFOTYPE2_STRUCTELEM_ARRAYMDIM:
@@ -9259,16 +10824,18 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
                         offset += 4;
                     }
                     /* Displaystyle [a..b, c..d, e..f] */
-                    proto_item_append_text(tag_tree, "-Array[");
+                    array_bounds = wmem_strbuf_new(pinfo->pool, "[");
                     for (d = (mdarray_actdimensions - 1); d >= 0; d--) {
                         if (mdarray_elementcount[d] > 0) {
-                            proto_item_append_text(tag_tree, "%d..%d", mdarray_lowerbounds[d], mdarray_lowerbounds[d] + (mdarray_elementcount[d] - 1));
+                            wmem_strbuf_append_printf(array_bounds, "%d..%d", mdarray_lowerbounds[d], mdarray_lowerbounds[d] + (mdarray_elementcount[d] - 1));
                             if (d > 0) {
-                                proto_item_append_text(tag_tree, ", ");
+                                wmem_strbuf_append(array_bounds, ", ");
                             }
                         }
                     }
-                    proto_item_append_text(tag_tree, "]");
+                    wmem_strbuf_append(array_bounds, "]");
+                    proto_item_append_text(tag_tree, "-Array%s", wmem_strbuf_get_str(array_bounds));
+                    symbol.array_bounds = wmem_strbuf_get_str(array_bounds);
                     break;
             }
 
@@ -9286,6 +10853,7 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
                     /* Falls through */
                 case S7COMMP_TAGDESCR_OFFSETINFOTYPE2_STRUCT:
                 case S7COMMP_TAGDESCR_OFFSETINFOTYPE2_STRUCTELEM_STRUCT:
+                    symbol.struct_relid = tvb_get_letohl(tvb, offset);
                     proto_tree_add_item(tag_tree, hf_s7commp_tagdescr_structrelid, tvb, offset, 4, ENC_LITTLE_ENDIAN);
                     offset += 4;
                     proto_tree_add_item(tag_tree, hf_s7commp_tagdescr_struct_info4, tvb, offset, 4, ENC_LITTLE_ENDIAN);
@@ -9299,6 +10867,9 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
                     break;
             }
             proto_item_set_len(tag_tree, offset - tag_start_offset);
+            if (symbols != NULL) {
+                wmem_array_append_one(symbols, symbol);
+            }
             i++;
         } while (offset < max_offset);
         block_len = tvb_get_ntohs(tvb, offset);
@@ -9316,8 +10887,10 @@ s7commp_decode_vartypelist(tvbuff_t *tvb,
  *******************************************************************************************************/
 static uint32_t
 s7commp_decode_varnamelist(tvbuff_t *tvb,
+                           packet_info *pinfo,
                            proto_tree *tree,
-                           uint32_t offset)
+                           uint32_t offset,
+                           wmem_array_t *symbol_names)
 {
     uint8_t length_of_value;
     uint32_t max_offset;
@@ -9341,15 +10914,11 @@ s7commp_decode_varnamelist(tvbuff_t *tvb,
             proto_tree_add_uint(tag_tree, hf_s7commp_tagdescr_namelength, tvb, offset, 1, length_of_value);
             offset += 1;
             proto_tree_add_item_ret_string(tag_tree, hf_s7commp_tagdescr_name, tvb, offset, length_of_value, ENC_UTF_8|ENC_NA,
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-                                           WMEM_ALLOCATOR_SIMPLE
-#else
-                                           wmem_packet_scope()
-#endif
-                                           , &str_name);
+                                           pinfo->pool, &str_name);
             proto_item_append_text(tag_tree, "[%d]: Name=%s", i, str_name);
+            if (symbol_names != NULL) {
+                wmem_array_append_one(symbol_names, str_name);
+            }
             offset += length_of_value;
             /* Although the string length is given before, we have a possibly terminating null here */
             proto_tree_add_item(tag_tree, hf_s7commp_tagdescr_unknown2, tvb, offset, 1, ENC_BIG_ENDIAN);
@@ -9364,9 +10933,40 @@ s7commp_decode_varnamelist(tvbuff_t *tvb,
 
     return offset;
 }
+/* An object of the object decoding, with the element which was decoded last */
+typedef struct {
+    proto_tree *tree;                   /* Tree of the object elements */
+    proto_tree *data_item_tree;         /* Last element */
+    uint32_t start_offset;              /* Start of the object element which contains the object */
+    uint32_t relid;
+    wmem_array_t *symbol_types;
+    wmem_array_t *symbol_names;
+} s7commp_object_level_t;
+
+static void
+s7commp_object_level_init(s7commp_object_level_t *level,
+                          packet_info *pinfo,
+                          proto_tree *tree,
+                          uint32_t start_offset,
+                          uint32_t relid)
+{
+    level->tree = tree;
+    level->data_item_tree = NULL;
+    level->start_offset = start_offset;
+    level->relid = relid;
+    /* The symbols of the type information are collected only once, on the first pass */
+    if (!PINFO_FD_VISITED(pinfo) && (relid != 0)) {
+        level->symbol_types = wmem_array_new(pinfo->pool, sizeof(s7commp_symbol_t));
+        level->symbol_names = wmem_array_new(pinfo->pool, sizeof(const char *));
+    } else {
+        level->symbol_types = NULL;
+        level->symbol_names = NULL;
+    }
+}
 /*******************************************************************************************************
  *
  * Decodes a list of following fields per set: Syntax-ID, ID, datatype-flags, datatype, value
+ * Objects inside the object are decoded in the same loop, the enclosing objects are kept on an explicit stack.
  *
  *******************************************************************************************************/
 static uint32_t
@@ -9378,7 +10978,6 @@ s7commp_decode_object(tvbuff_t *tvb,
                       bool append_class)
 {
     proto_item *data_item = NULL;
-    proto_tree *data_item_tree = NULL;
     proto_item *pi = NULL;
     uint32_t start_offset;
     uint32_t uint32_value;
@@ -9386,103 +10985,129 @@ s7commp_decode_object(tvbuff_t *tvb,
     uint32_t uint32_value_clsid;
     uint8_t octet_count = 0;
     uint8_t element_id;
-    bool terminate = false;
-
-    do {
+    bool terminate;
+    s7commp_decode_budget_t *budget = s7commp_get_decode_budget(pinfo);
+    s7commp_object_level_t levels[S7COMMP_DECODE_MAX_DEPTH];
+    s7commp_object_level_t *level;
+    int depth = 0;
+
+    s7commp_decode_budget_enter(budget, tvb, pinfo, tree, offset);
+    level = &levels[0];
+    s7commp_object_level_init(level, pinfo, tree, offset, relid);
+
+    for (;;) {
+        terminate = false;
         start_offset = offset;
         element_id = tvb_get_uint8(tvb, offset);
+        s7commp_decode_budget_count(budget, tvb, pinfo, level->tree, offset);
         switch (element_id) {
             case S7COMMP_ITEMVAL_ELEMENTID_STARTOBJECT:
-                data_item = proto_tree_add_item(tree, hf_s7commp_element_object, tvb, offset, -1, ENC_NA);
-                data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_object);
-                proto_tree_add_uint(data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
+                data_item = proto_tree_add_item(level->tree, hf_s7commp_element_object, tvb, offset, -1, ENC_NA);
+                level->data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_object);
+                proto_tree_add_uint(level->data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
                 offset += 1;
                 uint32_value_relid = tvb_get_ntohl(tvb, offset);
-                proto_tree_add_uint(data_item_tree, hf_s7commp_object_relid, tvb, offset, 4, uint32_value_relid);
+                proto_tree_add_uint(level->data_item_tree, hf_s7commp_object_relid, tvb, offset, 4, uint32_value_relid);
                 offset += 4;
-                proto_tree_add_ret_varuint32(data_item_tree, hf_s7commp_object_classid, tvb, offset, &octet_count, &uint32_value_clsid);
-                if ((pinfo != NULL) && append_class) {
+                proto_tree_add_ret_varuint32(level->data_item_tree, hf_s7commp_object_classid, tvb, offset, &octet_count, &uint32_value_clsid);
+                if (append_class) {
                     s7commp_pinfo_append_idname(pinfo, uint32_value_clsid, NULL);
                     s7commp_pinfo_append_idname(pinfo, uint32_value_relid, " / ");
                 }
-                s7commp_proto_item_append_idname(data_item_tree, uint32_value_clsid, ": ClsId=");
-                s7commp_proto_item_append_idname(data_item_tree, uint32_value_relid, ", RelId=");
+                s7commp_proto_item_append_idname(level->data_item_tree, uint32_value_clsid, ": ClsId=");
+                s7commp_proto_item_append_idname(level->data_item_tree, uint32_value_relid, ", RelId=");
                 offset += octet_count;
                 uint32_value = tvb_get_varuint32(tvb, &octet_count, offset);
-                pi = proto_tree_add_bitmask_value(data_item_tree, tvb, offset, hf_s7commp_object_classflags,
+                pi = proto_tree_add_bitmask_value(level->data_item_tree, tvb, offset, hf_s7commp_object_classflags,
                     ett_s7commp_object_classflags, s7commp_object_classflags_fields, uint32_value);
                 proto_item_set_len(pi, octet_count);
                 offset += octet_count;
-                proto_tree_add_ret_varuint32(data_item_tree, hf_s7commp_object_attributeid, tvb, offset, &octet_count, &uint32_value);
+                proto_tree_add_ret_varuint32(level->data_item_tree, hf_s7commp_object_attributeid, tvb, offset, &octet_count, &uint32_value);
                 offset += octet_count;
                 if (uint32_value != 0) {
-                    proto_tree_add_varuint32(data_item_tree, hf_s7commp_object_attributeidflags, tvb, offset, &octet_count);
+                    proto_tree_add_varuint32(level->data_item_tree, hf_s7commp_object_attributeidflags, tvb, offset, &octet_count);
                     offset += octet_count;
                 }
-                offset = s7commp_decode_object(tvb, pinfo, data_item_tree, offset, uint32_value_relid, append_class);
-                proto_item_set_len(data_item_tree, offset - start_offset);
+                /* The elements of the new object follow */
+                s7commp_decode_budget_enter(budget, tvb, pinfo, level->data_item_tree, offset);
+                depth++;
+                s7commp_object_level_init(&levels[depth], pinfo, level->data_item_tree, start_offset, uint32_value_relid);
+                level = &levels[depth];
                 break;
             case S7COMMP_ITEMVAL_ELEMENTID_TERMOBJECT:
-                proto_tree_add_uint(tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
+                proto_tree_add_uint(level->tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
                 offset += 1;
                 terminate = true;
                 break;
             case S7COMMP_ITEMVAL_ELEMENTID_RELATION:
-                data_item = proto_tree_add_item(tree, hf_s7commp_element_relation, tvb, offset, -1, ENC_NA);
-                data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_relation);
-                proto_tree_add_uint(data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
+                data_item = proto_tree_add_item(level->tree, hf_s7commp_element_relation, tvb, offset, -1, ENC_NA);
+                level->data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_relation);
+                proto_tree_add_uint(level->data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
                 offset += 1;
-                proto_tree_add_varuint32(data_item_tree, hf_s7commp_object_relid, tvb, offset, &octet_count);
+                proto_tree_add_varuint32(level->data_item_tree, hf_s7commp_object_relid, tvb, offset, &octet_count);
                 offset += octet_count;
-                proto_tree_add_item(data_item_tree, hf_s7commp_object_relunknown1, tvb, offset, 4, ENC_BIG_ENDIAN);
+                proto_tree_add_item(level->data_item_tree, hf_s7commp_object_relunknown1, tvb, offset, 4, ENC_BIG_ENDIAN);
                 offset += 4;
-                proto_item_set_len(data_item_tree, offset - start_offset);
+                proto_item_set_len(level->data_item_tree, offset - start_offset);
                 break;
             case S7COMMP_ITEMVAL_ELEMENTID_STARTTAGDESC:
-                data_item = proto_tree_add_item(tree, hf_s7commp_element_tagdescription, tvb, offset, -1, ENC_NA);
-                data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_tagdescription);
-                proto_tree_add_uint(data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
+                data_item = proto_tree_add_item(level->tree, hf_s7commp_element_tagdescription, tvb, offset, -1, ENC_NA);
+                level->data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_tagdescription);
+                proto_tree_add_uint(level->data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
                 offset += 1;
-                offset = s7commp_decode_tagdescription(tvb, data_item_tree, offset);
-                proto_item_set_len(data_item_tree, offset - start_offset);
+                offset = s7commp_decode_tagdescription(tvb, level->data_item_tree, offset, pinfo, level->relid);
+                proto_item_set_len(level->data_item_tree, offset - start_offset);
                 break;
             case S7COMMP_ITEMVAL_ELEMENTID_TERMTAGDESC:
-                proto_tree_add_uint(data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
+                proto_tree_add_uint(level->data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
                 offset += 1;
-                proto_item_set_len(data_item_tree, offset - start_offset);
+                proto_item_set_len(level->data_item_tree, offset - start_offset);
                 break;
             case S7COMMP_ITEMVAL_ELEMENTID_VARNAMELIST:
-                data_item = proto_tree_add_item(tree, hf_s7commp_element_block, tvb, offset, -1, ENC_NA);
-                data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_block);
-                proto_tree_add_uint(data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
+                data_item = proto_tree_add_item(level->tree, hf_s7commp_element_block, tvb, offset, -1, ENC_NA);
+                level->data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_block);
+                proto_tree_add_uint(level->data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
                 offset += 1;
-                proto_item_append_text(data_item_tree, ": VarnameList");
-                offset = s7commp_decode_varnamelist(tvb, data_item_tree, offset);
-                proto_item_set_len(data_item_tree, offset - start_offset);
+                proto_item_append_text(level->data_item_tree, ": VarnameList");
+                offset = s7commp_decode_varnamelist(tvb, pinfo, level->data_item_tree, offset, level->symbol_names);
+                proto_item_set_len(level->data_item_tree, offset - start_offset);
                 break;
             case S7COMMP_ITEMVAL_ELEMENTID_VARTYPELIST:
-                data_item = proto_tree_add_item(tree, hf_s7commp_element_block, tvb, offset, -1, ENC_NA);
-                data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_block);
-                proto_tree_add_uint(data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
+                data_item = proto_tree_add_item(level->tree, hf_s7commp_element_block, tvb, offset, -1, ENC_NA);
+                level->data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_block);
+                proto_tree_add_uint(level->data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
                 offset += 1;
-                proto_item_append_text(data_item_tree, ": VartypeList");
-                offset = s7commp_decode_vartypelist(tvb, data_item_tree, offset);
-                proto_item_set_len(data_item_tree, offset - start_offset);
+                proto_item_append_text(level->data_item_tree, ": VartypeList");
+                offset = s7commp_decode_vartypelist(tvb, level->data_item_tree, offset, pinfo, level->symbol_types);
+                proto_item_set_len(level->data_item_tree, offset - start_offset);
                 break;
             case S7COMMP_ITEMVAL_ELEMENTID_ATTRIBUTE:
-                data_item = proto_tree_add_item(tree, hf_s7commp_element_attribute, tvb, offset, -1, ENC_NA);
-                data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_attribute);
-                proto_tree_add_uint(data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
+                data_item = proto_tree_add_item(level->tree, hf_s7commp_element_attribute, tvb, offset, -1, ENC_NA);
+                level->data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_element_attribute);
+                proto_tree_add_uint(level->data_item_tree, hf_s7commp_itemval_elementid, tvb, offset, 1, element_id);
                 offset += 1;
-                offset = s7commp_decode_id_value_list(tvb, pinfo, data_item_tree, offset, relid, false, false);
-                proto_item_set_len(data_item_tree, offset - start_offset);
+                offset = s7commp_decode_id_value_list(tvb, pinfo, level->data_item_tree, offset, level->relid, false, false);
+                proto_item_set_len(level->data_item_tree, offset - start_offset);
                 break;
             default:
                 terminate = true;
         }
-    } while (terminate == false);
-
-    return offset;
+        if (terminate) {
+            /* VartypeList and VarnameList describe the same variables in the same order */
+            if (level->symbol_types != NULL) {
+                s7commp_add_symbol_lists(pinfo, level->relid, level->symbol_types, level->symbol_names);
+            }
+            s7commp_decode_budget_leave(budget);
+            if (depth == 0) {
+                return offset;
+            }
+            /* Back to the enclosing object, its last element is the object which ends here */
+            start_offset = level->start_offset;
+            depth--;
+            level = &levels[depth];
+            proto_item_set_len(level->data_item_tree, offset - start_offset);
+        }
+    }
 }
 /*******************************************************************************************************
  *
@@ -9512,7 +11137,7 @@ s7commp_decode_request_createobject(tvbuff_t *tvb,
     s7commp_proto_item_append_idname(data_item_tree, id_number, ": ID=");
     s7commp_pinfo_append_idname(pinfo, id_number, NULL);
     offset += 4;
-    offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, id_number, 0, ENC_NA);
+    offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, id_number, 0, ENC_NA, NULL);
     proto_item_set_len(data_item_tree, offset - start_offset);
     /* 4 bytes with zeros (as seen so far) */
     proto_tree_add_item(tree, hf_s7commp_object_createobjrequnknown1, tvb, offset, 4, ENC_BIG_ENDIAN);
@@ -9548,6 +11173,7 @@ s7commp_decode_response_createobject(tvbuff_t *tvb,
     int i;
     uint16_t errorcode = 0;
     bool errorextension = false;
+    s7commp_transaction_t *trans;
 
     offset = s7commp_decode_returnvalue(tvb, pinfo, tree, offset, false, &errorcode, &errorextension);
     object_id_count = tvb_get_uint8(tvb, offset);
@@ -9560,6 +11186,10 @@ s7commp_decode_response_createobject(tvbuff_t *tvb,
         offset += octet_count;
         /* add result object ids to info column, usually it's only one single id */
         if (i == 0) {
+            /* A subscription created by the request is known by this object id from now on */
+            if (!pinfo->fd->visited && (trans = s7commp_get_transaction(pinfo)) != NULL && trans->subscription != NULL) {
+                wmem_tree_insert32(s7commp_get_conv_info(pinfo)->subscriptions, object_id, (void *)trans->subscription);
+            }
             s7commp_pinfo_append_idname(pinfo, object_id, " ObjId=");
         } else {
             s7commp_pinfo_append_idname(pinfo, object_id, ", ");
@@ -9699,12 +11329,9 @@ s7commp_decode_item_address_part2(tvbuff_t *tvb,
                                   uint32_t id_value,
                                   uint32_t crc,
                                   uint32_t lid_nest_depth,
-                                  uint32_t offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                  ,
-                                  packet_info *pinfo
-#endif
-    )
+                                  char *addr_seq,
+                                  uint32_t offset,
+                                  packet_info *pinfo)
 {
     uint32_t value = 0;
     uint32_t lid_cnt;
@@ -9718,7 +11345,11 @@ s7commp_decode_item_address_part2(tvbuff_t *tvb,
     uint32_t start_offset;
     proto_item *pi = NULL;
     int str_len = 0;
-    char addr_filter_seq_str[256];
+    char addr_filter_seq_str[S7COMMP_ITEMADDR_SEQ_LEN];
+    uint32_t sym_relid;
+    const s7commp_symbol_t *sym = NULL;
+    wmem_strbuf_t *sym_path = NULL;
+    bool sym_resolved = false;
 
     /* 4th field is a ID from the id-list which gives the type of value which has to be accessed.
      * For example to read Marker (M) 3736 = ControllerArea.ValueActual is used.
@@ -9814,10 +11445,32 @@ s7commp_decode_item_address_part2(tvbuff_t *tvb,
                 *number_of_fields += 1;
             }
         } else {
-            /* Standard for access via symbolic name with CRC and LIDs */
+            /* Standard for access via symbolic name with CRC and LIDs.
+             * The names of the LIDs are known, if the type information was explored before.
+             * The LIDs of a struct or FB instance are in the type information of the struct.
+             */
+            sym_relid = s7commp_get_area_typeinfo_relid(id_value);
+            sym_resolved = (sym_relid != 0) && (lid_nest_depth >= 2);
+            if (sym_resolved) {
+                sym_path = wmem_strbuf_new(pinfo->pool, "");
+            }
             proto_item_append_text(tree, ", LID=");
             for (lid_cnt = 2; lid_cnt <= lid_nest_depth; lid_cnt++) {
                 value = tvb_get_varuint32(tvb, &octet_count, offset);
+                if (sym_resolved) {
+                    sym = (sym_relid != 0) ? s7commp_lookup_symbol(pinfo, sym_relid, value) : NULL;
+                    if (sym != NULL) {
+                        wmem_strbuf_append_printf(sym_path, "%s%s", (lid_cnt > 2) ? "." : "", sym->name);
+                        /* The LIDs after an array are element indices, not in the type information */
+                        sym_relid = (sym->array_bounds == NULL) ? sym->struct_relid : 0;
+                    } else if (lid_cnt > 2) {
+                        /* e.g. an array element, show the remaining LIDs as they are */
+                        wmem_strbuf_append_printf(sym_path, ".%X", value);
+                        sym_relid = 0;
+                    } else {
+                        sym_resolved = false;
+                    }
+                }
                 proto_tree_add_uint(tree, hf_s7commp_itemaddr_lid_value, tvb, offset, octet_count, value);
                 if (lid_cnt == lid_nest_depth) {
                     proto_item_append_text(tree, "%X", value);
@@ -9834,6 +11487,22 @@ s7commp_decode_item_address_part2(tvbuff_t *tvb,
     pi = proto_tree_add_string_format(tree, hf_s7commp_itemaddr_filter_sequence, tvb, start_offset,
         offset - start_offset, addr_filter_seq_str, "Item address sequence: %s", addr_filter_seq_str);
     PROTO_ITEM_SET_GENERATED(pi);
+    if (sym_resolved) {
+        pi = proto_tree_add_string(tree, hf_s7commp_itemaddr_symbol, tvb, start_offset, offset - start_offset, wmem_strbuf_get_str(sym_path));
+        PROTO_ITEM_SET_GENERATED(pi);
+        proto_item_append_text(tree, ", Symbol=%s", wmem_strbuf_get_str(sym_path));
+        /* Type only if the last LID is a known symbol */
+        if (sym != NULL) {
+            pi = proto_tree_add_uint(tree, hf_s7commp_itemaddr_symbol_softdatatype, tvb, start_offset, offset - start_offset, sym->softdatatype);
+            PROTO_ITEM_SET_GENERATED(pi);
+            if (sym->array_bounds != NULL) {
+                proto_item_append_text(pi, "-Array%s", sym->array_bounds);
+            }
+        }
+    }
+    if (addr_seq != NULL) {
+        g_strlcpy(addr_seq, addr_filter_seq_str, S7COMMP_ITEMADDR_SEQ_LEN);
+    }
     return offset;
 }
 /*******************************************************************************************************
@@ -9846,12 +11515,8 @@ s7commp_decode_item_address(tvbuff_t *tvb,
                             proto_tree *tree,
                             uint32_t *number_of_fields,
                             uint32_t item_nr,
-                            uint32_t offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                  ,
-                            packet_info *pinfo
-#endif
-    )
+                            uint32_t offset,
+                            packet_info *pinfo)
 {
     proto_item *adr_item = NULL;
     proto_tree *adr_item_tree = NULL;
@@ -9860,6 +11525,7 @@ s7commp_decode_item_address(tvbuff_t *tvb,
     uint32_t crc = 0;
     uint32_t lid_nest_depth = 0;
     uint32_t start_offset = offset;
+    char addr_seq[S7COMMP_ITEMADDR_SEQ_LEN];
 
     *number_of_fields = 0;
 
@@ -9905,12 +11571,8 @@ s7commp_decode_item_address(tvbuff_t *tvb,
     offset += octet_count;
     *number_of_fields += 1;
 
-    offset = s7commp_decode_item_address_part2(tvb, adr_item_tree, number_of_fields, id_value, crc, lid_nest_depth, offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                               ,
-                                               pinfo
-#endif
-        );
+    offset = s7commp_decode_item_address_part2(tvb, adr_item_tree, number_of_fields, id_value, crc, lid_nest_depth, addr_seq, offset, pinfo);
+    s7commp_add_trans_item_address(pinfo, addr_seq);
 
     proto_item_set_len(adr_item_tree, offset - start_offset);
 
@@ -9923,6 +11585,7 @@ s7commp_decode_item_address(tvbuff_t *tvb,
  * Derived from s7commp_decode_item_address() with the differences:
  * - "Symbol-CRC" and "Access base-area" swap the order
  * - "Number of following IDs" is not a single value, but coded in 16 bits of a 32 bit VLQ
+ * Returns the reference number and the item address sequence in refnumber and addr_seq.
  *
  *******************************************************************************************************/
 static uint32_t
@@ -9930,12 +11593,10 @@ s7commp_decode_item_address_sub(tvbuff_t *tvb,
                                 proto_tree *tree,
                                 uint32_t *number_of_fields,
                                 uint32_t item_nr,
-                                uint32_t offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                ,
-                                packet_info *pinfo
-#endif
-    )
+                                uint32_t *refnumber,
+                                char *addr_seq,
+                                uint32_t offset,
+                                packet_info *pinfo)
 {
     proto_item *adr_item = NULL;
     proto_tree *adr_item_tree = NULL;
@@ -9965,7 +11626,7 @@ s7commp_decode_item_address_sub(tvbuff_t *tvb,
     offset += octet_count;
     *number_of_fields += 1;
 
-    proto_tree_add_varuint32(adr_item_tree, hf_s7commp_notification_vl_refnumber, tvb, offset, &octet_count);
+    proto_tree_add_ret_varuint32(adr_item_tree, hf_s7commp_notification_vl_refnumber, tvb, offset, &octet_count, refnumber);
     offset += octet_count;
     *number_of_fields += 1;
 
@@ -9980,12 +11641,7 @@ s7commp_decode_item_address_sub(tvbuff_t *tvb,
     offset += octet_count;
     *number_of_fields += 1;
 
-    offset = s7commp_decode_item_address_part2(tvb, adr_item_tree, number_of_fields, id_value, crc, lid_nest_depth, offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                               ,
-                                               pinfo
-#endif
-        );
+    offset = s7commp_decode_item_address_part2(tvb, adr_item_tree, number_of_fields, id_value, crc, lid_nest_depth, addr_seq, offset, pinfo);
 
     proto_item_set_len(adr_item_tree, offset - start_offset);
 
@@ -10011,10 +11667,13 @@ s7commp_decode_request_setmultivar(tvbuff_t *tvb,
     uint32_t item_address_count;
     uint32_t id_number;
     uint32_t id_number_offset;
+    uint32_t *id_numbers;
+    uint8_t *id_octet_counts;
     uint32_t offset_save;
     proto_item *list_item = NULL;
     proto_tree *list_item_tree = NULL;
     uint32_t list_start_offset;
+    s7commp_transaction_t *trans;
 
     /* When the first 4 bytes are all zero, then this is a "standard" write command.
      * When this value is the session-id (!= 0), then the structure is different.
@@ -10036,12 +11695,7 @@ s7commp_decode_request_setmultivar(tvbuff_t *tvb,
         list_item = proto_tree_add_item(tree, hf_s7commp_addresslist, tvb, offset, -1, ENC_NA);
         list_item_tree = proto_item_add_subtree(list_item, ett_s7commp_addresslist);
         for (i = 1; i <= item_count; i++) {
-            offset = s7commp_decode_item_address(tvb, list_item_tree, &number_of_fields, i, offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                                 ,
-                                                 pinfo
-#endif
-                );
+            offset = s7commp_decode_item_address(tvb, list_item_tree, &number_of_fields, i, offset, pinfo);
         }
         proto_item_set_len(list_item_tree, offset - list_start_offset);
 
@@ -10064,9 +11718,11 @@ s7commp_decode_request_setmultivar(tvbuff_t *tvb,
         list_item = proto_tree_add_item(tree, hf_s7commp_addresslist, tvb, offset, -1, ENC_NA);
         list_item_tree = proto_item_add_subtree(list_item, ett_s7commp_addresslist);
         id_number_offset = offset;  /* Startaddress of 1st ID */
+        /* The IDs are decoded once, they are needed again for the values */
+        tvb_get_varuint32_array(tvb, offset, item_address_count, pinfo->pool, &id_numbers, &id_octet_counts);
         for (i = 1; i <= item_address_count; i++) {
-            proto_tree_add_varuint32(list_item_tree, hf_s7commp_data_id_number, tvb, offset, &octet_count);
-            offset += octet_count;
+            proto_tree_add_uint(list_item_tree, hf_s7commp_data_id_number, tvb, offset, id_octet_counts[i - 1], id_numbers[i - 1]);
+            offset += id_octet_counts[i - 1];
         }
         proto_item_set_len(list_item_tree, offset - list_start_offset);
 
@@ -10074,20 +11730,28 @@ s7commp_decode_request_setmultivar(tvbuff_t *tvb,
         list_item = proto_tree_add_item(tree, hf_s7commp_valuelist, tvb, offset, -1, ENC_NA);
         list_item_tree = proto_item_add_subtree(list_item, ett_s7commp_valuelist);
         for (i = 1; i <= item_count; i++) {
-            /* Readout the related ID again, to get the ID for the complete dataset for further dissection */
-            id_number = tvb_get_varuint32(tvb, &octet_count, id_number_offset);
+            /* Use the related ID again, to get the ID for the complete dataset for further dissection */
+            if (i <= item_address_count) {
+                id_number = id_numbers[i - 1];
+                octet_count = id_octet_counts[i - 1];
+            } else {
+                id_number = tvb_get_varuint32(tvb, &octet_count, id_number_offset);
+            }
             id_number_offset += octet_count;
             offset_save = offset;
             offset = s7commp_decode_itemnumber_value_list(tvb, pinfo, list_item_tree, offset, value, false);
             /* Decode ID 1048 = SubscriptionReferenceList with more details, useful for standard HMI diagnosis */
             if (id_number == 1048) {
+                /* The list modifies the subscription with this object id */
+                if (!pinfo->fd->visited && (trans = s7commp_get_transaction(pinfo)) != NULL) {
+                    trans->subscription = s7commp_get_subscription(pinfo, value);
+                }
                 tvb_get_varuint32(tvb, &octet_count, offset); /* get length of the item-number element */
-                s7commp_decode_attrib_subscriptionreflist(tvb, list_item_tree, offset_save + octet_count
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                                          ,
-                                                          pinfo
-#endif
-                    );
+                s7commp_decode_attrib_subscriptionreflist(tvb, list_item_tree, offset_save + octet_count, pinfo);
+            } else if (id_number == 1053 && !pinfo->fd->visited) {
+                /* SubscriptionCreditLimit, the client increments the credit of the subscription with this object id */
+                tvb_get_varuint32(tvb, &octet_count, offset_save);
+                s7commp_decode_attrib_subscriptioncreditlimit(tvb, offset_save + octet_count, s7commp_get_subscription(pinfo, value));
             }
         }
         proto_item_set_len(list_item_tree, offset - list_start_offset);
@@ -10105,12 +11769,8 @@ s7commp_decode_request_setmultivar(tvbuff_t *tvb,
 static uint32_t
 s7commp_decode_request_getmultivar(tvbuff_t *tvb,
                                    proto_tree *tree,
-                                   uint32_t offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                   ,
-                                   packet_info *pinfo
-#endif
-    )
+                                   uint32_t offset,
+                                   packet_info *pinfo)
 {
     uint32_t item_count = 0;
     uint32_t i = 0;
@@ -10139,12 +11799,7 @@ s7commp_decode_request_getmultivar(tvbuff_t *tvb,
         list_item = proto_tree_add_item(tree, hf_s7commp_addresslist, tvb, offset, -1, ENC_NA);
         list_item_tree = proto_item_add_subtree(list_item, ett_s7commp_addresslist);
         for (i = 1; i <= item_count; i++) {
-            offset = s7commp_decode_item_address(tvb, list_item_tree, &number_of_fields, i, offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                                 ,
-                                                 pinfo
-#endif
-                );
+            offset = s7commp_decode_item_address(tvb, list_item_tree, &number_of_fields, i, offset, pinfo);
         }
         proto_item_set_len(list_item_tree, offset - list_start_offset);
     } else {
@@ -10203,6 +11858,35 @@ s7commp_decode_response_setmultivar(tvbuff_t *tvb,
     offset = s7commp_decode_itemnumber_errorvalue_list(tvb, tree, offset);
     return offset;
 }
+/*******************************************************************************************************
+ *
+ * Show the address of the item which was subscribed with the reference number
+ *
+ *******************************************************************************************************/
+static void
+s7commp_add_subscr_item_info(tvbuff_t *tvb,
+                             packet_info *pinfo,
+                             proto_tree *tree,
+                             uint32_t offset,
+                             uint32_t subscr_object_id,
+                             uint32_t refnumber)
+{
+    const s7commp_subscr_item_t *sub_item;
+    proto_item *pi;
+
+    if (tree == NULL) {
+        return;
+    }
+    sub_item = s7commp_lookup_subscr_item(pinfo, subscr_object_id, refnumber);
+    if (sub_item == NULL) {
+        return;
+    }
+    pi = proto_tree_add_string(tree, hf_s7commp_notification_vl_address, tvb, offset, 4, sub_item->address);
+    PROTO_ITEM_SET_GENERATED(pi);
+    pi = proto_tree_add_uint(tree, hf_s7commp_notification_vl_subscribed_in, tvb, offset, 4, sub_item->first_frame);
+    PROTO_ITEM_SET_GENERATED(pi);
+    proto_item_append_text(tree, " Address=%s", sub_item->address);
+}
 /*******************************************************************************************************
  *
  * Notification Value List
@@ -10213,6 +11897,7 @@ s7commp_decode_notification_value_list(tvbuff_t *tvb,
                                        packet_info *pinfo,
                                        proto_tree *tree,
                                        uint32_t offset,
+                                       uint32_t subscr_object_id,
                                        bool recursive)
 {
     proto_item *data_item = NULL;
@@ -10223,6 +11908,7 @@ s7commp_decode_notification_value_list(tvbuff_t *tvb,
     uint8_t item_return_value;
     int struct_level;
     int n_access_errors = 0;
+    s7commp_value_tap_info_t *value_info = NULL;
     /* Return value: If the value != 0 then follows a dataset with the common known structure.
      * If an access error occurs, we have here an error-value, in this case datatype==NULL.
      * TODO: The returncodes follow not any known structure. I've tried to reproduce some errors
@@ -10256,14 +11942,17 @@ s7commp_decode_notification_value_list(tvbuff_t *tvb,
                 /* Item reference number: Is sent to plc in the subscription-telegram for the addresses. */
                 item_number = tvb_get_ntohl(tvb, offset);
                 proto_tree_add_uint(data_item_tree, hf_s7commp_notification_vl_refnumber, tvb, offset, 4, item_number);
-                offset += 4;
                 proto_item_append_text(data_item_tree, " [%u]:", item_number);
-                offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false);
+                s7commp_add_subscr_item_info(tvb, pinfo, data_item_tree, offset, subscr_object_id, item_number);
+                offset += 4;
+                value_info = s7commp_new_value_tap_info(pinfo, true, subscr_object_id, item_number);
+                offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false, value_info);
             } else if (item_return_value == 0x9b) {
                 proto_tree_add_ret_varuint32(data_item_tree, hf_s7commp_data_id_number, tvb, offset, &octet_count, &item_number);
                 offset += octet_count;
                 proto_item_append_text(data_item_tree, " [%u]:", item_number);
-                offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false);
+                value_info = s7commp_new_value_tap_info(pinfo, true, subscr_object_id, item_number);
+                offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false, value_info);
             } else if (item_return_value == 0x9c) {
                 item_number = tvb_get_ntohl(tvb, offset);
                 proto_tree_add_uint(data_item_tree, hf_s7commp_notification_vl_unknown0x9c, tvb, offset, 4, item_number);
@@ -10273,17 +11962,22 @@ s7commp_decode_notification_value_list(tvbuff_t *tvb,
                 item_number = tvb_get_ntohl(tvb, offset);
                 proto_tree_add_uint(data_item_tree, hf_s7commp_notification_vl_refnumber, tvb, offset, 4, item_number);
                 proto_item_append_text(data_item_tree, " [%u]: Access error", item_number);
+                s7commp_add_subscr_item_info(tvb, pinfo, data_item_tree, offset, subscr_object_id, item_number);
                 offset += 4;
                 n_access_errors++;
             } else if (item_return_value == 0x81) {     /* Only in protocol version v1, but also used in S7-1500 in part 2 for ProgramAlarm */
                 offset = s7commp_decode_object(tvb, pinfo, data_item_tree, offset, 0, true);
             } else if (item_return_value == 0x83) {     /* Probably only in protocol version v1 */
-                offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false);
+                offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false, NULL);
             } else {
                 expert_add_info_format(pinfo, data_item_tree, &ei_s7commp_notification_returnvalue_unknown, "Notification unknown return value: 0x%02x", item_return_value);
                 proto_item_set_len(data_item_tree, offset - start_offset);
                 break;
             }
+            if (value_info != NULL && value_info->value != NULL) {
+                tap_queue_packet(s7commp_value_tap, pinfo, value_info);
+                value_info = NULL;
+            }
             if (struct_level > 0) {
                 offset = s7commp_decode_id_value_list(tvb, pinfo, data_item_tree, offset, 0, true, false);
             }
@@ -10293,6 +11987,62 @@ s7commp_decode_notification_value_list(tvbuff_t *tvb,
 
     return offset;
 }
+/*******************************************************************************************************
+ *
+ * Notification sequence analysis
+ *
+ * Compares the sequence number (or the credit tick, if the sequence number is not used) with the
+ * previous notification of the subscription, in the first pass. The result is kept with the frame.
+ * seqnum_mask is the range of the sequence number, 0xff for the 1 byte variant.
+ *
+ *******************************************************************************************************/
+static const s7commp_notif_info_t *
+s7commp_analyse_notification(packet_info *pinfo,
+                             uint32_t subscr_object_id,
+                             uint32_t seqnum,
+                             uint32_t seqnum_mask,
+                             uint8_t credit_tick)
+{
+    s7commp_notif_info_t *notif_info;
+    s7commp_subscription_t *sub;
+    uint32_t diff;
+
+    notif_info = (s7commp_notif_info_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_s7commp, S7COMMP_PROTO_DATA_NOTIF(pinfo->curr_layer_num));
+    if (notif_info != NULL || pinfo->fd->visited) {
+        return notif_info;
+    }
+    notif_info = wmem_new0(wmem_file_scope(), s7commp_notif_info_t);
+    sub = s7commp_get_subscription(pinfo, subscr_object_id);
+    notif_info->credit_limit = sub->credit_limit;
+
+    if (sub->last_notif_frame != 0) {
+        notif_info->prev_frame = sub->last_notif_frame;
+        nstime_delta(&notif_info->delta_time, &pinfo->abs_ts, &sub->last_notif_time);
+        if (seqnum != 0 || sub->last_seqnum != 0) {
+            diff = (seqnum - sub->last_seqnum) & seqnum_mask;
+        } else {
+            diff = (uint8_t)(credit_tick - sub->last_credit_tick);
+            seqnum_mask = 0xff;
+        }
+        /* A step backwards by more than half of the range is a restart, e.g. a new session */
+        if (diff == 0) {
+            notif_info->duplicate = true;
+        } else if (diff <= (seqnum_mask >> 1)) {
+            notif_info->missing = diff - 1;
+        }
+    }
+    /* The credit tick is one byte and wraps around, while the limit is incremented by the client without wrap */
+    if (sub->credit_limit > 0 && credit_tick == (uint8_t)sub->credit_limit) {
+        notif_info->credit_limit_reached = true;
+    }
+
+    sub->last_notif_frame = pinfo->num;
+    sub->last_notif_time = pinfo->abs_ts;
+    sub->last_seqnum = seqnum;
+    sub->last_credit_tick = credit_tick;
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_s7commp, S7COMMP_PROTO_DATA_NOTIF(pinfo->curr_layer_num), notif_info);
+    return notif_info;
+}
 /*******************************************************************************************************
  *
  * Notification
@@ -10306,16 +12056,20 @@ s7commp_decode_notification(tvbuff_t *tvb,
 {
     uint16_t unknown2;
     uint32_t subscr_object_id, subscr_object_id2;
-    uint8_t credit_tick;
+    uint8_t credit_tick = 0;
     uint8_t subscrccnt;
     uint64_t timeval_us;
     nstime_t tmptime;
     uint32_t seqnum;
+    uint32_t seqnum_mask;
     proto_item *list_item = NULL;
     proto_tree *list_item_tree = NULL;
+    proto_item *pi = NULL;
     uint8_t octet_count = 0;
     bool add_data_info_column = false;
     uint32_t list_start_offset;
+    const s7commp_notif_info_t *notif_info;
+    s7commp_tap_info_t *tap_info;
 
     subscr_object_id = tvb_get_ntohl(tvb, offset);
     proto_tree_add_uint(tree, hf_s7commp_notification_subscrobjectid, tvb, offset, 4, subscr_object_id);
@@ -10349,6 +12103,7 @@ s7commp_decode_notification(tvbuff_t *tvb,
          * Detecting this on the protocol version is not possible.
          */
         if (subscr_object_id < 0x70000000) {
+            seqnum_mask = 0xff;
             seqnum = tvb_get_uint8(tvb, offset);
             proto_tree_add_uint(tree, hf_s7commp_notification_seqnum_uint8, tvb, offset, 1, seqnum);
             offset += 1;
@@ -10361,6 +12116,7 @@ s7commp_decode_notification(tvbuff_t *tvb,
                 col_append_fstr(pinfo->cinfo, COL_INFO, " NSeq=%u", seqnum);
             }
         } else {
+            seqnum_mask = 0xffffffff;
             credit_tick = tvb_get_uint8(tvb, offset);
             proto_tree_add_uint(tree, hf_s7commp_notification_credittick, tvb, offset, 1, credit_tick);
             offset += 1;
@@ -10387,10 +12143,33 @@ s7commp_decode_notification(tvbuff_t *tvb,
             col_append_fstr(pinfo->cinfo, COL_INFO, " Ctick=%u NSeq=%u ChngCnt=%u", credit_tick, seqnum, subscrccnt);
         }
 
+        notif_info = s7commp_analyse_notification(pinfo, subscr_object_id, seqnum, seqnum_mask, credit_tick);
+        if (notif_info != NULL) {
+            if (notif_info->prev_frame != 0) {
+                pi = proto_tree_add_uint(tree, hf_s7commp_notification_prev_frame, tvb, 0, 0, notif_info->prev_frame);
+                PROTO_ITEM_SET_GENERATED(pi);
+                pi = proto_tree_add_time(tree, hf_s7commp_notification_delta_time, tvb, 0, 0, &notif_info->delta_time);
+                PROTO_ITEM_SET_GENERATED(pi);
+            }
+            if (notif_info->missing > 0) {
+                pi = proto_tree_add_uint(tree, hf_s7commp_notification_missing, tvb, 0, 0, notif_info->missing);
+                PROTO_ITEM_SET_GENERATED(pi);
+                expert_add_info_format(pinfo, pi, &ei_s7commp_notification_seqnum_missing,
+                    "%u notification(s) missing before this one", notif_info->missing);
+            }
+            if (notif_info->duplicate) {
+                expert_add_info(pinfo, tree, &ei_s7commp_notification_seqnum_duplicate);
+            }
+            if (notif_info->credit_limit_reached) {
+                expert_add_info_format(pinfo, tree, &ei_s7commp_notification_credit_limit,
+                    "Notification credit limit %d reached, no more notifications until the credit is incremented", notif_info->credit_limit);
+            }
+        }
+
         list_item = proto_tree_add_item(tree, hf_s7commp_valuelist, tvb, offset, -1, ENC_NA);
         list_item_tree = proto_item_add_subtree(list_item, ett_s7commp_valuelist);
         list_start_offset = offset;
-        offset = s7commp_decode_notification_value_list(tvb, pinfo, list_item_tree, offset, true);
+        offset = s7commp_decode_notification_value_list(tvb, pinfo, list_item_tree, offset, subscr_object_id, true);
         proto_item_set_len(list_item_tree, offset - list_start_offset);
         if (offset - list_start_offset > 1) {
             add_data_info_column = true;
@@ -10408,7 +12187,7 @@ s7commp_decode_notification(tvbuff_t *tvb,
                 list_item = proto_tree_add_item(tree, hf_s7commp_valuelist, tvb, offset, -1, ENC_NA);
                 list_item_tree = proto_item_add_subtree(list_item, ett_s7commp_valuelist);
                 list_start_offset = offset;
-                offset = s7commp_decode_notification_value_list(tvb, pinfo, list_item_tree, offset, true);
+                offset = s7commp_decode_notification_value_list(tvb, pinfo, list_item_tree, offset, subscr_object_id2, true);
                 proto_item_set_len(list_item_tree, offset - list_start_offset);
                 add_data_info_column = true;
             }
@@ -10419,6 +12198,19 @@ s7commp_decode_notification(tvbuff_t *tvb,
              */
             col_append_str(pinfo->cinfo, COL_INFO, " <Contains values>");
         }
+
+        if (notif_info != NULL) {
+            tap_info = wmem_new0(pinfo->pool, s7commp_tap_info_t);
+            tap_info->opcode = S7COMMP_OPCODE_NOTIFICATION;
+            tap_info->subscr_object_id = subscr_object_id;
+            tap_info->notif_has_values = add_data_info_column;
+            tap_info->notif_has_delta = (notif_info->prev_frame != 0);
+            tap_info->notif_delta_time = notif_info->delta_time;
+            tap_info->notif_missing = notif_info->missing;
+            tap_info->notif_duplicate = notif_info->duplicate;
+            tap_info->notif_credit_limit_reached = notif_info->credit_limit_reached;
+            tap_queue_packet(s7commp_tap, pinfo, tap_info);
+        }
     }
 
     return offset;
@@ -10454,7 +12246,7 @@ s7commp_decode_notification_v1(tvbuff_t *tvb,
         proto_tree_add_item(tree, hf_s7commp_notification_v1_unknown4, tvb, offset, 2, ENC_BIG_ENDIAN);
         offset += 2;
         list_start_offset = offset;
-        offset = s7commp_decode_notification_value_list(tvb, pinfo, tree, offset, true);
+        offset = s7commp_decode_notification_value_list(tvb, pinfo, tree, offset, subscr_object_id, true);
         if (offset - list_start_offset > 1) {
             col_append_str(pinfo->cinfo, COL_INFO, " <Contains values>");
         }
@@ -10462,6 +12254,47 @@ s7commp_decode_notification_v1(tvbuff_t *tvb,
 
     return offset;
 }
+/*******************************************************************************************************
+ *
+ * Extended decoding of attribute with id SubscriptionCreditLimit
+ *
+ * The credit limit is remembered in the subscription, to detect in the notifications when the
+ * PLC stops sending because the limit is reached. -1 means unlimited.
+ *
+ *******************************************************************************************************/
+static void
+s7commp_decode_attrib_subscriptioncreditlimit(tvbuff_t *tvb,
+                                              uint32_t offset,
+                                              s7commp_subscription_t *sub)
+{
+    uint8_t octet_count = 0;
+    int32_t credit_limit;
+
+    if (sub == NULL) {
+        return;
+    }
+    /* Datatype flags: should be 0x00 for a single value */
+    if (tvb_get_uint8(tvb, offset) != 0x00) {
+        return;
+    }
+    switch (tvb_get_uint8(tvb, offset + 1)) {
+        case S7COMMP_ITEM_DATATYPE_INT:
+            credit_limit = (int16_t)tvb_get_ntohs(tvb, offset + 2);
+            break;
+        case S7COMMP_ITEM_DATATYPE_DINT:
+            credit_limit = tvb_get_varint32(tvb, &octet_count, offset + 2);
+            break;
+        case S7COMMP_ITEM_DATATYPE_UINT:
+            credit_limit = tvb_get_ntohs(tvb, offset + 2);
+            break;
+        case S7COMMP_ITEM_DATATYPE_UDINT:
+            credit_limit = (int32_t)tvb_get_varuint32(tvb, &octet_count, offset + 2);
+            break;
+        default:
+            return;
+    }
+    sub->credit_limit = credit_limit;
+}
 /*******************************************************************************************************
  *
  * Extended decoding of attribute with id SubscriptionReferenceList
@@ -10474,12 +12307,8 @@ s7commp_decode_notification_v1(tvbuff_t *tvb,
 static uint32_t
 s7commp_decode_attrib_subscriptionreflist(tvbuff_t *tvb,
                                           proto_tree *tree,
-                                          uint32_t offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                          ,
-                                          packet_info *pinfo
-#endif
-    )
+                                          uint32_t offset,
+                                          packet_info *pinfo)
 {
     proto_item *list_item = NULL;
     proto_tree *list_item_tree = NULL;
@@ -10495,6 +12324,11 @@ s7commp_decode_attrib_subscriptionreflist(tvbuff_t *tvb,
     uint32_t list_start_offset;
     uint32_t sub_list_start_offset;
     uint32_t value = 0;
+    uint32_t refnumber = 0;
+    char addr_seq[S7COMMP_ITEMADDR_SEQ_LEN];
+    s7commp_subscription_t *sub;
+    s7commp_subscr_item_t *sub_item;
+    s7commp_subscr_item_t *prev_item;
 
     /* Datatype flags: should be 0x20 for Addressarray
      * Datatype      : should be 0x04 for UDInt
@@ -10504,6 +12338,9 @@ s7commp_decode_attrib_subscriptionreflist(tvbuff_t *tvb,
     }
     offset += 2;
 
+    /* Register the changes of the subscription in the first pass */
+    sub = s7commp_get_trans_subscription(pinfo);
+
     /* Array size: is only neccessary to recalculate the offset */
     tvb_get_varuint32(tvb, &octet_count, offset);
     offset += octet_count;
@@ -10543,8 +12380,14 @@ s7commp_decode_attrib_subscriptionreflist(tvbuff_t *tvb,
         sub_list_item = proto_tree_add_item(list_item_tree, hf_s7commp_subscrreflist_unsubscr_list, tvb, offset, -1, ENC_NA);
         sub_list_item_tree = proto_item_add_subtree(sub_list_item, ett_s7commp_subscrreflist);
         for (i = 1; i <= item_count_unsubscr; i++) {
-            proto_tree_add_varuint32(sub_list_item_tree, hf_s7commp_notification_vl_refnumber, tvb, offset, &octet_count);
+            proto_tree_add_ret_varuint32(sub_list_item_tree, hf_s7commp_notification_vl_refnumber, tvb, offset, &octet_count, &refnumber);
             offset += octet_count;
+            if (sub != NULL) {
+                sub_item = (s7commp_subscr_item_t *)wmem_tree_lookup32(sub->items, refnumber);
+                if (sub_item != NULL && sub_item->last_frame == 0) {
+                    sub_item->last_frame = pinfo->num;
+                }
+            }
         }
         proto_item_set_len(sub_list_item_tree, offset - sub_list_start_offset);
     }
@@ -10554,12 +12397,19 @@ s7commp_decode_attrib_subscriptionreflist(tvbuff_t *tvb,
         sub_list_item = proto_tree_add_item(list_item_tree, hf_s7commp_subscrreflist_subscr_list, tvb, offset, -1, ENC_NA);
         sub_list_item_tree = proto_item_add_subtree(sub_list_item, ett_s7commp_subscrreflist);
         for (i = 1; i <= item_count_subscr; i++) {
-            offset = s7commp_decode_item_address_sub(tvb, sub_list_item_tree, &array_index, i, offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                                     ,
-                                                     pinfo
-#endif
-                );
+            offset = s7commp_decode_item_address_sub(tvb, sub_list_item_tree, &array_index, i, &refnumber, addr_seq, offset, pinfo);
+            if (sub != NULL) {
+                prev_item = (s7commp_subscr_item_t *)wmem_tree_lookup32(sub->items, refnumber);
+                if (prev_item != NULL && prev_item->last_frame == 0) {
+                    prev_item->last_frame = pinfo->num;
+                }
+                sub_item = wmem_new(wmem_file_scope(), s7commp_subscr_item_t);
+                sub_item->first_frame = pinfo->num;
+                sub_item->last_frame = 0;
+                sub_item->address = wmem_strdup(wmem_file_scope(), addr_seq);
+                sub_item->prev = prev_item;
+                wmem_tree_insert32(sub->items, refnumber, (void *)sub_item);
+            }
         }
         proto_item_set_len(sub_list_item_tree, offset - sub_list_start_offset);
     }
@@ -10620,7 +12470,7 @@ s7commp_decode_request_setvariable(tvbuff_t *tvb,
     list_start_offset = offset;
     list_item = proto_tree_add_item(tree, hf_s7commp_valuelist, tvb, offset, -1, ENC_NA);
     list_item_tree = proto_item_add_subtree(list_item, ett_s7commp_valuelist);
-    offset = s7commp_decode_value(tvb, pinfo, list_item_tree, offset, &struct_level, 0, 0, false);
+    offset = s7commp_decode_value(tvb, pinfo, list_item_tree, offset, &struct_level, 0, 0, false, NULL);
     if (struct_level > 0) {
         offset = s7commp_decode_id_value_list(tvb, pinfo, list_item_tree, offset, 0, true, false);
     }
@@ -10707,7 +12557,7 @@ s7commp_decode_response_getvariable(tvbuff_t *tvb,
     data_item = proto_tree_add_item(tree, hf_s7commp_data_item_value, tvb, offset, -1, false);
     data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_data_item);
     start_offset = offset;
-    offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false);
+    offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false, NULL);
     proto_item_set_len(data_item_tree, offset - start_offset);
 
     return offset;
@@ -10745,7 +12595,7 @@ s7commp_decode_request_getvarsubstr(tvbuff_t *tvb,
             proto_tree_add_uint(data_item_tree, hf_s7commp_data_id_number, tvb, offset, 4, id_number);
             proto_item_append_text(data_item_tree, " [%u]:", id_number);
             offset += 4;
-            offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, id_number, 0, false);
+            offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, id_number, 0, false, NULL);
             proto_item_set_len(data_item_tree, offset - start_offset);
         }
     } while (struct_level > 0);
@@ -10778,7 +12628,7 @@ s7commp_decode_response_getvarsubstr(tvbuff_t *tvb,
     data_item_tree = proto_item_add_subtree(data_item, ett_s7commp_data_item);
     start_offset = offset;
     /* This function should be possible to handle a Null-Value */
-    offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false);
+    offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, false, NULL);
     /* when a struct was entered, then id, flag, type are following until terminating null */
     if (struct_level > 0) {
         offset = s7commp_decode_id_value_list(tvb, pinfo, data_item_tree, offset, 0, true, false);
@@ -10845,7 +12695,7 @@ s7commp_decode_request_setvarsubstr_stream(tvbuff_t *tvb,
     /* Request SetVarSubStreamed unknown 2 Bytes */
     proto_tree_add_item(streamdata_tree, hf_s7commp_setvarsubstr_req_unknown1, tvb, offset, 2, ENC_BIG_ENDIAN);
     offset += 2;
-    offset = s7commp_decode_value(tvb, pinfo, streamdata_tree, offset, &struct_level, 0, 0, false);
+    offset = s7commp_decode_value(tvb, pinfo, streamdata_tree, offset, &struct_level, 0, 0, false, NULL);
     *dlength -= (offset - offset_save);
     proto_item_set_len(streamdata_tree, offset - offset_save);
 
@@ -11312,6 +13162,9 @@ s7commp_decode_response_init_ssl(tvbuff_t *tvb,
             ssl_conversation_state = (ssl_conv_state_t *)conversation_get_proto_data(conversation, proto_s7commp);
             if (ssl_conversation_state == NULL) {
                 ssl_conversation_state = wmem_new(wmem_file_scope(), ssl_conv_state_t);
+                ssl_conversation_state->reasm_state = SSL_CONV_STATE_NOFRAG;
+                ssl_conversation_state->start_frame = 0;
+                ssl_conversation_state->remaining_len = 0;
                 conversation_add_proto_data(conversation, proto_s7commp, ssl_conversation_state);
             }
             ssl_conversation_state->ssl_state = SSL_CONV_STATE_SSL;
@@ -11327,6 +13180,9 @@ s7commp_decode_response_init_ssl(tvbuff_t *tvb,
             ssl_conversation_state = (ssl_conv_state_t *)conversation_get_proto_data(conversation, proto_s7commp);
             if (ssl_conversation_state == NULL) {
                 ssl_conversation_state = wmem_new(wmem_file_scope(), ssl_conv_state_t);
+                ssl_conversation_state->reasm_state = SSL_CONV_STATE_NOFRAG;
+                ssl_conversation_state->start_frame = 0;
+                ssl_conversation_state->remaining_len = 0;
                 conversation_add_proto_data(conversation, proto_s7commp, ssl_conversation_state);
             }
             ssl_conversation_state->ssl_state = SSL_CONV_STATE_SSL;
@@ -11409,27 +13265,85 @@ s7commp_decode_sys_event(tvbuff_t *tvb,
          * So a UDINT is always 4 bytes long.
          */
         struct_level = 0;
-        offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, true);
+        offset = s7commp_decode_value(tvb, pinfo, data_item_tree, offset, &struct_level, 0, 0, true, NULL);
         if (struct_level > 0) {
             offset = s7commp_decode_id_value_list(tvb, pinfo, data_item_tree, offset, 0, true, true);
         }
     } else if (str_len > 0) {
         /* maybe ASCII text */
         proto_tree_add_item_ret_string(data_item_tree, hf_s7commp_sysevent_message, tvb, offset, str_len, ENC_ASCII|ENC_NA,
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7) /* commit https://gitlab.com/wireshark/wireshark/-/commit/5ca5c9ca372e06881b23ba9f4fdcb6b479886444
-                                                  * removed wmem_packet_scope()
-                                                  */
-                                       WMEM_ALLOCATOR_SIMPLE
-#else
-                                       wmem_packet_scope()
-#endif
-                                       , &str_name);
+                                       pinfo->pool, &str_name);
         col_append_fstr(pinfo->cinfo, COL_INFO, " Message=%s", str_name);
         offset += str_len;
     }
 
     return offset;
 }
+/*******************************************************************************************************
+ *
+ * Match a request and its response by the sequence number, and show the links.
+ * Returns the transaction, or NULL if there is none.
+ *
+ *******************************************************************************************************/
+static s7commp_transaction_t *
+s7commp_match_transaction(tvbuff_t *tvb,
+                          packet_info *pinfo,
+                          proto_tree *tree,
+                          uint8_t opcode,
+                          uint16_t functioncode,
+                          uint16_t seqnum)
+{
+    s7commp_conv_info_t *conv_info;
+    s7commp_transaction_t *trans = NULL;
+    proto_item *item;
+    nstime_t ns;
+    bool is_request = (opcode == S7COMMP_OPCODE_REQ);
+
+    if (!pinfo->fd->visited) {
+        conv_info = s7commp_get_conv_info(pinfo);
+        if (is_request) {
+            trans = wmem_new(wmem_file_scope(), s7commp_transaction_t);
+            trans->req_frame = pinfo->num;
+            trans->rep_frame = 0;
+            trans->req_time = pinfo->abs_ts;
+            trans->functioncode = functioncode;
+            trans->subscription = NULL;
+            wmem_tree_insert32(conv_info->transactions, seqnum, (void *)trans);
+        } else {
+            trans = (s7commp_transaction_t *)wmem_tree_lookup32(conv_info->transactions, seqnum);
+            /* Only the first response to a request is linked, a repeated one is not */
+            if (trans != NULL && trans->rep_frame == 0) {
+                trans->rep_frame = pinfo->num;
+                /* The addresses are still needed for the values of this response */
+                s7commp_release_trans_item_addresses(pinfo, conv_info, trans);
+            } else {
+                trans = NULL;
+            }
+        }
+        if (trans != NULL) {
+            p_add_proto_data(wmem_file_scope(), pinfo, proto_s7commp, S7COMMP_PROTO_DATA_TRANS(pinfo->curr_layer_num), trans);
+        }
+    } else {
+        trans = (s7commp_transaction_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_s7commp, S7COMMP_PROTO_DATA_TRANS(pinfo->curr_layer_num));
+    }
+
+    if (trans == NULL) {
+        return NULL;
+    }
+    if (is_request) {
+        if (trans->rep_frame) {
+            item = proto_tree_add_uint(tree, hf_s7commp_data_response_in, tvb, 0, 0, trans->rep_frame);
+            PROTO_ITEM_SET_GENERATED(item);
+        }
+    } else {
+        item = proto_tree_add_uint(tree, hf_s7commp_data_response_to, tvb, 0, 0, trans->req_frame);
+        PROTO_ITEM_SET_GENERATED(item);
+        nstime_delta(&ns, &pinfo->abs_ts, &trans->req_time);
+        item = proto_tree_add_time(tree, hf_s7commp_data_response_time, tvb, 0, 0, &ns);
+        PROTO_ITEM_SET_GENERATED(item);
+    }
+    return trans;
+}
 /*******************************************************************************************************
  *
  * Decodes the data part
@@ -11446,13 +13360,15 @@ s7commp_decode_data(tvbuff_t *tvb,
     proto_item *item = NULL;
     proto_tree *item_tree = NULL;
 
-    uint16_t seqnum;
+    uint16_t seqnum = 0;
     uint16_t functioncode = 0;
     uint8_t opcode = 0;
     uint32_t offset_save;
     bool has_integrity_id = true;
     bool has_objectqualifier = false;
     const uint8_t *str_opcode;
+    s7commp_transaction_t *trans = NULL;
+    s7commp_tap_info_t *tap_info;
 
     opcode = tvb_get_uint8(tvb, offset);
     /* 1: Opcode */
@@ -11514,6 +13430,10 @@ s7commp_decode_data(tvbuff_t *tvb,
             offset += 2;
             dlength -= 2;
 
+            if (opcode == S7COMMP_OPCODE_REQ || opcode == S7COMMP_OPCODE_RES || opcode == S7COMMP_OPCODE_RES2) {
+                trans = s7commp_match_transaction(tvb, pinfo, tree, opcode, functioncode, seqnum);
+            }
+
             /* add some infos to info column */
             col_append_fstr(pinfo->cinfo, COL_INFO, " Seq=%u [%s %s]",
                 seqnum,
@@ -11555,12 +13475,7 @@ s7commp_decode_data(tvbuff_t *tvb,
 
                 switch (functioncode) {
                     case S7COMMP_FUNCTIONCODE_GETMULTIVAR:
-                        offset = s7commp_decode_request_getmultivar(tvb, item_tree, offset
-#if (VERSION_MAJOR >= 4) && (VERSION_MINOR >= 7)
-                                                                    ,
-                                                                    pinfo
-#endif
-                            );
+                        offset = s7commp_decode_request_getmultivar(tvb, item_tree, offset, pinfo);
                         has_objectqualifier = true;
                         break;
                     case S7COMMP_FUNCTIONCODE_SETMULTIVAR:
@@ -11697,6 +13612,23 @@ s7commp_decode_data(tvbuff_t *tvb,
             }
         }
         offset = s7commp_decode_integrity_wid(tvb, pinfo, tree, has_integrity_id, protocolversion, &dlength, offset);
+
+        /* Tap info, a response carries the function code of its request */
+        if (opcode != S7COMMP_OPCODE_NOTIFICATION) {
+            tap_info = wmem_new0(pinfo->pool, s7commp_tap_info_t);
+            tap_info->opcode = opcode;
+            tap_info->functioncode = functioncode;
+            tap_info->seqnum = seqnum;
+            if (trans != NULL) {
+                tap_info->functioncode = trans->functioncode;
+                tap_info->is_response = (trans->req_frame != pinfo->num);
+                if (tap_info->is_response) {
+                    tap_info->req_frame = trans->req_frame;
+                    nstime_delta(&tap_info->resp_time, &pinfo->abs_ts, &trans->req_time);
+                }
+            }
+            tap_queue_packet(s7commp_tap, pinfo, tap_info);
+        }
     } else {
         /* unknown opcode */
         expert_add_info_format(pinfo, tree, &ei_s7commp_data_opcode_unknown, "Unknown Opcode: 0x%02x", opcode);
@@ -11742,6 +13674,7 @@ dissect_s7commp(tvbuff_t *tvb,
     bool save_fragmented;
     uint32_t frag_id;
     frame_state_t *packet_state = NULL;
+    frame_state_t nofrag_state;
     conversation_t *conversation;
     conv_state_t *conversation_state = NULL;
     bool first_fragment = false;
@@ -11767,6 +13700,9 @@ dissect_s7commp(tvbuff_t *tvb,
     }
     /*----------------- Heuristic Checks - End */
 
+    /* The nesting depth is counted per PDU, the decoding of a previous PDU may have been aborted */
+    s7commp_get_decode_budget(pinfo)->depth = 0;
+
     col_set_str(pinfo->cinfo, COL_PROTOCOL, PROTO_TAG_S7COMM_PLUS);
     col_clear(pinfo->cinfo, COL_INFO);
     col_append_sep_str(pinfo->cinfo, COL_INFO, " | ", "");
@@ -11905,14 +13841,18 @@ dissect_s7commp(tvbuff_t *tvb,
                     conversation_state->start_opcode = 0;
                     conversation_state->start_function = 0;
                     conversation_add_proto_data(conversation, proto_s7commp, conversation_state);
+                    s7commp_reasm_memory.conv_states++;
                 }
+                s7commp_reasm_memory.pdus++;
 
                 if (has_trailer) {
                     if (conversation_state->state == CONV_STATE_NEW) {
                     } else {
                         last_fragment = true;
-                        conversation_state->state = CONV_STATE_NOFRAG;
-                        conversation_delete_proto_data(conversation, proto_s7commp);
+                        /* The state is reused for the next fragmented PDU of the connection. The values of
+                         * this series are still needed below for the frame state of the last fragment.
+                         */
+                        conversation_state->state = CONV_STATE_NEW;
                     }
                 } else {
                     if (conversation_state->state == CONV_STATE_NEW) {
@@ -11929,11 +13869,19 @@ dissect_s7commp(tvbuff_t *tvb,
             }
 
             save_fragmented = pinfo->fragmented;
+            /* The frame state is stored only for fragments. A frame without state on the
+             * following passes holds a PDU which is not fragmented.
+             */
             packet_state = (frame_state_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_s7commp, pinfo->curr_layer_num);
-            if (!packet_state) {
+            if (packet_state) {
+                first_fragment = packet_state->first_fragment;
+                inner_fragment = packet_state->inner_fragment;
+                last_fragment = packet_state->last_fragment;
+            } else if (!pinfo->fd->visited && (first_fragment || inner_fragment || last_fragment)) {
                 /* First S7COMMP in frame*/
                 packet_state = wmem_new(wmem_file_scope(), frame_state_t);
                 p_add_proto_data(wmem_file_scope(), pinfo, proto_s7commp, pinfo->curr_layer_num, packet_state);
+                s7commp_reasm_memory.frame_states++;
                 packet_state->first_fragment = first_fragment;
                 packet_state->inner_fragment = inner_fragment;
                 packet_state->last_fragment = last_fragment;
@@ -11941,9 +13889,8 @@ dissect_s7commp(tvbuff_t *tvb,
                 packet_state->start_opcode = conversation_state->start_opcode;
                 packet_state->start_function = conversation_state->start_function;
             } else {
-                first_fragment = packet_state->first_fragment;
-                inner_fragment = packet_state->inner_fragment;
-                last_fragment = packet_state->last_fragment;
+                memset(&nofrag_state, 0, sizeof(nofrag_state));
+                packet_state = &nofrag_state;
             }
 
             if (packet_state->start_opcode == S7COMMP_OPCODE_REQ &&
@@ -12077,26 +14024,19 @@ dissect_s7commp_ssl(tvbuff_t *tvb,
     ssl_conv_state_t *ssl_conversation_state = NULL;
     bool more_frags;
 
-    /* check of SSL protocol */
+    /* check of SSL protocol
+     * The SSL conversation is only created by the InitSsl response, so a lookup is
+     * sufficient here. This heuristic runs for every COTP payload (including all
+     * classic S7COMM traffic), which must not allocate a conversation and state per connection.
+     */
     if (!pinfo->fd->visited) {        /* first pass */
         conversation = find_conversation(pinfo->fd->num, &pinfo->dst, &pinfo->src,
                                         (const endpoint_type) pinfo->ptype, SSL_CONV_PORT(pinfo->srcport, pinfo->destport),
                                         0, NO_PORT_B);
-        if (conversation == NULL) {
-            conversation = conversation_new(pinfo->fd->num, &pinfo->dst, &pinfo->src,
-                                            (const endpoint_type) pinfo->ptype, SSL_CONV_PORT(pinfo->srcport, pinfo->destport),
-                                            0, NO_PORT2);
-        }
-        ssl_conversation_state = (ssl_conv_state_t *)conversation_get_proto_data(conversation, proto_s7commp);
-        if (ssl_conversation_state == NULL) {
-            ssl_conversation_state = wmem_new(wmem_file_scope(), ssl_conv_state_t);
-            ssl_conversation_state->ssl_state = SSL_CONV_STATE_NEW;
-            ssl_conversation_state->reasm_state = SSL_CONV_STATE_NOFRAG;
-            ssl_conversation_state->start_frame = 0;
-            ssl_conversation_state->remaining_len = 0;
-            conversation_add_proto_data(conversation, proto_s7commp, ssl_conversation_state);
+        if (conversation != NULL) {
+            ssl_conversation_state = (ssl_conv_state_t *)conversation_get_proto_data(conversation, proto_s7commp);
         }
-        if (ssl_conversation_state->ssl_state == SSL_CONV_STATE_SSL) {
+        if ((ssl_conversation_state != NULL) && (ssl_conversation_state->ssl_state == SSL_CONV_STATE_SSL)) {
             /* connection uses SSL */
             packet_state = (frame_state_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_s7commp, (uint32_t)tvb_raw_offset(tvb));
             if (!packet_state) {
@@ -24,5 +24,42 @@
 #ifndef __PACKET_S7COMM_PLUS_H__
 #define __PACKET_S7COMM_PLUS_H__
 
+/**************************************************************************
+ * Info passed to the "s7comm-plus" tap for every request, response and notification.
+ * For a matched response the function code is the one of the request.
+ */
+typedef struct {
+    uint8_t opcode;
+    uint16_t functioncode;
+    uint16_t seqnum;
+    bool is_response;           /* true if this is a response matched to a request */
+    uint32_t req_frame;         /* Frame number of the request, if is_response */
+    nstime_t resp_time;         /* Time between request and response, if is_response */
+    /* Notifications */
+    uint32_t subscr_object_id;
+    bool notif_has_values;      /* false if the notification is empty */
+    bool notif_has_delta;       /* true if there was a previous notification of the subscription */
+    nstime_t notif_delta_time;  /* Time since the previous notification, if notif_has_delta */
+    uint32_t notif_missing;     /* Number of notifications missing before this one */
+    bool notif_duplicate;
+    bool notif_credit_limit_reached;
+} s7commp_tap_info_t;
+
+/**************************************************************************
+ * Info passed to the "s7comm-plus.value" tap for every value of an item in
+ * GetMultiVariables, SetMultiVariables and notifications.
+ */
+typedef struct {
+    bool is_notification;
+    bool from_plc;              /* true if sent by the PLC (response or notification) */
+    uint32_t session;           /* Index of the conversation */
+    uint16_t functioncode;      /* Function code of the request, 0 for a notification */
+    uint32_t subscr_object_id;  /* Subscription of a notification */
+    uint32_t item_number;       /* Item number, or reference number in a notification */
+    const char *address;        /* Item address sequence, NULL if unknown */
+    uint8_t datatype;
+    uint8_t datatype_flags;
+    const char *value;          /* Value as displayed */
+} s7commp_value_tap_info_t;
 
 #endif